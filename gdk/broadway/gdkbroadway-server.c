@@ -43,7 +43,21 @@ struct _GdkBroadwayServer {
 
   guint process_input_idle;
   GList *incomming;
-  
+
+  /* In headless mode there is no connection, windows only exist
+   * as image surfaces in this process and input is injected with
+   * _gdk_broadway_server_inject_input().
+   */
+  guint headless : 1;
+  guint unthrottled : 1;
+  guint32 last_seen_time;
+  guint32 mouse_toplevel;
+  gint32 root_x;
+  gint32 root_y;
+  guint32 mouse_state;
+  gint32 pointer_grab_window_id; /* -1 => none */
+  guint32 pointer_grab_time;
+  guint32 next_window_id;
 };
 
 struct _GdkBroadwayServerClass
@@ -61,6 +75,8 @@ static void
 gdk_broadway_server_init (GdkBroadwayServer *server)
 {
   server->next_serial = 1;
+  server->pointer_grab_window_id = -1;
+  server->next_window_id = 1;
 }
 
 static void
@@ -105,6 +121,16 @@ _gdk_broadway_server_new (const char *display, GError **error)
   char *local_socket_type = NULL;
   int port;
 
+  if (g_strcmp0 (display, "headless") == 0 ||
+      g_strcmp0 (display, "headless-unthrottled") == 0)
+    {
+      server = g_object_new (GDK_TYPE_BROADWAY_SERVER, NULL);
+      server->headless = TRUE;
+      server->unthrottled = g_str_has_suffix (display, "-unthrottled");
+
+      return server;
+    }
+
   if (display == NULL)
     {
 #ifdef G_OS_UNIX
@@ -173,7 +199,91 @@ _gdk_broadway_server_new (const char *display, GError **error)
 guint32
 _gdk_broadway_server_get_last_seen_time (GdkBroadwayServer *server)
 {
-  return 0;
+  return server->last_seen_time;
+}
+
+gboolean
+_gdk_broadway_server_is_headless (GdkBroadwayServer *server)
+{
+  return server->headless;
+}
+
+gboolean
+_gdk_broadway_server_is_unthrottled (GdkBroadwayServer *server)
+{
+  return server->unthrottled;
+}
+
+static void
+headless_send_crossing (GdkBroadwayServer *server,
+                        guint32            type,
+                        guint32            id,
+                        guint64            time_)
+{
+  BroadwayInputMsg msg;
+
+  memset (&msg, 0, sizeof (msg));
+  msg.base.type = type;
+  msg.base.serial = server->next_serial++;
+  msg.base.time = time_;
+  msg.pointer.mouse_window_id = server->mouse_toplevel;
+  msg.pointer.event_window_id = id;
+  msg.pointer.root_x = server->root_x;
+  msg.pointer.root_y = server->root_y;
+  msg.pointer.state = server->mouse_state;
+  msg.crossing.mode = GDK_CROSSING_NORMAL;
+
+  _gdk_broadway_events_got_input (&msg);
+}
+
+/* Feeds an input message to the event source as if it came from
+ * broadwayd. Only used in headless mode; the serial and (if unset)
+ * the time are filled in here, and the pointer position and grabs
+ * are tracked the way broadwayd would.
+ */
+void
+_gdk_broadway_server_inject_input (GdkBroadwayServer *server,
+                                   BroadwayInputMsg  *msg)
+{
+  g_return_if_fail (server->headless);
+
+  if (msg->base.time == 0)
+    msg->base.time = g_get_monotonic_time () / 1000;
+  server->last_seen_time = msg->base.time;
+
+  switch (msg->base.type)
+    {
+    case BROADWAY_EVENT_POINTER_MOVE:
+    case BROADWAY_EVENT_BUTTON_PRESS:
+    case BROADWAY_EVENT_BUTTON_RELEASE:
+    case BROADWAY_EVENT_SCROLL:
+      if (msg->pointer.mouse_window_id != server->mouse_toplevel)
+        {
+          if (server->mouse_toplevel != 0)
+            headless_send_crossing (server, BROADWAY_EVENT_LEAVE,
+                                    server->mouse_toplevel, msg->base.time);
+          server->mouse_toplevel = msg->pointer.mouse_window_id;
+          server->root_x = msg->pointer.root_x;
+          server->root_y = msg->pointer.root_y;
+          if (server->mouse_toplevel != 0)
+            headless_send_crossing (server, BROADWAY_EVENT_ENTER,
+                                    server->mouse_toplevel, msg->base.time);
+        }
+
+      server->root_x = msg->pointer.root_x;
+      server->root_y = msg->pointer.root_y;
+      server->mouse_state = msg->pointer.state;
+
+      if (server->pointer_grab_window_id != -1)
+        msg->pointer.event_window_id = server->pointer_grab_window_id;
+      break;
+
+    default:
+      break;
+    }
+
+  msg->base.serial = server->next_serial++;
+  _gdk_broadway_events_got_input (msg);
 }
 
 static guint32
@@ -382,6 +492,9 @@ _gdk_broadway_server_flush (GdkBroadwayServer *server)
 {
   BroadwayRequestFlush msg;
 
+  if (server->headless)
+    return;
+
   gdk_broadway_server_send_message(server, msg, BROADWAY_REQUEST_FLUSH);
 }
 
@@ -392,6 +505,9 @@ _gdk_broadway_server_sync (GdkBroadwayServer *server)
   guint32 serial;
   BroadwayReply *reply;
 
+  if (server->headless)
+    return;
+
   serial = gdk_broadway_server_send_message (server, msg,
 					     BROADWAY_REQUEST_SYNC);
   reply = gdk_broadway_server_wait_for_reply (server, serial);
@@ -414,6 +530,19 @@ _gdk_broadway_server_query_mouse (GdkBroadwayServer *server,
   guint32 serial;
   BroadwayReply *reply;
 
+  if (server->headless)
+    {
+      if (toplevel)
+        *toplevel = server->mouse_toplevel;
+      if (root_x)
+        *root_x = server->root_x;
+      if (root_y)
+        *root_y = server->root_y;
+      if (mask)
+        *mask = server->mouse_state;
+      return;
+    }
+
   serial = gdk_broadway_server_send_message (server, msg,
 					     BROADWAY_REQUEST_QUERY_MOUSE);
   reply = gdk_broadway_server_wait_for_reply (server, serial);
@@ -444,6 +573,9 @@ _gdk_broadway_server_new_window (GdkBroadwayServer *server,
   guint32 serial, id;
   BroadwayReply *reply;
 
+  if (server->headless)
+    return server->next_window_id++;
+
   msg.x = x;
   msg.y = y;
   msg.width = width;
@@ -469,6 +601,15 @@ _gdk_broadway_server_destroy_window (GdkBroadwayServer *server,
 {
   BroadwayRequestDestroyWindow msg;
 
+  if (server->headless)
+    {
+      if (server->mouse_toplevel == id)
+        server->mouse_toplevel = 0;
+      if (server->pointer_grab_window_id == id)
+        server->pointer_grab_window_id = -1;
+      return;
+    }
+
   msg.id = id;
   gdk_broadway_server_send_message (server, msg,
 				    BROADWAY_REQUEST_DESTROY_WINDOW);
@@ -480,6 +621,9 @@ _gdk_broadway_server_window_show (GdkBroadwayServer *server,
 {
   BroadwayRequestShowWindow msg;
 
+  if (server->headless)
+    return TRUE;
+
   msg.id = id;
   gdk_broadway_server_send_message (server, msg,
 				    BROADWAY_REQUEST_SHOW_WINDOW);
@@ -493,6 +637,9 @@ _gdk_broadway_server_window_hide (GdkBroadwayServer *server,
 {
   BroadwayRequestHideWindow msg;
 
+  if (server->headless)
+    return TRUE;
+
   msg.id = id;
   gdk_broadway_server_send_message (server, msg,
 				    BROADWAY_REQUEST_HIDE_WINDOW);
@@ -506,6 +653,9 @@ _gdk_broadway_server_window_focus (GdkBroadwayServer *server,
 {
   BroadwayRequestFocusWindow msg;
 
+  if (server->headless)
+    return;
+
   msg.id = id;
   gdk_broadway_server_send_message (server, msg,
 				    BROADWAY_REQUEST_FOCUS_WINDOW);
@@ -517,6 +667,9 @@ _gdk_broadway_server_window_set_transient_for (GdkBroadwayServer *server,
 {
   BroadwayRequestSetTransientFor msg;
 
+  if (server->headless)
+    return;
+
   msg.id = id;
   msg.parent = parent;
   gdk_broadway_server_send_message (server, msg,
@@ -708,12 +861,17 @@ shm_data_destroy (void *_data)
 }
 
 cairo_surface_t *
-_gdk_broadway_server_create_surface (int                 width,
+_gdk_broadway_server_create_surface (GdkBroadwayServer  *server,
+				     int                 width,
 				     int                 height)
 {
   BroadwayShmSurfaceData *data;
   cairo_surface_t *surface;
 
+  /* Nobody else needs to see the pixels */
+  if (server->headless)
+    return cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+
   data = g_new (BroadwayShmSurfaceData, 1);
   data->data_size = width * height * sizeof (guint32);
   data->data = create_random_shm (data->name, data->data_size, &data->is_shm);
@@ -736,7 +894,7 @@ _gdk_broadway_server_window_update (GdkBroadwayServer *server,
   BroadwayRequestUpdate msg;
   BroadwayShmSurfaceData *data;
 
-  if (surface == NULL)
+  if (surface == NULL || server->headless)
     return;
 
   data = cairo_surface_get_user_data (surface, &gdk_broadway_shm_cairo_key);
@@ -762,6 +920,9 @@ _gdk_broadway_server_window_move_resize (GdkBroadwayServer *server,
 {
   BroadwayRequestMoveResize msg;
 
+  if (server->headless)
+    return TRUE;
+
   msg.id = id;
   msg.with_move = with_move;
   msg.x = x;
@@ -786,6 +947,17 @@ _gdk_broadway_server_grab_pointer (GdkBroadwayServer *server,
   guint32 serial, status;
   BroadwayReply *reply;
 
+  if (server->headless)
+    {
+      if (server->pointer_grab_window_id != -1 &&
+          time_ != 0 && server->pointer_grab_time > time_)
+        return GDK_GRAB_ALREADY_GRABBED;
+
+      server->pointer_grab_window_id = id;
+      server->pointer_grab_time = time_ != 0 ? time_ : server->last_seen_time;
+      return GDK_GRAB_SUCCESS;
+    }
+
   msg.id = id;
   msg.owner_events = owner_events;
   msg.event_mask = event_mask;
@@ -812,6 +984,16 @@ _gdk_broadway_server_ungrab_pointer (GdkBroadwayServer *server,
   guint32 serial, status;
   BroadwayReply *reply;
 
+  if (server->headless)
+    {
+      if (server->pointer_grab_window_id != -1 &&
+          time_ != 0 && server->pointer_grab_time > time_)
+        return 0;
+
+      server->pointer_grab_window_id = -1;
+      return server->next_serial++;
+    }
+
   msg.time_ = time_;
 
   serial = gdk_broadway_server_send_message (server, msg,
@@ -833,6 +1015,9 @@ _gdk_broadway_server_set_show_keyboard (GdkBroadwayServer *server,
 {
   BroadwayRequestSetShowKeyboard msg;
 
+  if (server->headless)
+    return;
+
   msg.show_keyboard = show;
   gdk_broadway_server_send_message (server, msg,
 				    BROADWAY_REQUEST_SET_SHOW_KEYBOARD);
@@ -20,6 +20,10 @@ void               _gdk_broadway_server_flush                    (GdkBroadwaySer
 void               _gdk_broadway_server_sync                     (GdkBroadwayServer  *server);
 gulong             _gdk_broadway_server_get_next_serial          (GdkBroadwayServer  *server);
 guint32            _gdk_broadway_server_get_last_seen_time       (GdkBroadwayServer  *server);
+gboolean           _gdk_broadway_server_is_headless              (GdkBroadwayServer  *server);
+gboolean           _gdk_broadway_server_is_unthrottled           (GdkBroadwayServer  *server);
+void               _gdk_broadway_server_inject_input             (GdkBroadwayServer  *server,
+								  BroadwayInputMsg   *msg);
 gboolean           _gdk_broadway_server_lookahead_event          (GdkBroadwayServer  *server,
 								  const char         *types);
 void               _gdk_broadway_server_query_mouse              (GdkBroadwayServer  *server,
@@ -59,7 +63,8 @@ gboolean           _gdk_broadway_server_window_translate         (GdkBroadwaySer
 								  cairo_region_t     *area,
 								  gint                dx,
 								  gint                dy);
-cairo_surface_t   *_gdk_broadway_server_create_surface           (int                 width,
+cairo_surface_t   *_gdk_broadway_server_create_surface           (GdkBroadwayServer  *server,
+								  int                 width,
 								  int                 height);
 void               _gdk_broadway_server_window_update            (GdkBroadwayServer  *server,
 								  gint                id,
@@ -17,6 +17,7 @@
 
 #include "config.h"
 #include <stdlib.h>
+#include <string.h>
 
 #include "gdkdevice-broadway.h"
 
@@ -132,12 +133,53 @@ gdk_broadway_device_set_window_cursor (GdkDevice *device,
 {
 }
 
+/* There is no way to move the pointer of a browser, but in headless
+ * mode the pointer is ours, so warping moves it and generates motion
+ * (and crossing) events, like a warp does on X.
+ */
 static void
 gdk_broadway_device_warp (GdkDevice *device,
 			  GdkScreen *screen,
 			  gdouble    x,
 			  gdouble    y)
 {
+  GdkBroadwayDisplay *broadway_display;
+  GdkWindowImplBroadway *impl;
+  GdkWindow *toplevel;
+  BroadwayInputMsg msg;
+  guint32 mask;
+  GList *l;
+
+  broadway_display = GDK_BROADWAY_DISPLAY (gdk_device_get_display (device));
+  if (!_gdk_broadway_server_is_headless (broadway_display->server))
+    return;
+
+  _gdk_broadway_server_query_mouse (broadway_display->server, NULL, NULL, NULL, &mask);
+
+  memset (&msg, 0, sizeof (msg));
+  msg.base.type = BROADWAY_EVENT_POINTER_MOVE;
+  msg.pointer.root_x = x;
+  msg.pointer.root_y = y;
+  msg.pointer.state = mask;
+
+  for (l = broadway_display->toplevels; l != NULL; l = l->next)
+    {
+      impl = l->data;
+      toplevel = impl->wrapper;
+
+      if (GDK_WINDOW_IS_MAPPED (toplevel) &&
+          x >= toplevel->x && x < toplevel->x + toplevel->width &&
+          y >= toplevel->y && y < toplevel->y + toplevel->height)
+        {
+          msg.pointer.mouse_window_id = impl->id;
+          msg.pointer.event_window_id = impl->id;
+          msg.pointer.win_x = x - toplevel->x;
+          msg.pointer.win_y = y - toplevel->y;
+          break;
+        }
+    }
+
+  _gdk_broadway_server_inject_input (broadway_display->server, &msg);
 }
 
 static void
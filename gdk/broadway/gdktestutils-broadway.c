@@ -21,6 +21,47 @@
 #include <gdk/gdkinternals.h>
 #include "gdkprivate-broadway.h"
 
+#include <string.h>
+
+/* Input can only be simulated when there is no broadwayd to send
+ * it to, i.e. in headless mode. The messages are built the way
+ * broadwayd would build them, relative to the toplevel.
+ */
+static GdkBroadwayServer *
+get_headless_server (GdkWindow *window)
+{
+  GdkBroadwayDisplay *display;
+
+  display = GDK_BROADWAY_DISPLAY (gdk_window_get_display (window));
+  if (!_gdk_broadway_server_is_headless (display->server))
+    return NULL;
+
+  return display->server;
+}
+
+static void
+fill_pointer_message (BroadwayInputMsg *msg,
+                      GdkWindow        *window,
+                      gint              x,
+                      gint              y,
+                      GdkModifierType   modifiers)
+{
+  GdkWindow *toplevel;
+  gint root_x, root_y, toplevel_x, toplevel_y;
+
+  toplevel = gdk_window_get_toplevel (window);
+  gdk_window_get_root_coords (window, x, y, &root_x, &root_y);
+  gdk_window_get_origin (toplevel, &toplevel_x, &toplevel_y);
+
+  msg->pointer.mouse_window_id = GDK_WINDOW_IMPL_BROADWAY (toplevel->impl)->id;
+  msg->pointer.event_window_id = msg->pointer.mouse_window_id;
+  msg->pointer.root_x = root_x;
+  msg->pointer.root_y = root_y;
+  msg->pointer.win_x = root_x - toplevel_x;
+  msg->pointer.win_y = root_y - toplevel_y;
+  msg->pointer.state = modifiers;
+}
+
 void
 _gdk_broadway_window_sync_rendering (GdkWindow *window)
 {
@@ -35,15 +76,27 @@ _gdk_broadway_window_simulate_key (GdkWindow      *window,
 				   GdkModifierType modifiers,
 				   GdkEventType    key_pressrelease)
 {
+  GdkBroadwayServer *server;
+  BroadwayInputMsg msg;
+
   g_return_val_if_fail (key_pressrelease == GDK_KEY_PRESS || key_pressrelease == GDK_KEY_RELEASE, FALSE);
   g_return_val_if_fail (window != NULL, FALSE);
 
   if (!GDK_WINDOW_IS_MAPPED (window))
     return FALSE;
 
-  /* FIXME: Implement. */
+  server = get_headless_server (window);
+  if (server == NULL)
+    return FALSE;
+
+  memset (&msg, 0, sizeof (msg));
+  msg.base.type = key_pressrelease == GDK_KEY_PRESS ? BROADWAY_EVENT_KEY_PRESS : BROADWAY_EVENT_KEY_RELEASE;
+  msg.key.window_id = GDK_WINDOW_IMPL_BROADWAY (gdk_window_get_toplevel (window)->impl)->id;
+  msg.key.state = modifiers;
+  msg.key.key = keyval;
+  _gdk_broadway_server_inject_input (server, &msg);
 
-  return FALSE;
+  return TRUE;
 }
 
 gboolean
@@ -54,13 +107,30 @@ _gdk_broadway_window_simulate_button (GdkWindow      *window,
 				      GdkModifierType modifiers,
 				      GdkEventType    button_pressrelease)
 {
+  GdkBroadwayServer *server;
+  BroadwayInputMsg msg;
+
   g_return_val_if_fail (button_pressrelease == GDK_BUTTON_PRESS || button_pressrelease == GDK_BUTTON_RELEASE, FALSE);
   g_return_val_if_fail (window != NULL, FALSE);
 
   if (!GDK_WINDOW_IS_MAPPED (window))
     return FALSE;
 
-  /* FIXME: Implement. */
+  server = get_headless_server (window);
+  if (server == NULL)
+    return FALSE;
+
+  /* Move the pointer there first, so enter events are generated */
+  memset (&msg, 0, sizeof (msg));
+  msg.base.type = BROADWAY_EVENT_POINTER_MOVE;
+  fill_pointer_message (&msg, window, x, y, modifiers);
+  _gdk_broadway_server_inject_input (server, &msg);
+
+  memset (&msg, 0, sizeof (msg));
+  msg.base.type = button_pressrelease == GDK_BUTTON_PRESS ? BROADWAY_EVENT_BUTTON_PRESS : BROADWAY_EVENT_BUTTON_RELEASE;
+  fill_pointer_message (&msg, window, x, y, modifiers);
+  msg.button.button = button;
+  _gdk_broadway_server_inject_input (server, &msg);
 
-  return FALSE;
+  return TRUE;
 }
@@ -37,6 +37,7 @@
 #include "gdkinternals.h"
 #include "gdkdeviceprivate.h"
 #include "gdkeventsource.h"
+#include "gdkframeclockidle.h"
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -251,6 +252,12 @@ connect_frame_clock (GdkWindow *window)
   if (WINDOW_IS_TOPLEVEL (window))
     {
       GdkFrameClock *frame_clock = gdk_window_get_frame_clock (window);
+      GdkBroadwayDisplay *broadway_display;
+
+      broadway_display = GDK_BROADWAY_DISPLAY (gdk_window_get_display (window));
+      if (_gdk_broadway_server_is_unthrottled (broadway_display->server) &&
+          GDK_IS_FRAME_CLOCK_IDLE (frame_clock))
+        _gdk_frame_clock_idle_set_unthrottled (GDK_FRAME_CLOCK_IDLE (frame_clock), TRUE);
 
       g_signal_connect (frame_clock, "after-paint",
                         G_CALLBACK (on_frame_clock_after_paint), window);
@@ -302,7 +309,11 @@ _gdk_broadway_window_resize_surface (GdkWindow *window)
     {
       cairo_surface_destroy (impl->surface);
 
-      impl->surface = _gdk_broadway_server_create_surface (gdk_window_get_width (impl->wrapper),
+      GdkBroadwayDisplay *broadway_display;
+
+      broadway_display = GDK_BROADWAY_DISPLAY (gdk_window_get_display (window));
+      impl->surface = _gdk_broadway_server_create_surface (broadway_display->server,
+							   gdk_window_get_width (impl->wrapper),
 							   gdk_window_get_height (impl->wrapper));
     }
 
@@ -339,7 +350,12 @@ gdk_window_broadway_ref_cairo_surface (GdkWindow *window)
 
   /* Create actual backing store if missing */
   if (!impl->surface)
-    impl->surface = _gdk_broadway_server_create_surface (w, h);
+    {
+      GdkBroadwayDisplay *broadway_display;
+
+      broadway_display = GDK_BROADWAY_DISPLAY (gdk_window_get_display (window));
+      impl->surface = _gdk_broadway_server_create_surface (broadway_display->server, w, h);
+    }
 
   /* Create a destroyable surface referencing the real one */
   if (!impl->ref_surface)
@@ -16,7 +16,11 @@ gdk__private__ (void)
     gdk_display_get_rendering_mode,
     gdk_display_set_rendering_mode,
     gdk_display_get_debug_updates,
-    gdk_display_set_debug_updates
+    gdk_display_set_debug_updates,
+    gdk_profiler_start,
+    gdk_profiler_stop,
+    gdk_profiler_is_running,
+    gdk_profiler_end_mark
   };
 
   return &table;
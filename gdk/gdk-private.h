@@ -3,6 +3,7 @@
 
 #include <gdk/gdk.h>
 #include "gdk/gdkinternals.h"
+#include "gdk/gdkprofilerprivate.h"
 
 #define GDK_PRIVATE_CALL(symbol)        (gdk__private__ ()->symbol)
 
@@ -56,6 +57,13 @@ typedef struct {
   gboolean         (* gdk_display_get_debug_updates) (GdkDisplay *display);
   void             (* gdk_display_set_debug_updates) (GdkDisplay *display,
                                                       gboolean    debug_updates);
+
+  void     (* gdk_profiler_start)      (const char *filename);
+  void     (* gdk_profiler_stop)       (void);
+  gboolean (* gdk_profiler_is_running) (void);
+  void     (* gdk_profiler_end_mark)   (gint64      start,
+                                        const char *name,
+                                        const char *detail);
 } GdkPrivateVTable;
 
 GDK_AVAILABLE_IN_ALL
@@ -292,6 +292,7 @@ gdk_pre_parse (void)
 {
   const char *rendering_mode;
   const gchar *gl_string;
+  const gchar *trace_file;
 
   gdk_initialized = TRUE;
 
@@ -337,6 +338,10 @@ gdk_pre_parse (void)
       else if (g_str_equal (rendering_mode, "recording"))
         _gdk_rendering_mode = GDK_RENDERING_MODE_RECORDING;
     }
+
+  trace_file = g_getenv ("GDK_TRACE");
+  if (trace_file && trace_file[0])
+    gdk_profiler_start (trace_file);
 }
 
 /**
@@ -251,6 +251,73 @@ _gdk_event_unqueue (GdkDisplay *display)
   return event;
 }
 
+static GdkTimeCoord *
+time_coord_new (guint n_axes)
+{
+  return g_malloc0 (sizeof (GdkTimeCoord) -
+                    sizeof (gdouble) * (GDK_MAX_TIMECOORD_AXES - n_axes));
+}
+
+static GdkTimeCoord *
+time_coord_copy (const GdkTimeCoord *coord,
+                 guint               n_axes)
+{
+  return g_memdup (coord, sizeof (GdkTimeCoord) -
+                   sizeof (gdouble) * (GDK_MAX_TIMECOORD_AXES - n_axes));
+}
+
+/* Appends the history of @history_event, followed by @history_event
+ * itself, to the motion history of @event. Both are motion events
+ * from the same device.
+ */
+static void
+gdk_event_push_history (GdkEvent *event,
+                        GdkEvent *history_event)
+{
+  GdkEventPrivate *private = (GdkEventPrivate *) event;
+  GdkEventPrivate *history_private = (GdkEventPrivate *) history_event;
+  GdkDevice *device;
+  GdkTimeCoord *coord;
+  guint n_axes, i;
+
+  device = history_event->motion.device;
+  if (device == NULL)
+    return;
+
+  n_axes = MIN (gdk_device_get_n_axes (device), GDK_MAX_TIMECOORD_AXES);
+
+  if (private->history == NULL)
+    private->history = g_ptr_array_new_with_free_func (g_free);
+
+  if (history_private->history)
+    {
+      for (i = 0; i < history_private->history->len; i++)
+        g_ptr_array_add (private->history,
+                         g_ptr_array_index (history_private->history, i));
+
+      g_ptr_array_set_free_func (history_private->history, NULL);
+      g_clear_pointer (&history_private->history, g_ptr_array_unref);
+    }
+
+  coord = time_coord_new (n_axes);
+  coord->time = history_event->motion.time;
+
+  if (history_event->motion.axes)
+    memcpy (coord->axes, history_event->motion.axes, sizeof (gdouble) * n_axes);
+
+  for (i = 0; i < n_axes; i++)
+    {
+      GdkAxisUse use = gdk_device_get_axis_use (device, i);
+
+      if (use == GDK_AXIS_X)
+        coord->axes[i] = history_event->motion.x;
+      else if (use == GDK_AXIS_Y)
+        coord->axes[i] = history_event->motion.y;
+    }
+
+  g_ptr_array_add (private->history, coord);
+}
+
 void
 _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
 {
@@ -260,7 +327,8 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
   GdkDevice *pending_motion_device = NULL;
 
   /* If the last N events in the event queue are motion notify
-   * events for the same window, drop all but the last */
+   * events for the same window, drop all but the last, and keep
+   * the dropped ones in its history */
 
   tmp_list = display->queued_tail;
 
@@ -295,6 +363,7 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
   while (pending_motions && pending_motions->next != NULL)
     {
       GList *next = pending_motions->next;
+      gdk_event_push_history (display->queued_tail->data, pending_motions->data);
       gdk_event_free (pending_motions->data);
       display->queued_events = g_list_delete_link (display->queued_events,
                                                    pending_motions);
@@ -663,6 +732,17 @@ gdk_event_copy (const GdkEvent *event)
       new_private->source_device = private->source_device ? g_object_ref (private->source_device) : NULL;
       new_private->seat = private->seat;
       new_private->tool = private->tool;
+
+      if (private->history && event->motion.device)
+        {
+          guint n_axes, i;
+
+          n_axes = MIN (gdk_device_get_n_axes (event->motion.device), GDK_MAX_TIMECOORD_AXES);
+          new_private->history = g_ptr_array_new_with_free_func (g_free);
+          for (i = 0; i < private->history->len; i++)
+            g_ptr_array_add (new_private->history,
+                             time_coord_copy (g_ptr_array_index (private->history, i), n_axes));
+        }
     }
 
   switch (event->any.type)
@@ -767,6 +847,7 @@ gdk_event_free (GdkEvent *event)
       private = (GdkEventPrivate *) event;
       g_clear_object (&private->device);
       g_clear_object (&private->source_device);
+      g_clear_pointer (&private->history, g_ptr_array_unref);
     }
 
   switch (event->any.type)
@@ -2482,6 +2563,59 @@ gdk_event_set_scancode (GdkEvent *event,
   private->key_scancode = scancode;
 }
 
+/**
+ * gdk_event_get_motion_history:
+ * @event: a #GdkEvent
+ * @events: (out) (array length=n_events) (transfer full) (optional): return
+ *   location for an array of #GdkTimeCoord, or %NULL
+ * @n_events: (out) (optional): return location for the length of @events, or %NULL
+ *
+ * Retrieves the motion events that were merged into @event by motion
+ * compression, oldest first. @event itself is not part of the history.
+ *
+ * The axes of each #GdkTimeCoord are laid out like the axes of the device
+ * of @event, so they can be read with gdk_device_get_axis(). The X and Y
+ * axes are always filled in, relative to the window of @event.
+ *
+ * The array must be freed with gdk_device_free_history().
+ *
+ * Returns: %TRUE if @event is a motion event with a history
+ *
+ * Since: 3.22
+ **/
+gboolean
+gdk_event_get_motion_history (const GdkEvent   *event,
+                              GdkTimeCoord   ***events,
+                              gint             *n_events)
+{
+  GdkEventPrivate *private;
+  guint n_axes, i;
+
+  g_return_val_if_fail (event != NULL, FALSE);
+
+  if (!gdk_event_is_allocated (event) ||
+      event->type != GDK_MOTION_NOTIFY ||
+      event->motion.device == NULL)
+    return FALSE;
+
+  private = (GdkEventPrivate *) event;
+  if (private->history == NULL || private->history->len == 0)
+    return FALSE;
+
+  if (events)
+    {
+      n_axes = MIN (gdk_device_get_n_axes (event->motion.device), GDK_MAX_TIMECOORD_AXES);
+      *events = g_new (GdkTimeCoord *, private->history->len);
+      for (i = 0; i < private->history->len; i++)
+        (*events)[i] = time_coord_copy (g_ptr_array_index (private->history, i), n_axes);
+    }
+
+  if (n_events)
+    *n_events = private->history->len;
+
+  return TRUE;
+}
+
 /**
  * gdk_event_get_scancode:
  * @event: a #GdkEvent
@@ -1457,6 +1457,11 @@ int            gdk_event_get_scancode    (GdkEvent *event);
 GDK_AVAILABLE_IN_3_22
 gboolean       gdk_event_get_pointer_emulated (GdkEvent *event);
 
+GDK_AVAILABLE_IN_3_22
+gboolean       gdk_event_get_motion_history (const GdkEvent   *event,
+                                             GdkTimeCoord   ***events,
+                                             gint             *n_events);
+
 G_END_DECLS
 
 #endif /* __GDK_EVENTS_H__ */
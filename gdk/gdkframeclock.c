@@ -26,6 +26,7 @@
 
 #include "gdkframeclockprivate.h"
 #include "gdkinternals.h"
+#include "gdkprofilerprivate.h"
 
 /**
  * SECTION:gdkframeclock
@@ -270,6 +271,36 @@ gdk_frame_clock_get_frame_time (GdkFrameClock *frame_clock)
   return GDK_FRAME_CLOCK_GET_CLASS (frame_clock)->get_frame_time (frame_clock);
 }
 
+/**
+ * gdk_frame_clock_get_frame_deadline:
+ * @frame_clock: a #GdkFrameClock
+ *
+ * Gets the time by which work that is done between frames, such as
+ * incremental validation in idle handlers, should yield so that the
+ * next frame can start on time. If the time has already passed, such
+ * work should only do a small step.
+ *
+ * When no frame is scheduled, or while a frame is being processed,
+ * there is no deadline and 0 is returned.
+ *
+ * Since: 3.22
+ * Returns: a timestamp in microseconds, in the timescale of
+ *  g_get_monotonic_time(), or 0
+ */
+gint64
+gdk_frame_clock_get_frame_deadline (GdkFrameClock *frame_clock)
+{
+  GdkFrameClockClass *klass;
+
+  g_return_val_if_fail (GDK_IS_FRAME_CLOCK (frame_clock), 0);
+
+  klass = GDK_FRAME_CLOCK_GET_CLASS (frame_clock);
+  if (klass->get_frame_deadline == NULL)
+    return 0;
+
+  return klass->get_frame_deadline (frame_clock);
+}
+
 /**
  * gdk_frame_clock_request_phase:
  * @frame_clock: a #GdkFrameClock
@@ -613,41 +644,69 @@ gdk_frame_clock_get_refresh_info (GdkFrameClock *frame_clock,
 void
 _gdk_frame_clock_emit_flush_events (GdkFrameClock *frame_clock)
 {
+  gint64 before = GDK_PROFILER_CURRENT_TIME;
+
   g_signal_emit (frame_clock, signals[FLUSH_EVENTS], 0);
+
+  gdk_profiler_end_mark (before, "flush events", NULL);
 }
 
 void
 _gdk_frame_clock_emit_before_paint (GdkFrameClock *frame_clock)
 {
+  gint64 before = GDK_PROFILER_CURRENT_TIME;
+
   g_signal_emit (frame_clock, signals[BEFORE_PAINT], 0);
+
+  gdk_profiler_end_mark (before, "before paint", NULL);
 }
 
 void
 _gdk_frame_clock_emit_update (GdkFrameClock *frame_clock)
 {
+  gint64 before = GDK_PROFILER_CURRENT_TIME;
+
   g_signal_emit (frame_clock, signals[UPDATE], 0);
+
+  gdk_profiler_end_mark (before, "update", NULL);
 }
 
 void
 _gdk_frame_clock_emit_layout (GdkFrameClock *frame_clock)
 {
+  gint64 before = GDK_PROFILER_CURRENT_TIME;
+
   g_signal_emit (frame_clock, signals[LAYOUT], 0);
+
+  gdk_profiler_end_mark (before, "layout", NULL);
 }
 
 void
 _gdk_frame_clock_emit_paint (GdkFrameClock *frame_clock)
 {
+  gint64 before = GDK_PROFILER_CURRENT_TIME;
+
   g_signal_emit (frame_clock, signals[PAINT], 0);
+
+  gdk_profiler_end_mark (before, "paint", NULL);
 }
 
 void
 _gdk_frame_clock_emit_after_paint (GdkFrameClock *frame_clock)
 {
+  gint64 before = GDK_PROFILER_CURRENT_TIME;
+
   g_signal_emit (frame_clock, signals[AFTER_PAINT], 0);
+
+  gdk_profiler_end_mark (before, "after paint", NULL);
 }
 
 void
 _gdk_frame_clock_emit_resume_events (GdkFrameClock *frame_clock)
 {
+  gint64 before = GDK_PROFILER_CURRENT_TIME;
+
   g_signal_emit (frame_clock, signals[RESUME_EVENTS], 0);
+
+  gdk_profiler_end_mark (before, "resume events", NULL);
 }
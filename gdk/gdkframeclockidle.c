@@ -53,6 +53,7 @@ struct _GdkFrameClockIdlePrivate
   GdkFrameClockPhase phase;
 
   guint in_paint_idle : 1;
+  guint unthrottled : 1;
 #ifdef G_OS_WIN32
   guint begin_period : 1;
 #endif
@@ -190,6 +191,10 @@ gdk_frame_clock_idle_get_frame_time (GdkFrameClock *clock)
       priv->phase != GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS)
     return priv->frame_time;
 
+  /* Unthrottled clocks only move forward when a frame is painted */
+  if (priv->unthrottled)
+    return priv->frame_time;
+
   /* Outside a paint, pick something close to "now" */
   computed_frame_time = compute_frame_time (GDK_FRAME_CLOCK_IDLE (clock));
 
@@ -282,6 +287,9 @@ compute_min_next_frame_time (GdkFrameClockIdle *clock_idle,
   gint64 presentation_time;
   gint64 refresh_interval;
 
+  if (clock_idle->priv->unthrottled)
+    return 0;
+
   gdk_frame_clock_get_refresh_info (GDK_FRAME_CLOCK (clock_idle),
                                     last_frame_time,
                                     &refresh_interval, &presentation_time);
@@ -350,7 +358,10 @@ gdk_frame_clock_paint_idle (void *data)
         case GDK_FRAME_CLOCK_PHASE_BEFORE_PAINT:
           if (priv->freeze_count == 0)
             {
-              priv->frame_time = compute_frame_time (clock_idle);
+              if (priv->unthrottled)
+                priv->frame_time += FRAME_INTERVAL;
+              else
+                priv->frame_time = compute_frame_time (clock_idle);
 
               _gdk_frame_clock_begin_frame (clock);
               timings = gdk_frame_clock_get_current_timings (clock);
@@ -570,6 +581,35 @@ gdk_frame_clock_idle_thaw (GdkFrameClock *clock)
     }
 }
 
+static gint64
+gdk_frame_clock_idle_get_frame_deadline (GdkFrameClock *clock)
+{
+  GdkFrameClockIdle *clock_idle = GDK_FRAME_CLOCK_IDLE (clock);
+  GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+  gint64 next_frame_time;
+
+  if (priv->in_paint_idle)
+    return 0;
+
+  if ((priv->requested & ~GDK_FRAME_CLOCK_PHASE_FLUSH_EVENTS) == 0 &&
+      priv->updating_count == 0)
+    return 0;
+
+  /* While frozen (e.g. waiting for the compositor to present the last
+   * frame) the next frame is not scheduled yet, so we predict it from
+   * the refresh rate.
+   */
+  next_frame_time = priv->min_next_frame_time;
+  if (next_frame_time == 0)
+    next_frame_time = compute_min_next_frame_time (clock_idle, priv->frame_time);
+
+  /* Unthrottled, the next frame is due right away */
+  if (next_frame_time == 0)
+    return g_get_monotonic_time ();
+
+  return next_frame_time - priv->timer_base;
+}
+
 static void
 gdk_frame_clock_idle_class_init (GdkFrameClockIdleClass *klass)
 {
@@ -584,6 +624,7 @@ gdk_frame_clock_idle_class_init (GdkFrameClockIdleClass *klass)
   frame_clock_class->end_updating = gdk_frame_clock_idle_end_updating;
   frame_clock_class->freeze = gdk_frame_clock_idle_freeze;
   frame_clock_class->thaw = gdk_frame_clock_idle_thaw;
+  frame_clock_class->get_frame_deadline = gdk_frame_clock_idle_get_frame_deadline;
 }
 
 GdkFrameClock *
@@ -595,3 +636,25 @@ _gdk_frame_clock_idle_new (void)
 
   return GDK_FRAME_CLOCK (clock);
 }
+
+/* An unthrottled clock paints the next frame as soon as the main loop
+ * gets to it, and its frame time advances by exactly one frame interval
+ * per frame instead of following the wall clock. This is meant for
+ * backends that don't present anything to a user, where animations
+ * should run as fast as possible but still produce the same frames.
+ */
+void
+_gdk_frame_clock_idle_set_unthrottled (GdkFrameClockIdle *clock_idle,
+                                       gboolean           unthrottled)
+{
+  GdkFrameClockIdlePrivate *priv = clock_idle->priv;
+
+  unthrottled = !!unthrottled;
+  if (priv->unthrottled == unthrottled)
+    return;
+
+  priv->unthrottled = unthrottled;
+  if (priv->frame_time == 0)
+    priv->frame_time = compute_frame_time (clock_idle);
+  priv->min_next_frame_time = 0;
+}
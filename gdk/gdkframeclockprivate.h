@@ -54,6 +54,8 @@ struct _GdkFrameClock
  * @end_updating: Stops updates for an animation.
  * @freeze: 
  * @thaw: 
+ * @get_frame_deadline: Gets the time by which work between frames
+ *    should yield.
  */
 struct _GdkFrameClockClass
 {
@@ -71,6 +73,8 @@ struct _GdkFrameClockClass
   void     (* freeze)         (GdkFrameClock *clock);
   void     (* thaw)           (GdkFrameClock *clock);
 
+  gint64   (* get_frame_deadline) (GdkFrameClock *clock);
+
   /* signals */
   /* void (* flush_events)       (GdkFrameClock *clock); */
   /* void (* before_paint)       (GdkFrameClock *clock); */
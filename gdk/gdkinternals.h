@@ -192,6 +192,7 @@ struct _GdkEventPrivate
   GdkSeat   *seat;
   GdkDeviceTool *tool;
   guint16    key_scancode;
+  GPtrArray *history; /* GdkTimeCoord, for compressed motion events */
 };
 
 typedef struct _GdkWindowPaint GdkWindowPaint;
@@ -0,0 +1,193 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright (C) 2016 the GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#include "gdkprofilerprivate.h"
+
+/* The profiler keeps the last GDK_PROFILER_N_MARKS spans in a ring
+ * buffer, so that it can be left running for a long time at a fixed
+ * cost. When it is stopped (or the process exits), the spans are
+ * written to a file in the Trace Event format, which can be loaded
+ * into chrome://tracing and similar viewers.
+ *
+ * Marks are only recorded from the main thread, and names and
+ * details must be static or interned strings.
+ */
+
+#define GDK_PROFILER_N_MARKS 32768
+
+typedef struct _GdkProfilerMark GdkProfilerMark;
+
+struct _GdkProfilerMark
+{
+  gint64 start;
+  gint64 duration;
+  const char *name;
+  const char *detail;
+};
+
+static GdkProfilerMark *marks;
+static guint n_marks;
+static guint next_mark;
+static char *trace_filename;
+static gboolean running;
+static gboolean atexit_registered;
+
+static void
+profiler_atexit (void)
+{
+  gdk_profiler_stop ();
+}
+
+void
+gdk_profiler_start (const char *filename)
+{
+  g_return_if_fail (filename != NULL);
+
+  if (running)
+    return;
+
+  marks = g_new (GdkProfilerMark, GDK_PROFILER_N_MARKS);
+  n_marks = 0;
+  next_mark = 0;
+  trace_filename = g_strdup (filename);
+  running = TRUE;
+
+  if (!atexit_registered)
+    {
+      atexit (profiler_atexit);
+      atexit_registered = TRUE;
+    }
+}
+
+gboolean
+gdk_profiler_is_running (void)
+{
+  return running;
+}
+
+void
+gdk_profiler_add_mark (gint64      start,
+                       gint64      duration,
+                       const char *name,
+                       const char *detail)
+{
+  GdkProfilerMark *mark;
+
+  if (!running)
+    return;
+
+  mark = &marks[next_mark];
+  mark->start = start;
+  mark->duration = duration;
+  mark->name = name;
+  mark->detail = detail;
+
+  next_mark = (next_mark + 1) % GDK_PROFILER_N_MARKS;
+  n_marks = MIN (n_marks + 1, GDK_PROFILER_N_MARKS);
+}
+
+/* Records a span from @start, as returned by GDK_PROFILER_CURRENT_TIME,
+ * until now. Spans that started before the profiler was running are
+ * dropped.
+ */
+void
+gdk_profiler_end_mark (gint64      start,
+                       const char *name,
+                       const char *detail)
+{
+  if (!running || start == 0)
+    return;
+
+  gdk_profiler_add_mark (start, g_get_monotonic_time () - start, name, detail);
+}
+
+static void
+append_escaped (GString    *str,
+                const char *text)
+{
+  const char *p;
+
+  g_string_append_c (str, '"');
+  for (p = text; *p; p++)
+    {
+      if (*p == '"' || *p == '\\')
+        g_string_append_c (str, '\\');
+
+      if ((guchar) *p < 0x20)
+        g_string_append_printf (str, "\\u%04x", (guchar) *p);
+      else
+        g_string_append_c (str, *p);
+    }
+  g_string_append_c (str, '"');
+}
+
+void
+gdk_profiler_stop (void)
+{
+  GError *error = NULL;
+  GString *str;
+  guint i;
+
+  if (!running)
+    return;
+
+  running = FALSE;
+
+  str = g_string_new ("{\"traceEvents\":[\n");
+
+  g_string_append (str, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":");
+  append_escaped (str, g_get_prgname () ? g_get_prgname () : "gtk");
+  g_string_append (str, "}}");
+
+  /* Oldest mark first */
+  for (i = 0; i < n_marks; i++)
+    {
+      GdkProfilerMark *mark;
+
+      mark = &marks[(next_mark + GDK_PROFILER_N_MARKS - n_marks + i) % GDK_PROFILER_N_MARKS];
+
+      g_string_append (str, ",\n{\"name\":");
+      append_escaped (str, mark->name);
+      g_string_append_printf (str,
+                              ",\"cat\":\"gtk\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+                              ",\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT,
+                              mark->start, mark->duration);
+      if (mark->detail)
+        {
+          g_string_append (str, ",\"args\":{\"detail\":");
+          append_escaped (str, mark->detail);
+          g_string_append_c (str, '}');
+        }
+      g_string_append_c (str, '}');
+    }
+
+  g_string_append (str, "\n]}\n");
+
+  if (!g_file_set_contents (trace_filename, str->str, str->len, &error))
+    {
+      g_warning ("Failed to write trace to %s: %s", trace_filename, error->message);
+      g_error_free (error);
+    }
+
+  g_string_free (str, TRUE);
+  g_clear_pointer (&marks, g_free);
+  g_clear_pointer (&trace_filename, g_free);
+}
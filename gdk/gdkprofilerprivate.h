@@ -0,0 +1,40 @@
+/* GDK - The GIMP Drawing Kit
+ * Copyright (C) 2016 the GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GDK_PROFILER_PRIVATE_H__
+#define __GDK_PROFILER_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void     gdk_profiler_start      (const char *filename);
+void     gdk_profiler_stop       (void);
+gboolean gdk_profiler_is_running (void);
+void     gdk_profiler_add_mark   (gint64      start,
+                                  gint64      duration,
+                                  const char *name,
+                                  const char *detail);
+void     gdk_profiler_end_mark   (gint64      start,
+                                  const char *name,
+                                  const char *detail);
+
+#define GDK_PROFILER_CURRENT_TIME (gdk_profiler_is_running () ? g_get_monotonic_time () : 0)
+
+G_END_DECLS
+
+#endif /* __GDK_PROFILER_PRIVATE_H__ */
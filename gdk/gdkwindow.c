@@ -955,7 +955,48 @@ recompute_visible_regions_internal (GdkWindow *private,
   clip_region_changed = FALSE;
   if (recalculate_clip)
     {
-      if (private->viewable)
+      new_clip = NULL;
+
+      if (private->viewable &&
+          !(should_apply_clip_as_shape (private) && private->shape) &&
+          (gdk_window_is_toplevel (private) ||
+           cairo_region_num_rectangles (private->parent->clip_region) <= 1))
+        {
+          /* Fast path for the common case of an unshaped window inside
+           * a rectangular parent clip: the clip is a single rectangle,
+           * so we can compute it without region operations and keep
+           * the old region if it didn't change. This matters when
+           * scrolling windows with many children, like GtkLayout.
+           */
+	  r.x = private->x;
+	  r.y = private->y;
+	  r.width = private->width;
+	  r.height = private->height;
+
+          if (!gdk_window_is_toplevel (private))
+            {
+              GdkRectangle parent_clip;
+
+              cairo_region_get_extents (private->parent->clip_region, &parent_clip);
+              if (!gdk_rectangle_intersect (&r, &parent_clip, &r))
+                r.width = r.height = 0;
+            }
+
+	  /* Convert from parent coords to window coords */
+          r.x -= private->x;
+          r.y -= private->y;
+
+          if (private->clip_region == NULL)
+            new_clip = cairo_region_create_rectangle (&r);
+          else if (r.width == 0 || r.height == 0)
+            {
+              if (!cairo_region_is_empty (private->clip_region))
+                new_clip = cairo_region_create ();
+            }
+          else if (!region_rect_equal (private->clip_region, &r))
+            new_clip = cairo_region_create_rectangle (&r);
+        }
+      else if (private->viewable)
 	{
 	  /* Calculate visible region (sans children) in parent window coords */
 	  r.x = private->x;
@@ -973,16 +1014,20 @@ recompute_visible_regions_internal (GdkWindow *private,
 	  if (should_apply_clip_as_shape (private) && private->shape)
 	    cairo_region_intersect (new_clip, private->shape);
 	}
-      else
-	  new_clip = cairo_region_create ();
+      else if (private->clip_region == NULL ||
+               !cairo_region_is_empty (private->clip_region))
+	new_clip = cairo_region_create ();
 
-      if (private->clip_region == NULL ||
-	  !cairo_region_equal (private->clip_region, new_clip))
-	clip_region_changed = TRUE;
+      if (new_clip != NULL)
+        {
+          if (private->clip_region == NULL ||
+              !cairo_region_equal (private->clip_region, new_clip))
+            clip_region_changed = TRUE;
 
-      if (private->clip_region)
-	cairo_region_destroy (private->clip_region);
-      private->clip_region = new_clip;
+          if (private->clip_region)
+            cairo_region_destroy (private->clip_region);
+          private->clip_region = new_clip;
+        }
     }
 
   if (clip_region_changed)
@@ -2942,6 +2987,7 @@ gdk_window_end_paint_internal (GdkWindow *window)
   GdkWindowImplClass *impl_class;
   GdkRectangle clip_box = { 0, };
   cairo_t *cr;
+  gint64 before;
 
   if (GDK_WINDOW_DESTROYED (window) ||
       !gdk_window_has_impl (window))
@@ -2953,6 +2999,8 @@ gdk_window_end_paint_internal (GdkWindow *window)
       return;
     }
 
+  before = GDK_PROFILER_CURRENT_TIME;
+
   impl_class = GDK_WINDOW_IMPL_GET_CLASS (window->impl);
 
   if (impl_class->end_paint)
@@ -3010,6 +3058,8 @@ gdk_window_end_paint_internal (GdkWindow *window)
 
   gdk_window_free_current_paint (window);
 
+  gdk_profiler_end_mark (before, "end paint", NULL);
+
   /* find a composited window in our hierarchy to signal its
    * parent to redraw, calculating the clip box as we go...
    *
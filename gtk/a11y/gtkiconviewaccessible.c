@@ -905,7 +905,7 @@ gtk_icon_view_accessible_get_n_children (AtkObject *accessible)
 
   icon_view = GTK_ICON_VIEW (widget);
 
-  return g_list_length (icon_view->priv->items);
+  return icon_view->priv->items->len;
 }
 
 static AtkObject *
@@ -935,7 +935,6 @@ gtk_icon_view_accessible_ref_child (AtkObject *accessible,
 {
   GtkIconView *icon_view;
   GtkWidget *widget;
-  GList *icons;
   AtkObject *obj;
   GtkIconViewItemAccessible *a11y_item;
 
@@ -944,11 +943,10 @@ gtk_icon_view_accessible_ref_child (AtkObject *accessible,
     return NULL;
 
   icon_view = GTK_ICON_VIEW (widget);
-  icons = g_list_nth (icon_view->priv->items, index);
   obj = NULL;
-  if (icons)
+  if (index >= 0 && index < (gint) icon_view->priv->items->len)
     {
-      GtkIconViewItem *item = icons->data;
+      GtkIconViewItem *item = g_ptr_array_index (icon_view->priv->items, index);
 
       g_return_val_if_fail (item->index == index, NULL);
       obj = gtk_icon_view_accessible_find_child (accessible, index);
@@ -1197,7 +1195,7 @@ gtk_icon_view_accessible_model_rows_reordered (GtkTreeModel *tree_model,
       info = items->data;
       item = GTK_ICON_VIEW_ITEM_ACCESSIBLE (info->item);
       info->index = order[info->index];
-      item->item = g_list_nth_data (icon_view->priv->items, info->index);
+      item->item = g_ptr_array_index (icon_view->priv->items, info->index);
       items = items->next;
     }
   g_free (order);
@@ -1396,10 +1394,11 @@ gtk_icon_view_accessible_add_selection (AtkSelection *selection,
 
   icon_view = GTK_ICON_VIEW (widget);
 
-  item = g_list_nth_data (icon_view->priv->items, i);
-  if (!item)
+  if (i < 0 || i >= (gint) icon_view->priv->items->len)
     return FALSE;
 
+  item = g_ptr_array_index (icon_view->priv->items, i);
+
   _gtk_icon_view_select_item (icon_view, item);
 
   return TRUE;
@@ -1425,10 +1424,10 @@ static AtkObject*
 gtk_icon_view_accessible_ref_selection (AtkSelection *selection,
                                         gint          i)
 {
-  GList *l;
   GtkWidget *widget;
   GtkIconView *icon_view;
   GtkIconViewItem *item;
+  guint n;
 
   widget = gtk_accessible_get_widget (GTK_ACCESSIBLE (selection));
   if (widget == NULL)
@@ -1436,10 +1435,9 @@ gtk_icon_view_accessible_ref_selection (AtkSelection *selection,
 
   icon_view = GTK_ICON_VIEW (widget);
 
-  l = icon_view->priv->items;
-  while (l)
+  for (n = 0; n < icon_view->priv->items->len; n++)
     {
-      item = l->data;
+      item = g_ptr_array_index (icon_view->priv->items, n);
       if (item->selected)
         {
           if (i == 0)
@@ -1447,7 +1445,6 @@ gtk_icon_view_accessible_ref_selection (AtkSelection *selection,
           else
             i--;
         }
-      l = l->next;
     }
 
   return NULL;
@@ -1459,7 +1456,7 @@ gtk_icon_view_accessible_get_selection_count (AtkSelection *selection)
   GtkWidget *widget;
   GtkIconView *icon_view;
   GtkIconViewItem *item;
-  GList *l;
+  guint n;
   gint count;
 
   widget = gtk_accessible_get_widget (GTK_ACCESSIBLE (selection));
@@ -1468,16 +1465,13 @@ gtk_icon_view_accessible_get_selection_count (AtkSelection *selection)
 
   icon_view = GTK_ICON_VIEW (widget);
 
-  l = icon_view->priv->items;
   count = 0;
-  while (l)
+  for (n = 0; n < icon_view->priv->items->len; n++)
     {
-      item = l->data;
+      item = g_ptr_array_index (icon_view->priv->items, n);
 
       if (item->selected)
         count++;
-
-      l = l->next;
     }
 
   return count;
@@ -1497,10 +1491,11 @@ gtk_icon_view_accessible_is_child_selected (AtkSelection *selection,
 
   icon_view = GTK_ICON_VIEW (widget);
 
-  item = g_list_nth_data (icon_view->priv->items, i);
-  if (!item)
+  if (i < 0 || i >= (gint) icon_view->priv->items->len)
     return FALSE;
 
+  item = g_ptr_array_index (icon_view->priv->items, i);
+
   return item->selected;
 }
 
@@ -1511,7 +1506,7 @@ gtk_icon_view_accessible_remove_selection (AtkSelection *selection,
   GtkWidget *widget;
   GtkIconView *icon_view;
   GtkIconViewItem *item;
-  GList *l;
+  guint n;
   gint count;
 
   widget = gtk_accessible_get_widget (GTK_ACCESSIBLE (selection));
@@ -1519,11 +1514,10 @@ gtk_icon_view_accessible_remove_selection (AtkSelection *selection,
     return FALSE;
 
   icon_view = GTK_ICON_VIEW (widget);
-  l = icon_view->priv->items;
   count = 0;
-  while (l)
+  for (n = 0; n < icon_view->priv->items->len; n++)
     {
-      item = l->data;
+      item = g_ptr_array_index (icon_view->priv->items, n);
       if (item->selected)
         {
           if (count == i)
@@ -1533,7 +1527,6 @@ gtk_icon_view_accessible_remove_selection (AtkSelection *selection,
             }
           count++;
         }
-      l = l->next;
     }
 
   return FALSE;
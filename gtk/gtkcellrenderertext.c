@@ -20,6 +20,7 @@
 #include "gtkcellrenderertext.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "gtkeditable.h"
 #include "gtkentry.h"
@@ -205,6 +206,10 @@ struct _GtkCellRendererTextPrivate
   gulong focus_out_id;
   gulong populate_popup_id;
   gulong entry_menu_popdown_timeout;
+
+  /* TextSize, most recently used first */
+  GHashTable *size_cache;
+  GQueue      size_lru;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkCellRendererText, gtk_cell_renderer_text, GTK_TYPE_CELL_RENDERER)
@@ -712,6 +717,9 @@ gtk_cell_renderer_text_finalize (GObject *object)
 
   g_clear_object (&priv->entry);
 
+  if (priv->size_cache)
+    g_hash_table_unref (priv->size_cache);
+
   G_OBJECT_CLASS (gtk_cell_renderer_text_parent_class)->finalize (object);
 }
 
@@ -1547,6 +1555,192 @@ add_attr (PangoAttrList  *attr_list,
   pango_attr_list_insert (attr_list, attr);
 }
 
+/* Tree views measure the same cells over and over while validating,
+ * scrolling and resizing; every measurement creates and shapes a new
+ * layout. We keep the sizes of the most recently measured texts, keyed
+ * by everything get_layout() uses for measuring.
+ */
+#define SIZE_CACHE_MAX 256
+
+typedef struct _TextSize TextSize;
+
+struct _TextSize
+{
+  GList link;
+  guint hash;
+
+  /* key */
+  gchar                *text;
+  PangoAttrList        *attrs;
+  PangoFontDescription *font;
+  PangoContext         *context;
+  guint                 context_serial;
+  PangoLanguage        *language;
+  gdouble               font_scale;
+  gint                  rise;
+  PangoUnderline        underline;
+  PangoEllipsizeMode    ellipsize;
+  PangoWrapMode         wrap_mode;
+  guint                 single_paragraph : 1;
+
+  /* values */
+  guint has_width  : 1;
+  guint has_height : 1;
+  gint  text_width;   /* in Pango units */
+  gint  text_x;
+  gint  char_width;   /* in Pango units */
+  gint  for_width;    /* layout width in pixels */
+  gint  height;
+};
+
+static void
+text_size_free (gpointer data)
+{
+  TextSize *size = data;
+
+  g_free (size->text);
+  if (size->attrs)
+    pango_attr_list_unref (size->attrs);
+  pango_font_description_free (size->font);
+  g_object_unref (size->context);
+
+  g_slice_free (TextSize, size);
+}
+
+static gboolean
+collect_attr (PangoAttribute *attr,
+              gpointer        data)
+{
+  GSList **list = data;
+
+  *list = g_slist_prepend (*list, attr);
+
+  return FALSE;
+}
+
+static gboolean
+attr_lists_equal (PangoAttrList *a,
+                  PangoAttrList *b)
+{
+  GSList *la = NULL, *lb = NULL, *l1, *l2;
+  gboolean equal = TRUE;
+
+  if (a == b)
+    return TRUE;
+  if (a == NULL || b == NULL)
+    return FALSE;
+
+  pango_attr_list_filter (a, collect_attr, &la);
+  pango_attr_list_filter (b, collect_attr, &lb);
+
+  for (l1 = la, l2 = lb; l1 && l2 && equal; l1 = l1->next, l2 = l2->next)
+    {
+      PangoAttribute *attr1 = l1->data;
+      PangoAttribute *attr2 = l2->data;
+
+      equal = attr1->start_index == attr2->start_index &&
+              attr1->end_index == attr2->end_index &&
+              pango_attribute_equal (attr1, attr2);
+    }
+
+  equal = equal && l1 == NULL && l2 == NULL;
+
+  g_slist_free (la);
+  g_slist_free (lb);
+
+  return equal;
+}
+
+static guint
+text_size_hash (gconstpointer data)
+{
+  return ((const TextSize *) data)->hash;
+}
+
+static gboolean
+text_size_equal (gconstpointer a,
+                 gconstpointer b)
+{
+  const TextSize *sa = a;
+  const TextSize *sb = b;
+
+  return sa->hash == sb->hash &&
+         sa->context == sb->context &&
+         sa->context_serial == sb->context_serial &&
+         sa->language == sb->language &&
+         sa->font_scale == sb->font_scale &&
+         sa->rise == sb->rise &&
+         sa->underline == sb->underline &&
+         sa->ellipsize == sb->ellipsize &&
+         sa->wrap_mode == sb->wrap_mode &&
+         sa->single_paragraph == sb->single_paragraph &&
+         strcmp (sa->text, sb->text) == 0 &&
+         pango_font_description_equal (sa->font, sb->font) &&
+         attr_lists_equal (sa->attrs, sb->attrs);
+}
+
+/* Looks up the cached sizes for the current state of @celltext,
+ * adding an empty entry if there are none. The key fields of the
+ * returned entry are borrowed from @celltext only while looking up.
+ */
+static TextSize *
+get_text_size (GtkCellRendererText *celltext,
+               GtkWidget           *widget)
+{
+  GtkCellRendererTextPrivate *priv = celltext->priv;
+  TextSize key, *size;
+
+  key.text = (gchar *) (show_placeholder_text (celltext) ? priv->placeholder_text :
+                        priv->text ? priv->text : "");
+  key.attrs = priv->extra_attrs;
+  key.font = priv->font;
+  key.context = gtk_widget_get_pango_context (widget);
+  key.context_serial = pango_context_get_serial (key.context);
+  key.language = priv->language_set ? priv->language : NULL;
+  key.font_scale = priv->scale_set ? priv->font_scale : 1.0;
+  key.rise = priv->rise_set ? priv->rise : 0;
+  key.underline = priv->underline_set ? priv->underline_style : PANGO_UNDERLINE_NONE;
+  key.ellipsize = priv->ellipsize_set ? priv->ellipsize : PANGO_ELLIPSIZE_NONE;
+  key.wrap_mode = priv->wrap_width != -1 ? priv->wrap_mode : PANGO_WRAP_CHAR;
+  key.single_paragraph = priv->single_paragraph;
+  key.hash = g_str_hash (key.text) ^ pango_font_description_hash (key.font);
+
+  if (priv->size_cache == NULL)
+    priv->size_cache = g_hash_table_new_full (text_size_hash, text_size_equal,
+                                              NULL, text_size_free);
+
+  size = g_hash_table_lookup (priv->size_cache, &key);
+  if (size)
+    {
+      g_queue_unlink (&priv->size_lru, &size->link);
+      g_queue_push_head_link (&priv->size_lru, &size->link);
+      return size;
+    }
+
+  if (g_hash_table_size (priv->size_cache) >= SIZE_CACHE_MAX)
+    {
+      GList *last = g_queue_pop_tail_link (&priv->size_lru);
+
+      g_hash_table_remove (priv->size_cache, last->data);
+    }
+
+  size = g_slice_new0 (TextSize);
+  *size = key;
+  size->text = g_strdup (key.text);
+  size->attrs = key.attrs ? pango_attr_list_copy (key.attrs) : NULL;
+  size->font = pango_font_description_copy (key.font);
+  g_object_ref (size->context);
+  size->has_width = FALSE;
+  size->has_height = FALSE;
+  size->link.data = size;
+  size->link.prev = size->link.next = NULL;
+
+  g_hash_table_add (priv->size_cache, size);
+  g_queue_push_head_link (&priv->size_lru, &size->link);
+
+  return size;
+}
+
 static PangoLayout*
 get_layout (GtkCellRendererText *celltext,
             GtkWidget           *widget,
@@ -2107,6 +2301,7 @@ gtk_cell_renderer_text_get_preferred_width (GtkCellRenderer *cell,
   PangoContext               *context;
   PangoFontMetrics           *metrics;
   PangoRectangle              rect;
+  TextSize                   *size;
   gint char_width, text_width, ellipsize_chars, xpad;
   gint min_width, nat_width;
 
@@ -2124,23 +2319,35 @@ gtk_cell_renderer_text_get_preferred_width (GtkCellRenderer *cell,
 
   gtk_cell_renderer_get_padding (cell, &xpad, NULL);
 
-  layout = get_layout (celltext, widget, NULL, 0);
+  size = get_text_size (celltext, widget);
+
+  if (!size->has_width)
+    {
+      layout = get_layout (celltext, widget, NULL, 0);
+
+      /* Fetch the length of the complete unwrapped text */
+      pango_layout_set_width (layout, -1);
+      pango_layout_get_extents (layout, NULL, &rect);
+      size->text_width = rect.width;
+      size->text_x = rect.x;
 
-  /* Fetch the length of the complete unwrapped text */
-  pango_layout_set_width (layout, -1);
-  pango_layout_get_extents (layout, NULL, &rect);
-  text_width = rect.width;
+      /* Fetch the average size of a charachter */
+      context = pango_layout_get_context (layout);
+      metrics = pango_context_get_metrics (context,
+                                           pango_context_get_font_description (context),
+                                           pango_context_get_language (context));
 
-  /* Fetch the average size of a charachter */
-  context = pango_layout_get_context (layout);
-  metrics = pango_context_get_metrics (context,
-                                       pango_context_get_font_description (context),
-                                       pango_context_get_language (context));
+      size->char_width = pango_font_metrics_get_approximate_char_width (metrics);
 
-  char_width = pango_font_metrics_get_approximate_char_width (metrics);
+      pango_font_metrics_unref (metrics);
+      g_object_unref (layout);
 
-  pango_font_metrics_unref (metrics);
-  g_object_unref (layout);
+      size->has_width = TRUE;
+    }
+
+  text_width = size->text_width;
+  rect.x = size->text_x;
+  char_width = size->char_width;
 
   /* enforce minimum width for ellipsized labels at ~3 chars */
   if (priv->ellipsize_set && priv->ellipsize != PANGO_ELLIPSIZE_NONE)
@@ -2190,6 +2397,7 @@ gtk_cell_renderer_text_get_preferred_height_for_width (GtkCellRenderer *cell,
 {
   GtkCellRendererText *celltext;
   PangoLayout         *layout;
+  TextSize            *size;
   gint                 text_height, xpad, ypad;
 
 
@@ -2197,18 +2405,29 @@ gtk_cell_renderer_text_get_preferred_height_for_width (GtkCellRenderer *cell,
 
   gtk_cell_renderer_get_padding (cell, &xpad, &ypad);
 
-  layout = get_layout (celltext, widget, NULL, 0);
+  size = get_text_size (celltext, widget);
+
+  if (size->has_height && size->for_width == width - xpad * 2)
+    text_height = size->height;
+  else
+    {
+      layout = get_layout (celltext, widget, NULL, 0);
+
+      pango_layout_set_width (layout, (width - xpad * 2) * PANGO_SCALE);
+      pango_layout_get_pixel_size (layout, NULL, &text_height);
 
-  pango_layout_set_width (layout, (width - xpad * 2) * PANGO_SCALE);
-  pango_layout_get_pixel_size (layout, NULL, &text_height);
+      g_object_unref (layout);
+
+      size->has_height = TRUE;
+      size->for_width = width - xpad * 2;
+      size->height = text_height;
+    }
 
   if (minimum_height)
     *minimum_height = text_height + ypad * 2;
 
   if (natural_height)
     *natural_height = text_height + ypad * 2;
-
-  g_object_unref (layout);
 }
 
 static void
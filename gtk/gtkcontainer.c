@@ -54,6 +54,8 @@
 #include "gtkpopovermenu.h"
 #include "gtkshortcutswindow.h"
 
+#include "gdk/gdk-private.h"
+
 /* A handful of containers inside GTK+ are cheating and widgets
  * inside internal structure as direct children for the purpose
  * of forall().
@@ -2037,6 +2039,11 @@ static void
 gtk_container_idle_sizer (GdkFrameClock *clock,
 			  GtkContainer  *container)
 {
+  gint64 before = 0;
+
+  if (GDK_PRIVATE_CALL (gdk_profiler_is_running) ())
+    before = g_get_monotonic_time ();
+
   /* We validate the style contexts in a single loop before even trying
    * to handle resizes instead of doing validations inline.
    * This is mostly necessary for compatibility reasons with old code,
@@ -2073,6 +2080,9 @@ gtk_container_idle_sizer (GdkFrameClock *clock,
       gdk_frame_clock_request_phase (clock,
                                      GDK_FRAME_CLOCK_PHASE_LAYOUT);
     }
+
+  if (before != 0)
+    GDK_PRIVATE_CALL (gdk_profiler_end_mark) (before, "size allocation", G_OBJECT_TYPE_NAME (container));
 }
 
 static void
@@ -27,6 +27,8 @@
 #include "gtksettingsprivate.h"
 #include "gtktypebuiltins.h"
 
+#include "gdk/gdk-private.h"
+
 /*
  * CSS nodes are the backbone of the GtkStyleContext implementation and
  * replace the role that GtkWidgetPath played in the past. A CSS node has
@@ -1402,10 +1404,17 @@ void
 gtk_css_node_validate (GtkCssNode *cssnode)
 {
   gint64 timestamp;
+  gint64 before = 0;
+
+  if (GDK_PRIVATE_CALL (gdk_profiler_is_running) ())
+    before = g_get_monotonic_time ();
 
   timestamp = gtk_css_node_get_timestamp (cssnode);
 
   gtk_css_node_validate_internal (cssnode, timestamp);
+
+  if (before != 0)
+    GDK_PRIVATE_CALL (gdk_profiler_end_mark) (before, "style validation", NULL);
 }
 
 gboolean
@@ -72,6 +72,7 @@
 
 #include "gtkintl.h"
 #include "gtkcellrenderertext.h"
+#include "gtkliststore.h"
 #include "gtkframe.h"
 #include "gtktreeselection.h"
 #include "gtktreeview.h"
@@ -138,6 +139,10 @@ static void     gtk_entry_completion_dispose             (GObject      *object);
 static gboolean gtk_entry_completion_visible_func        (GtkTreeModel       *model,
                                                           GtkTreeIter        *iter,
                                                           gpointer            data);
+static void     gtk_entry_completion_watch_model         (GtkEntryCompletion *completion,
+                                                          GtkTreeModel       *model);
+static void     gtk_entry_completion_clear_key_cache     (GtkEntryCompletion *completion);
+static void     gtk_entry_completion_reset_key_cache     (GtkEntryCompletion *completion);
 static gboolean gtk_entry_completion_popup_key_event     (GtkWidget          *widget,
                                                           GdkEventKey        *event,
                                                           gpointer            user_data);
@@ -664,6 +669,7 @@ gtk_entry_completion_set_property (GObject      *object,
 
       case PROP_TEXT_COLUMN:
         priv->text_column = g_value_get_int (value);
+        gtk_entry_completion_reset_key_cache (completion);
         break;
 
       case PROP_INLINE_COMPLETION:
@@ -774,6 +780,7 @@ gtk_entry_completion_finalize (GObject *object)
 
   g_free (priv->case_normalized_key);
   g_free (priv->completion_prefix);
+  g_free (priv->matches_key);
 
   if (priv->match_notify)
     (* priv->match_notify) (priv->match_data);
@@ -787,6 +794,8 @@ gtk_entry_completion_dispose (GObject *object)
   GtkEntryCompletion *completion = GTK_ENTRY_COMPLETION (object);
   GtkEntryCompletionPrivate *priv = completion->priv;
 
+  gtk_entry_completion_watch_model (completion, NULL);
+
   if (priv->tree_view)
     {
       gtk_widget_destroy (priv->tree_view);
@@ -840,6 +849,216 @@ gtk_entry_completion_get_area (GtkCellLayout *cell_layout)
   return priv->cell_area;
 }
 
+/* key cache */
+static gchar *
+gtk_entry_completion_fold_key (const gchar *text)
+{
+  gchar *normalized_string;
+  gchar *case_normalized_string;
+
+  normalized_string = g_utf8_normalize (text, -1, G_NORMALIZE_ALL);
+  if (normalized_string == NULL)
+    return NULL;
+
+  case_normalized_string = g_utf8_casefold (normalized_string, -1);
+  g_free (normalized_string);
+
+  return case_normalized_string;
+}
+
+static void
+gtk_entry_completion_clear_matches (GtkEntryCompletion *completion)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+
+  g_clear_pointer (&priv->matches, g_hash_table_unref);
+  g_clear_pointer (&priv->matches_key, g_free);
+}
+
+/* Rows of a GtkListStore are identified by iter->user_data for as
+ * long as they exist. A new row may reuse the memory of a deleted
+ * one, so its entry is dropped when it is inserted.
+ */
+static const gchar *
+gtk_entry_completion_get_row_key (GtkEntryCompletion *completion,
+                                  GtkTreeIter        *iter)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+  gpointer key;
+  gchar *item = NULL;
+  gchar *case_normalized_string = NULL;
+
+  if (g_hash_table_lookup_extended (priv->key_cache, iter->user_data, NULL, &key))
+    return key;
+
+  gtk_tree_model_get (priv->key_cache_model, iter,
+                      priv->text_column, &item,
+                      -1);
+
+  if (item != NULL)
+    case_normalized_string = gtk_entry_completion_fold_key (item);
+  g_free (item);
+
+  g_hash_table_insert (priv->key_cache, iter->user_data, case_normalized_string);
+
+  return case_normalized_string;
+}
+
+static void
+key_cache_row_inserted (GtkTreeModel       *model,
+                        GtkTreePath        *path,
+                        GtkTreeIter        *iter,
+                        GtkEntryCompletion *completion)
+{
+  if (completion->priv->key_cache)
+    g_hash_table_remove (completion->priv->key_cache, iter->user_data);
+  gtk_entry_completion_clear_matches (completion);
+}
+
+static void
+key_cache_row_deleted (GtkTreeModel       *model,
+                       GtkTreePath        *path,
+                       GtkEntryCompletion *completion)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+
+  if (priv->key_cache == NULL)
+    return;
+
+  /* We don't know which row went away, so entries of deleted rows
+   * linger until their memory is reused; drop them all once they
+   * make up half of the cache.
+   */
+  priv->key_cache_stale++;
+  if (priv->key_cache_stale > g_hash_table_size (priv->key_cache) / 2)
+    {
+      g_hash_table_remove_all (priv->key_cache);
+      priv->key_cache_stale = 0;
+    }
+
+  if (priv->key_cache_idle)
+    priv->key_cache_iter_valid = gtk_tree_model_get_iter_first (model, &priv->key_cache_iter);
+}
+
+#define KEY_CACHE_TIME_SLICE 2000 /* usec */
+#define KEY_CACHE_CHUNK_SIZE 64
+
+static gboolean
+gtk_entry_completion_key_cache_idle (gpointer data)
+{
+  GtkEntryCompletion *completion = data;
+  GtkEntryCompletionPrivate *priv = completion->priv;
+  gint64 end_time;
+  gint i;
+
+  end_time = g_get_monotonic_time () + KEY_CACHE_TIME_SLICE;
+
+  while (priv->key_cache_iter_valid)
+    {
+      for (i = 0; i < KEY_CACHE_CHUNK_SIZE && priv->key_cache_iter_valid; i++)
+        {
+          gtk_entry_completion_get_row_key (completion, &priv->key_cache_iter);
+          priv->key_cache_iter_valid = gtk_tree_model_iter_next (priv->key_cache_model,
+                                                                 &priv->key_cache_iter);
+        }
+
+      if (g_get_monotonic_time () >= end_time)
+        return G_SOURCE_CONTINUE;
+    }
+
+  priv->key_cache_idle = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+gtk_entry_completion_clear_key_cache (GtkEntryCompletion *completion)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+
+  if (priv->key_cache_idle)
+    {
+      g_source_remove (priv->key_cache_idle);
+      priv->key_cache_idle = 0;
+    }
+
+  g_clear_pointer (&priv->key_cache, g_hash_table_unref);
+  gtk_entry_completion_clear_matches (completion);
+  priv->key_cache_stale = 0;
+  priv->key_cache_iter_valid = FALSE;
+}
+
+/* The key cache must be updated before the filter model looks at a
+ * changed or inserted row again, so it watches the model from before
+ * the filter model is created, for as long as the model is set.
+ */
+static void
+gtk_entry_completion_watch_model (GtkEntryCompletion *completion,
+                                  GtkTreeModel       *model)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+
+  gtk_entry_completion_clear_key_cache (completion);
+
+  if (priv->key_cache_model)
+    {
+      g_signal_handler_disconnect (priv->key_cache_model, priv->key_cache_inserted_id);
+      g_signal_handler_disconnect (priv->key_cache_model, priv->key_cache_changed_id);
+      g_signal_handler_disconnect (priv->key_cache_model, priv->key_cache_deleted_id);
+      priv->key_cache_inserted_id = 0;
+      priv->key_cache_changed_id = 0;
+      priv->key_cache_deleted_id = 0;
+      g_clear_object (&priv->key_cache_model);
+    }
+
+  if (!GTK_IS_LIST_STORE (model))
+    return;
+
+  priv->key_cache_model = g_object_ref (model);
+
+  priv->key_cache_inserted_id =
+    g_signal_connect (model, "row-inserted",
+                      G_CALLBACK (key_cache_row_inserted), completion);
+  priv->key_cache_changed_id =
+    g_signal_connect (model, "row-changed",
+                      G_CALLBACK (key_cache_row_inserted), completion);
+  priv->key_cache_deleted_id =
+    g_signal_connect (model, "row-deleted",
+                      G_CALLBACK (key_cache_row_deleted), completion);
+}
+
+/* When the default match function is used on a GtkListStore, keep
+ * the normalized text of each row around, fill it in the background
+ * and narrow down the previous matches when the key gets longer.
+ */
+static void
+gtk_entry_completion_reset_key_cache (GtkEntryCompletion *completion)
+{
+  GtkEntryCompletionPrivate *priv = completion->priv;
+  GtkTreeModel *model;
+
+  gtk_entry_completion_clear_key_cache (completion);
+
+  model = priv->key_cache_model;
+  if (model == NULL ||
+      priv->match_func != NULL ||
+      priv->text_column < 0 ||
+      gtk_tree_model_get_column_type (model, priv->text_column) != G_TYPE_STRING)
+    return;
+
+  priv->key_cache = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  priv->key_cache_iter_valid = gtk_tree_model_get_iter_first (model, &priv->key_cache_iter);
+  if (priv->key_cache_iter_valid)
+    {
+      priv->key_cache_idle = gdk_threads_add_idle_full (G_PRIORITY_LOW,
+                                                        gtk_entry_completion_key_cache_idle,
+                                                        completion,
+                                                        NULL);
+      g_source_set_name_by_id (priv->key_cache_idle, "[gtk+] gtk_entry_completion_key_cache_idle");
+    }
+}
+
 /* all those callbacks */
 static gboolean
 gtk_entry_completion_default_completion_func (GtkEntryCompletion *completion,
@@ -860,6 +1079,15 @@ gtk_entry_completion_default_completion_func (GtkEntryCompletion *completion,
   g_return_val_if_fail (gtk_tree_model_get_column_type (model, completion->priv->text_column) == G_TYPE_STRING,
                         FALSE);
 
+  if (completion->priv->key_cache && model == completion->priv->key_cache_model)
+    {
+      const gchar *row_key;
+
+      row_key = gtk_entry_completion_get_row_key (completion, iter);
+
+      return row_key != NULL && strncmp (key, row_key, strlen (key)) == 0;
+    }
+
   gtk_tree_model_get (model, iter,
                       completion->priv->text_column, &item,
                       -1);
@@ -902,10 +1130,26 @@ gtk_entry_completion_visible_func (GtkTreeModel *model,
                                             iter,
                                             completion->priv->match_data);
   else if (completion->priv->text_column >= 0)
-    ret = gtk_entry_completion_default_completion_func (completion,
-                                                        completion->priv->case_normalized_key,
-                                                        iter,
-                                                        NULL);
+    {
+      GtkEntryCompletionPrivate *priv = completion->priv;
+
+      if (priv->new_matches)
+        {
+          g_hash_table_add (priv->evaluated, iter->user_data);
+
+          /* rows that didn't match a prefix of the key can't match */
+          if (priv->matches && !g_hash_table_contains (priv->matches, iter->user_data))
+            return FALSE;
+        }
+
+      ret = gtk_entry_completion_default_completion_func (completion,
+                                                          priv->case_normalized_key,
+                                                          iter,
+                                                          NULL);
+
+      if (ret && priv->new_matches)
+        g_hash_table_add (priv->new_matches, iter->user_data);
+    }
 
   return ret;
 }
@@ -1144,9 +1388,12 @@ gtk_entry_completion_set_model (GtkEntryCompletion *completion,
                                NULL);
       _gtk_entry_completion_popdown (completion);
       completion->priv->filter_model = NULL;
+      gtk_entry_completion_watch_model (completion, NULL);
       return;
     }
 
+  gtk_entry_completion_watch_model (completion, model);
+
   /* code will unref the old filter model (if any) */
   completion->priv->filter_model =
     GTK_TREE_MODEL_FILTER (gtk_tree_model_filter_new (model, NULL));
@@ -1159,6 +1406,8 @@ gtk_entry_completion_set_model (GtkEntryCompletion *completion,
                            GTK_TREE_MODEL (completion->priv->filter_model));
   g_object_unref (completion->priv->filter_model);
 
+  gtk_entry_completion_reset_key_cache (completion);
+
   g_object_notify_by_pspec (G_OBJECT (completion), entry_completion_props[PROP_MODEL]);
 
   if (gtk_widget_get_visible (completion->priv->popup_window))
@@ -1215,6 +1464,8 @@ gtk_entry_completion_set_match_func (GtkEntryCompletion          *completion,
   completion->priv->match_func = func;
   completion->priv->match_data = func_data;
   completion->priv->match_notify = func_notify;
+
+  gtk_entry_completion_reset_key_cache (completion);
 }
 
 /**
@@ -1276,23 +1527,57 @@ gtk_entry_completion_get_minimum_key_length (GtkEntryCompletion *completion)
 void
 gtk_entry_completion_complete (GtkEntryCompletion *completion)
 {
+  GtkEntryCompletionPrivate *priv;
   gchar *tmp;
   GtkTreeIter iter;
 
   g_return_if_fail (GTK_IS_ENTRY_COMPLETION (completion));
   g_return_if_fail (GTK_IS_ENTRY (completion->priv->entry));
 
-  if (!completion->priv->filter_model)
+  priv = completion->priv;
+
+  if (!priv->filter_model)
     return;
 
-  g_free (completion->priv->case_normalized_key);
+  g_free (priv->case_normalized_key);
 
-  tmp = g_utf8_normalize (gtk_entry_get_text (GTK_ENTRY (completion->priv->entry)),
+  tmp = g_utf8_normalize (gtk_entry_get_text (GTK_ENTRY (priv->entry)),
                           -1, G_NORMALIZE_ALL);
-  completion->priv->case_normalized_key = g_utf8_casefold (tmp, -1);
+  priv->case_normalized_key = g_utf8_casefold (tmp, -1);
   g_free (tmp);
 
-  gtk_tree_model_filter_refilter (completion->priv->filter_model);
+  if (priv->key_cache)
+    {
+      if (priv->matches_key == NULL ||
+          !g_str_has_prefix (priv->case_normalized_key, priv->matches_key))
+        gtk_entry_completion_clear_matches (completion);
+
+      priv->new_matches = g_hash_table_new (NULL, NULL);
+      priv->evaluated = g_hash_table_new (NULL, NULL);
+    }
+
+  gtk_tree_model_filter_refilter (priv->filter_model);
+
+  if (priv->new_matches)
+    {
+      gtk_entry_completion_clear_matches (completion);
+
+      /* the filter model only checks the rows it has been asked
+       * about, and may ask about a row more than once, so the matches
+       * can only be reused if it saw every row
+       */
+      if (priv->key_cache &&
+          g_hash_table_size (priv->evaluated) >= (guint) gtk_tree_model_iter_n_children (priv->key_cache_model, NULL))
+        {
+          priv->matches = priv->new_matches;
+          priv->matches_key = g_strdup (priv->case_normalized_key);
+        }
+      else
+        g_hash_table_unref (priv->new_matches);
+
+      priv->new_matches = NULL;
+      g_clear_pointer (&priv->evaluated, g_hash_table_unref);
+    }
 
   if (!gtk_tree_model_get_iter_first (GTK_TREE_MODEL (completion->priv->filter_model), &iter))
     g_signal_emit (completion, entry_completion_signals[NO_MATCHES], 0);
@@ -1433,6 +1718,7 @@ gtk_entry_completion_set_text_column (GtkEntryCompletion *completion,
     return;
 
   completion->priv->text_column = column;
+  gtk_entry_completion_reset_key_cache (completion);
 
   cell = gtk_cell_renderer_text_new ();
   gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (completion),
@@ -47,6 +47,23 @@ struct _GtkEntryCompletionPrivate
 
   gchar *case_normalized_key;
 
+  /* Normalized, casefolded text_column values of the rows of a
+   * GtkListStore, keyed by their iter user_data, the rows that
+   * matched the last key, and the rows looked at while refiltering
+   */
+  GtkTreeModel *key_cache_model;
+  GHashTable *key_cache;
+  GHashTable *matches;
+  GHashTable *new_matches;
+  gchar *matches_key;
+  GtkTreeIter key_cache_iter;
+  guint key_cache_idle;
+  guint key_cache_stale;
+  GHashTable *evaluated;
+  gulong key_cache_inserted_id;
+  gulong key_cache_changed_id;
+  gulong key_cache_deleted_id;
+
   /* only used by GtkEntry when attached: */
   GtkWidget *popup_window;
   GtkWidget *vbox;
@@ -68,6 +85,7 @@ struct _GtkEntryCompletionPrivate
   guint popup_single_match : 1;
   guint inline_selection   : 1;
   guint has_grab           : 1;
+  guint key_cache_iter_valid : 1;
 
   gchar *completion_prefix;
 
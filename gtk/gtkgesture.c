@@ -1339,6 +1339,80 @@ gtk_gesture_get_point (GtkGesture       *gesture,
   return TRUE;
 }
 
+/**
+ * gtk_gesture_get_point_history:
+ * @gesture: a #GtkGesture
+ * @sequence: (allow-none): a #GdkEventSequence, or %NULL for pointer events
+ * @events: (out) (array length=n_events) (transfer full) (optional): return
+ *   location for an array of #GdkTimeCoord, or %NULL
+ * @n_events: (out) (optional): return location for the length of @events, or %NULL
+ *
+ * If the last event of @sequence was a motion event that other motion
+ * events were merged into, this function returns %TRUE and the history
+ * of those events, oldest first. The current coordinates, as returned by
+ * gtk_gesture_get_point(), are not part of the history.
+ *
+ * This is like gdk_event_get_motion_history(), but the X and Y axes are
+ * relative to the widget allocation. The array must be freed with
+ * gdk_device_free_history().
+ *
+ * Returns: %TRUE if there is a history for @sequence
+ *
+ * Since: 3.22
+ **/
+gboolean
+gtk_gesture_get_point_history (GtkGesture         *gesture,
+                               GdkEventSequence   *sequence,
+                               GdkTimeCoord     ***events,
+                               gint               *n_events)
+{
+  GtkGesturePrivate *priv;
+  GdkTimeCoord **history;
+  GdkDevice *device;
+  PointData *data;
+  gdouble event_x, event_y;
+  gint n_history, n_axes, i, j;
+
+  g_return_val_if_fail (GTK_IS_GESTURE (gesture), FALSE);
+
+  priv = gtk_gesture_get_instance_private (gesture);
+
+  if (!g_hash_table_lookup_extended (priv->points, sequence,
+                                     NULL, (gpointer *) &data))
+    return FALSE;
+
+  if (!gdk_event_get_motion_history (data->event, &history, &n_history))
+    return FALSE;
+
+  _get_event_coordinates (data, &event_x, &event_y);
+  device = gdk_event_get_device (data->event);
+  /* The history only has room for this many axes */
+  n_axes = MIN (gdk_device_get_n_axes (device), GDK_MAX_TIMECOORD_AXES);
+
+  for (j = 0; j < n_axes; j++)
+    {
+      GdkAxisUse use = gdk_device_get_axis_use (device, j);
+
+      for (i = 0; i < n_history; i++)
+        {
+          if (use == GDK_AXIS_X)
+            history[i]->axes[j] += data->widget_x - event_x;
+          else if (use == GDK_AXIS_Y)
+            history[i]->axes[j] += data->widget_y - event_y;
+        }
+    }
+
+  if (events)
+    *events = history;
+  else
+    gdk_device_free_history (history, n_history);
+
+  if (n_events)
+    *n_events = n_history;
+
+  return TRUE;
+}
+
 gboolean
 _gtk_gesture_get_last_update_time (GtkGesture       *gesture,
                                    GdkEventSequence *sequence,
@@ -75,6 +75,11 @@ gboolean    gtk_gesture_get_point            (GtkGesture       *gesture,
                                               GdkEventSequence *sequence,
                                               gdouble          *x,
                                               gdouble          *y);
+GDK_AVAILABLE_IN_3_22
+gboolean    gtk_gesture_get_point_history    (GtkGesture         *gesture,
+                                              GdkEventSequence   *sequence,
+                                              GdkTimeCoord     ***events,
+                                              gint               *n_events);
 GDK_AVAILABLE_IN_3_14
 gboolean    gtk_gesture_get_bounding_box     (GtkGesture       *gesture,
                                               GdkRectangle     *rect);
@@ -22,6 +22,7 @@
 #include "gtkiconhelperprivate.h"
 
 #include <math.h>
+#include <string.h>
 
 #include "gtkcssenumvalueprivate.h"
 #include "gtkcssiconthemevalueprivate.h"
@@ -29,6 +30,7 @@
 #include "gtkcssstyleprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkcsstransientnodeprivate.h"
+#include "gtkiconsurfacecacheprivate.h"
 #include "gtkiconthemeprivate.h"
 #include "gtkrendericonprivate.h"
 #include "deprecated/gtkiconfactoryprivate.h"
@@ -42,6 +44,7 @@ struct _GtkIconHelperPrivate {
 
   guint use_fallback : 1;
   guint force_scale_pixbuf : 1;
+  guint load_async : 1;
   guint rendered_surface_is_symbolic : 1;
 
   cairo_surface_t *rendered_surface;
@@ -49,6 +52,158 @@ struct _GtkIconHelperPrivate {
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkIconHelper, gtk_icon_helper, GTK_TYPE_CSS_GADGET)
 
+/* When loading asynchronously, icons that are not loaded yet are
+ * handed to gtk_icon_info_load_icon_async(), which decodes them in
+ * GTask's thread pool. Until that is done, the icon helper draws
+ * nothing, at the size of its icon size.
+ *
+ * Lookups of the same GIcon can return a new GtkIconInfo each time,
+ * so loads are keyed like the surface cache, by what is loaded. All
+ * icon helpers asking for the same key share one load, and when it
+ * is done the rendered surface goes to the surface cache, where their
+ * next lookup finds it. Icons that can't be cached are always loaded
+ * synchronously, and so are keys whose load did not end up in the
+ * cache, e.g. because it failed.
+ */
+#define ASYNC_UNCACHED_SIZE 256
+
+typedef struct {
+  GtkWidget *owner;
+  gboolean resize;
+} AsyncLoadOwner;
+
+typedef struct {
+  GtkIconSurfaceKey *key;
+  GSList *owners;               /* of AsyncLoadOwner */
+} AsyncLoad;
+
+static GHashTable *async_loads;     /* GtkIconSurfaceKey -> AsyncLoad */
+static GHashTable *async_uncached;  /* set of GtkIconSurfaceKey */
+
+/* Surfaces of GFileIcons are keyed by the modification time their file
+ * had when it was loaded, as remembered here, so that lookups don't
+ * touch the disk. A lookup that finds its surface cached checks the
+ * file again asynchronously, and if it changed, the icon helpers that
+ * asked are invalidated and their next lookup loads it again.
+ */
+#define FILE_MTIMES_SIZE 256
+
+typedef struct {
+  gchar *filename;
+  GSList *helpers;              /* of GtkIconHelper */
+} MtimeCheck;
+
+static GHashTable *file_mtimes;     /* filename -> guint64 *, in microseconds */
+static GHashTable *mtime_checks;    /* filename -> MtimeCheck */
+
+static void gtk_icon_helper_invalidate (GtkIconHelper *self);
+
+static guint64
+file_mtime_lookup (const gchar *filename)
+{
+  guint64 *mtime;
+
+  if (file_mtimes == NULL)
+    return 0;
+
+  mtime = g_hash_table_lookup (file_mtimes, filename);
+
+  return mtime ? *mtime : 0;
+}
+
+static void
+file_mtime_update (const gchar *filename,
+                   guint64      mtime)
+{
+  if (file_mtimes == NULL)
+    file_mtimes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  else if (g_hash_table_size (file_mtimes) >= FILE_MTIMES_SIZE &&
+           !g_hash_table_contains (file_mtimes, filename))
+    g_hash_table_remove_all (file_mtimes);
+
+  g_hash_table_insert (file_mtimes,
+                       g_strdup (filename),
+                       g_memdup (&mtime, sizeof (guint64)));
+}
+
+static void
+mtime_check_done (GObject      *source,
+                  GAsyncResult *result,
+                  gpointer      data)
+{
+  MtimeCheck *check = data;
+  GFileInfo *info;
+  guint64 mtime;
+  GSList *l;
+
+  g_hash_table_remove (mtime_checks, check->filename);
+
+  info = g_file_query_info_finish (G_FILE (source), result, NULL);
+  if (info != NULL)
+    {
+      mtime = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+              g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+      g_object_unref (info);
+    }
+  else
+    mtime = 0;
+
+  if (mtime != file_mtime_lookup (check->filename))
+    {
+      file_mtime_update (check->filename, mtime);
+
+      for (l = check->helpers; l; l = l->next)
+        {
+          GtkIconHelper *helper = l->data;
+          GtkWidget *owner = gtk_css_gadget_get_owner (GTK_CSS_GADGET (helper));
+
+          if (!gtk_widget_in_destruction (owner))
+            gtk_icon_helper_invalidate (helper);
+        }
+    }
+
+  g_slist_free_full (check->helpers, g_object_unref);
+  g_free (check->filename);
+  g_slice_free (MtimeCheck, check);
+}
+
+/* Checks asynchronously whether the file @self found a cached surface
+ * for changed since it was loaded. At most one check per file runs.
+ */
+static void
+gtk_icon_helper_check_mtime (GtkIconHelper *self,
+                             const gchar   *filename)
+{
+  MtimeCheck *check;
+  GFile *file;
+
+  if (mtime_checks == NULL)
+    mtime_checks = g_hash_table_new (g_str_hash, g_str_equal);
+
+  check = g_hash_table_lookup (mtime_checks, filename);
+  if (check != NULL)
+    {
+      if (!g_slist_find (check->helpers, self))
+        check->helpers = g_slist_prepend (check->helpers, g_object_ref (self));
+      return;
+    }
+
+  check = g_slice_new (MtimeCheck);
+  check->filename = g_strdup (filename);
+  check->helpers = g_slist_prepend (NULL, g_object_ref (self));
+  g_hash_table_insert (mtime_checks, check->filename, check);
+
+  file = g_file_new_for_path (filename);
+  g_file_query_info_async (file,
+                           G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                           G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                           G_FILE_QUERY_INFO_NONE,
+                           G_PRIORITY_DEFAULT,
+                           NULL,
+                           mtime_check_done, check);
+  g_object_unref (file);
+}
+
 static void
 gtk_icon_helper_invalidate (GtkIconHelper *self)
 {
@@ -427,6 +582,166 @@ ensure_surface_for_icon_set (GtkIconHelper    *self,
   return surface;
 }
 
+static GtkIconSurfaceKey *
+async_key_copy (const GtkIconSurfaceKey *key)
+{
+  GtkIconSurfaceKey *copy;
+
+  copy = g_slice_dup (GtkIconSurfaceKey, key);
+  copy->filename = g_strdup (key->filename);
+
+  return copy;
+}
+
+static void
+async_key_free (gpointer data)
+{
+  GtkIconSurfaceKey *key = data;
+
+  g_free ((char *) key->filename);
+  g_slice_free (GtkIconSurfaceKey, key);
+}
+
+static void
+async_load_done (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      data)
+{
+  GtkIconInfo *info = GTK_ICON_INFO (source);
+  AsyncLoad *load = data;
+  cairo_surface_t *surface;
+  GdkPixbuf *pixbuf;
+  gboolean cached;
+  GSList *l;
+
+  if (load->key->symbolic)
+    pixbuf = gtk_icon_info_load_symbolic_finish (info, result, NULL, NULL);
+  else
+    pixbuf = gtk_icon_info_load_icon_finish (info, result, NULL);
+
+  g_hash_table_remove (async_loads, load->key);
+
+  /* Cache what was loaded under the time the file had then */
+  if (load->key->mtime != gtk_icon_info_get_file_mtime (info))
+    {
+      load->key->mtime = gtk_icon_info_get_file_mtime (info);
+      file_mtime_update (load->key->filename, load->key->mtime);
+    }
+
+  cached = FALSE;
+  if (pixbuf)
+    {
+      surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, load->key->scale, NULL);
+      if (!load->key->symbolic)
+        gtk_css_icon_effect_apply (load->key->icon_effect, surface);
+
+      cached = gtk_icon_surface_cache_insert (load->key, surface);
+
+      cairo_surface_destroy (surface);
+      g_object_unref (pixbuf);
+    }
+
+  if (cached)
+    {
+      async_key_free (load->key);
+    }
+  else
+    {
+      if (async_uncached == NULL)
+        async_uncached = g_hash_table_new_full (gtk_icon_surface_key_hash,
+                                                gtk_icon_surface_key_equal,
+                                                async_key_free, NULL);
+      else if (g_hash_table_size (async_uncached) >= ASYNC_UNCACHED_SIZE)
+        g_hash_table_remove_all (async_uncached);
+
+      g_hash_table_add (async_uncached, load->key);
+    }
+
+  for (l = load->owners; l; l = l->next)
+    {
+      AsyncLoadOwner *load_owner = l->data;
+
+      if (!gtk_widget_in_destruction (load_owner->owner))
+        {
+          if (load_owner->resize)
+            gtk_widget_queue_resize (load_owner->owner);
+          else
+            gtk_widget_queue_draw (load_owner->owner);
+        }
+
+      g_object_unref (load_owner->owner);
+      g_slice_free (AsyncLoadOwner, load_owner);
+    }
+  g_slist_free (load->owners);
+  g_slice_free (AsyncLoad, load);
+}
+
+/* Returns %TRUE if the icon for @key is being loaded from @info,
+ * and @self will be redrawn when it is in the surface cache.
+ */
+static gboolean
+gtk_icon_helper_load_async (GtkIconHelper           *self,
+                            GtkIconInfo             *info,
+                            const GtkIconSurfaceKey *key)
+{
+  GtkWidget *owner;
+  AsyncLoadOwner *load_owner;
+  AsyncLoad *load;
+  GSList *l;
+
+  if (gtk_icon_info_is_loaded (info))
+    return FALSE;
+
+  if (async_uncached != NULL &&
+      g_hash_table_contains (async_uncached, key))
+    return FALSE;
+
+  if (async_loads == NULL)
+    async_loads = g_hash_table_new (gtk_icon_surface_key_hash,
+                                    gtk_icon_surface_key_equal);
+
+  owner = gtk_css_gadget_get_owner (GTK_CSS_GADGET (self));
+
+  load = g_hash_table_lookup (async_loads, key);
+  if (load != NULL)
+    {
+      for (l = load->owners; l; l = l->next)
+        {
+          if (((AsyncLoadOwner *) l->data)->owner == owner)
+            return TRUE;
+        }
+    }
+
+  load_owner = g_slice_new (AsyncLoadOwner);
+  load_owner->owner = g_object_ref (owner);
+  /* Icons with a fixed size don't change our size when they arrive */
+  load_owner->resize = self->priv->pixel_size == -1 &&
+                       !self->priv->force_scale_pixbuf &&
+                       !GTK_IS_CSS_TRANSIENT_NODE (gtk_css_gadget_get_node (GTK_CSS_GADGET (self)));
+
+  if (load != NULL)
+    {
+      load->owners = g_slist_prepend (load->owners, load_owner);
+      return TRUE;
+    }
+
+  load = g_slice_new (AsyncLoad);
+  load->key = async_key_copy (key);
+  load->owners = g_slist_prepend (NULL, load_owner);
+  g_hash_table_insert (async_loads, load->key, load);
+
+  if (key->symbolic)
+    gtk_icon_info_load_symbolic_async (info,
+                                       &key->fg, &key->success_color,
+                                       &key->warning_color, &key->error_color,
+                                       NULL,
+                                       async_load_done, load);
+  else
+    gtk_icon_info_load_icon_async (info, NULL, async_load_done, load);
+
+  return TRUE;
+}
+
 static cairo_surface_t *
 ensure_surface_for_gicon (GtkIconHelper    *self,
                           GtkCssStyle      *style,
@@ -442,6 +757,7 @@ ensure_surface_for_gicon (GtkIconHelper    *self,
   cairo_surface_t *surface;
   GdkPixbuf *destination;
   gboolean symbolic;
+  GtkIconSurfaceKey key;
 
   icon_theme = gtk_css_icon_theme_value_get_icon_theme
     (gtk_css_style_get_value (style, GTK_CSS_PROPERTY_ICON_THEME));
@@ -453,28 +769,60 @@ ensure_surface_for_gicon (GtkIconHelper    *self,
                                                    gicon,
                                                    MIN (width, height),
                                                    scale, flags);
+
+  memset (&key, 0, sizeof (key));
   if (info)
     {
-      symbolic = gtk_icon_info_is_symbolic (info);
-
-      if (symbolic)
-        {
-          GdkRGBA fg, success_color, warning_color, error_color;
+      key.filename = gtk_icon_info_get_filename (info);
+      key.size = MIN (width, height);
+      key.scale = scale;
+      key.force_size = (flags & GTK_ICON_LOOKUP_FORCE_SIZE) != 0;
+      key.symbolic = gtk_icon_info_is_symbolic (info);
+      if (key.symbolic)
+        gtk_icon_theme_lookup_symbolic_colors (style, &key.fg, &key.success_color, &key.warning_color, &key.error_color);
+      else
+        key.icon_effect = _gtk_css_icon_effect_value_get (gtk_css_style_get_value (style, GTK_CSS_PROPERTY_ICON_EFFECT));
 
-          gtk_icon_theme_lookup_symbolic_colors (style, &fg, &success_color, &warning_color, &error_color);
+      /* Emblemed icons have the filename of their base icon */
+      if (gtk_icon_info_has_emblems (info))
+        key.filename = NULL;
+      else if (key.filename != NULL && G_IS_FILE_ICON (gicon))
+        key.mtime = file_mtime_lookup (key.filename);
+    }
 
-          destination = gtk_icon_info_load_symbolic (info,
-                                                     &fg, &success_color,
-                                                     &warning_color, &error_color,
-                                                     NULL,
-                                                     NULL);
-        }
-      else
+  if (key.filename != NULL)
+    {
+      surface = gtk_icon_surface_cache_lookup (&key);
+      if (surface != NULL)
         {
-          destination = gtk_icon_info_load_icon (info, NULL);
+          if (key.symbolic)
+            priv->rendered_surface_is_symbolic = TRUE;
+          if (G_IS_FILE_ICON (gicon))
+            gtk_icon_helper_check_mtime (self, key.filename);
+          g_object_unref (info);
+          return surface;
         }
+    }
 
+  if (key.filename != NULL && priv->load_async &&
+      gtk_icon_helper_load_async (self, info, &key))
+    {
       g_object_unref (info);
+      return NULL;
+    }
+
+  if (info)
+    {
+      symbolic = key.symbolic;
+
+      if (symbolic)
+        destination = gtk_icon_info_load_symbolic (info,
+                                                   &key.fg, &key.success_color,
+                                                   &key.warning_color, &key.error_color,
+                                                   NULL,
+                                                   NULL);
+      else
+        destination = gtk_icon_info_load_icon (info, NULL);
     }
   else
     {
@@ -492,6 +840,7 @@ ensure_surface_for_gicon (GtkIconHelper    *self,
        * the icontheme code is broken */
       g_assert (destination);
       symbolic = FALSE;
+      key.filename = NULL;
     }
 
   surface = gdk_cairo_surface_create_from_pixbuf (destination, scale, gtk_widget_get_window (gtk_css_gadget_get_owner (GTK_CSS_GADGET (self))));
@@ -508,6 +857,18 @@ ensure_surface_for_gicon (GtkIconHelper    *self,
       priv->rendered_surface_is_symbolic = TRUE;
     }
 
+  /* key.filename points into info */
+  if (key.filename != NULL)
+    {
+      if (key.mtime != gtk_icon_info_get_file_mtime (info))
+        {
+          key.mtime = gtk_icon_info_get_file_mtime (info);
+          file_mtime_update (key.filename, key.mtime);
+        }
+      gtk_icon_surface_cache_insert (&key, surface);
+    }
+
+  g_clear_object (&info);
   g_object_unref (destination);
 
   return surface;
@@ -926,6 +1287,25 @@ _gtk_icon_helper_set_force_scale_pixbuf (GtkIconHelper *self,
     }
 }
 
+gboolean
+_gtk_icon_helper_get_load_async (GtkIconHelper *self)
+{
+  return self->priv->load_async;
+}
+
+gboolean
+_gtk_icon_helper_set_load_async (GtkIconHelper *self,
+                                 gboolean       load_async)
+{
+  if (self->priv->load_async != load_async)
+    {
+      self->priv->load_async = load_async;
+      gtk_icon_helper_invalidate (self);
+      return TRUE;
+    }
+  return FALSE;
+}
+
 void 
 _gtk_icon_helper_set_pixbuf_scale (GtkIconHelper *self,
 				   int scale)
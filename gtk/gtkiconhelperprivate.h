@@ -138,6 +138,10 @@ gboolean _gtk_icon_helper_get_force_scale_pixbuf (GtkIconHelper *self);
 void     _gtk_icon_helper_set_force_scale_pixbuf (GtkIconHelper *self,
                                                   gboolean       force_scale);
 
+gboolean _gtk_icon_helper_get_load_async (GtkIconHelper *self);
+gboolean _gtk_icon_helper_set_load_async (GtkIconHelper *self,
+                                          gboolean       load_async);
+
 void      gtk_icon_helper_invalidate_for_change (GtkIconHelper     *self,
                                                  GtkCssStyleChange *change);
 
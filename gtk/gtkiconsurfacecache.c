@@ -0,0 +1,256 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2016 the GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gtkiconsurfacecacheprivate.h"
+
+/* The icon surface cache keeps the surfaces rendered for icons from
+ * the icon theme, so that widgets showing the same icon, at the same
+ * size and in the same colors, share one surface instead of each
+ * loading and decoding the file again.
+ *
+ * The cache is process-wide and is only used from the main thread.
+ * It holds at most a budget of bytes, evicting the least recently
+ * used surfaces first. The budget can be set in kilobytes with the
+ * GTK_ICON_SURFACE_CACHE_SIZE environment variable.
+ *
+ * Files that are not part of an icon theme are keyed by their
+ * modification time too, so that a file rewritten in place is not
+ * drawn from its old surface. Icons with emblems are not cached,
+ * they would share the filename of their base icon.
+ *
+ * Cached surfaces are shared, so they must not be modified.
+ */
+
+#define DEFAULT_BUDGET (16 * 1024 * 1024)
+
+typedef struct _IconSurface IconSurface;
+
+struct _IconSurface
+{
+  GtkIconSurfaceKey key;        /* owns key.filename */
+  cairo_surface_t *surface;
+  gsize size;
+  GList link;                   /* in lru */
+};
+
+static GHashTable *surfaces;
+static GQueue lru = G_QUEUE_INIT;  /* most recently used first */
+static GtkIconSurfaceCacheStats stats;
+
+static guint
+hash_rgba (const GdkRGBA *rgba)
+{
+  return ((guint) (rgba->red * 255) << 24) |
+         ((guint) (rgba->green * 255) << 16) |
+         ((guint) (rgba->blue * 255) << 8) |
+         ((guint) (rgba->alpha * 255));
+}
+
+guint
+gtk_icon_surface_key_hash (gconstpointer data)
+{
+  const GtkIconSurfaceKey *key = data;
+  guint h;
+
+  h = g_str_hash (key->filename);
+  h = h * 31 + (guint) key->mtime;
+  h = h * 31 + key->size;
+  h = h * 31 + key->scale;
+  h = h * 31 + (key->force_size << 1 | key->symbolic);
+
+  if (key->symbolic)
+    {
+      h = h * 31 + hash_rgba (&key->fg);
+      h = h * 31 + hash_rgba (&key->success_color);
+      h = h * 31 + hash_rgba (&key->warning_color);
+      h = h * 31 + hash_rgba (&key->error_color);
+    }
+  else
+    h = h * 31 + key->icon_effect;
+
+  return h;
+}
+
+gboolean
+gtk_icon_surface_key_equal (gconstpointer a,
+                            gconstpointer b)
+{
+  const GtkIconSurfaceKey *key_a = a;
+  const GtkIconSurfaceKey *key_b = b;
+
+  if (key_a->mtime != key_b->mtime ||
+      key_a->size != key_b->size ||
+      key_a->scale != key_b->scale ||
+      key_a->force_size != key_b->force_size ||
+      key_a->symbolic != key_b->symbolic ||
+      strcmp (key_a->filename, key_b->filename) != 0)
+    return FALSE;
+
+  if (key_a->symbolic)
+    return gdk_rgba_equal (&key_a->fg, &key_b->fg) &&
+           gdk_rgba_equal (&key_a->success_color, &key_b->success_color) &&
+           gdk_rgba_equal (&key_a->warning_color, &key_b->warning_color) &&
+           gdk_rgba_equal (&key_a->error_color, &key_b->error_color);
+  else
+    return key_a->icon_effect == key_b->icon_effect;
+}
+
+static void
+icon_surface_free (gpointer data)
+{
+  IconSurface *icon = data;
+
+  g_queue_unlink (&lru, &icon->link);
+  stats.size -= icon->size;
+
+  g_free ((char *) icon->key.filename);
+  cairo_surface_destroy (icon->surface);
+  g_slice_free (IconSurface, icon);
+}
+
+static void
+ensure_surfaces (void)
+{
+  const char *env;
+
+  if (surfaces != NULL)
+    return;
+
+  surfaces = g_hash_table_new_full (gtk_icon_surface_key_hash,
+                                    gtk_icon_surface_key_equal,
+                                    NULL,
+                                    icon_surface_free);
+
+  env = g_getenv ("GTK_ICON_SURFACE_CACHE_SIZE");
+  if (env != NULL)
+    stats.budget = (gsize) g_ascii_strtoull (env, NULL, 10) * 1024;
+  else
+    stats.budget = DEFAULT_BUDGET;
+}
+
+static void
+icon_surface_cache_trim (void)
+{
+  while (stats.size > stats.budget && lru.tail != NULL)
+    {
+      IconSurface *icon = lru.tail->data;
+
+      g_hash_table_remove (surfaces, &icon->key);
+      stats.evictions++;
+    }
+
+  stats.n_surfaces = g_hash_table_size (surfaces);
+}
+
+/* Returns a new reference to the surface cached for @key, or %NULL */
+cairo_surface_t *
+gtk_icon_surface_cache_lookup (const GtkIconSurfaceKey *key)
+{
+  IconSurface *icon;
+
+  g_return_val_if_fail (key != NULL, NULL);
+  g_return_val_if_fail (key->filename != NULL, NULL);
+
+  ensure_surfaces ();
+
+  icon = g_hash_table_lookup (surfaces, key);
+  if (icon == NULL)
+    {
+      stats.misses++;
+      return NULL;
+    }
+
+  stats.hits++;
+
+  g_queue_unlink (&lru, &icon->link);
+  g_queue_push_head_link (&lru, &icon->link);
+
+  return cairo_surface_reference (icon->surface);
+}
+
+/* Returns %TRUE if @surface was added. Only image surfaces that fit
+ * in the budget are.
+ */
+gboolean
+gtk_icon_surface_cache_insert (const GtkIconSurfaceKey *key,
+                               cairo_surface_t         *surface)
+{
+  IconSurface *icon;
+  gsize size;
+
+  g_return_val_if_fail (key != NULL, FALSE);
+  g_return_val_if_fail (key->filename != NULL, FALSE);
+  g_return_val_if_fail (surface != NULL, FALSE);
+
+  ensure_surfaces ();
+
+  if (cairo_surface_get_type (surface) != CAIRO_SURFACE_TYPE_IMAGE)
+    return FALSE;
+
+  size = cairo_image_surface_get_stride (surface) * cairo_image_surface_get_height (surface);
+  if (size > stats.budget)
+    return FALSE;
+
+  icon = g_slice_new0 (IconSurface);
+  icon->key = *key;
+  icon->key.filename = g_strdup (key->filename);
+  icon->surface = cairo_surface_reference (surface);
+  icon->size = size;
+  icon->link.data = icon;
+
+  /* Replaces (and frees) an existing surface for the same key */
+  g_hash_table_replace (surfaces, &icon->key, icon);
+  g_queue_push_head_link (&lru, &icon->link);
+  stats.size += size;
+
+  icon_surface_cache_trim ();
+
+  return TRUE;
+}
+
+void
+gtk_icon_surface_cache_clear (void)
+{
+  if (surfaces == NULL)
+    return;
+
+  g_hash_table_remove_all (surfaces);
+  stats.n_surfaces = 0;
+}
+
+void
+gtk_icon_surface_cache_set_budget (gsize budget)
+{
+  ensure_surfaces ();
+
+  stats.budget = budget;
+  icon_surface_cache_trim ();
+}
+
+void
+gtk_icon_surface_cache_get_stats (GtkIconSurfaceCacheStats *out)
+{
+  g_return_if_fail (out != NULL);
+
+  ensure_surfaces ();
+
+  *out = stats;
+}
@@ -0,0 +1,69 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2016 the GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_ICON_SURFACE_CACHE_PRIVATE_H__
+#define __GTK_ICON_SURFACE_CACHE_PRIVATE_H__
+
+#include <gdk/gdk.h>
+
+#include "gtkcsstypesprivate.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GtkIconSurfaceKey GtkIconSurfaceKey;
+typedef struct _GtkIconSurfaceCacheStats GtkIconSurfaceCacheStats;
+
+struct _GtkIconSurfaceKey
+{
+  const char *filename;
+  guint64 mtime;                  /* only for files not from a theme */
+  gint size;
+  gint scale;
+  guint force_size : 1;
+  guint symbolic : 1;
+  GtkCssIconEffect icon_effect;   /* only for non-symbolic icons */
+  GdkRGBA fg;                     /* only for symbolic icons */
+  GdkRGBA success_color;
+  GdkRGBA warning_color;
+  GdkRGBA error_color;
+};
+
+struct _GtkIconSurfaceCacheStats
+{
+  gsize size;
+  gsize budget;
+  guint n_surfaces;
+  guint64 hits;
+  guint64 misses;
+  guint64 evictions;
+};
+
+guint             gtk_icon_surface_key_hash         (gconstpointer             key);
+gboolean          gtk_icon_surface_key_equal        (gconstpointer             a,
+                                                     gconstpointer             b);
+
+cairo_surface_t * gtk_icon_surface_cache_lookup     (const GtkIconSurfaceKey  *key);
+gboolean          gtk_icon_surface_cache_insert     (const GtkIconSurfaceKey  *key,
+                                                     cairo_surface_t          *surface);
+void              gtk_icon_surface_cache_clear      (void);
+
+void              gtk_icon_surface_cache_set_budget (gsize                     budget);
+void              gtk_icon_surface_cache_get_stats  (GtkIconSurfaceCacheStats *stats);
+
+G_END_DECLS
+
+#endif /* __GTK_ICON_SURFACE_CACHE_PRIVATE_H__ */
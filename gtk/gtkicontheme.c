@@ -43,6 +43,7 @@
 #include "gtkdebug.h"
 #include "deprecated/gtkiconfactory.h"
 #include "gtkiconcache.h"
+#include "gtkiconsurfacecacheprivate.h"
 #include "gtkintl.h"
 #include "gtkmain.h"
 #include "deprecated/gtknumerableiconprivate.h"
@@ -160,6 +161,10 @@ typedef enum
 } IconSuffix;
 
 #define INFO_CACHE_LRU_SIZE 32
+
+/* How long changes in monitored theme directories are collected
+ * before the theme is reloaded once for all of them, in ms */
+#define DIR_CHANGED_DELAY 500
 #if 0
 #define DEBUG_CACHE(args) g_print args
 #else
@@ -188,14 +193,20 @@ struct _GtkIconThemePrivate
   GList *themes;
   GHashTable *unthemed_icons;
 
+  /* Maps icon names to the IconIndexMatches of the themes
+   * containing them; filled lazily
+   */
+  GHashTable *icon_index;
+
   /* GdkScreen for the icon theme (may be NULL) */
   GdkScreen *screen;
 
-  /* time when we last stat:ed for theme changes */
+  /* time when we last stat:ed the unmonitored directories for theme changes */
   glong last_stat_time;
   GList *dir_mtimes;
 
   gulong theme_changed_idle;
+  guint dir_changed_timeout;
 };
 
 typedef struct {
@@ -256,6 +267,7 @@ struct _GtkIconInfo
   guint emblems_applied : 1;
   guint is_svg          : 1;
   guint is_resource     : 1;
+  guint has_file_mtime  : 1;
 
   /* Cached information if we go ahead and try to load
    * the icon.
@@ -265,9 +277,15 @@ struct _GtkIconInfo
   GError *load_error;
   gdouble unscaled_scale;
   gdouble scale;
+  guint64 file_mtime;           /* in microseconds */
 
   SymbolicPixbufCache *symbolic_pixbuf_cache;
 
+  /* The symbolic SVG rendered once, in the format of .symbolic.png
+   * files, so that it can be recolored without rendering it again
+   */
+  GdkPixbuf *symbolic_mask;
+
   gint symbolic_width;
   gint symbolic_height;
 };
@@ -323,13 +341,21 @@ typedef struct
   time_t mtime;
   GtkIconCache *cache;
   gboolean exists;
+  GFileMonitor *monitor;
 } IconThemeDirMtime;
 
+typedef struct
+{
+  IconTheme *theme;
+  GList *dirs;  /* IconThemeDirs containing the icon, in search order */
+} IconIndexMatch;
+
 static void         gtk_icon_theme_finalize   (GObject          *object);
 static void         theme_dir_destroy         (IconThemeDir     *dir);
 static void         theme_destroy              (IconTheme       *theme);
 static GtkIconInfo *theme_lookup_icon         (IconTheme        *theme,
                                                const gchar      *icon_name,
+                                               GList            *dirs,
                                                gint              size,
                                                gint              scale,
                                                gboolean          allow_svg,
@@ -337,8 +363,6 @@ static GtkIconInfo *theme_lookup_icon         (IconTheme        *theme,
 static void         theme_list_icons          (IconTheme        *theme,
                                                GHashTable       *icons,
                                                GQuark            context);
-static gboolean     theme_has_icon            (IconTheme        *theme,
-                                               const gchar      *icon_name);
 static void         theme_list_contexts       (IconTheme        *theme,
                                                GHashTable       *contexts);
 static void         theme_subdir_load         (GtkIconTheme     *icon_theme,
@@ -347,7 +371,8 @@ static void         theme_subdir_load         (GtkIconTheme     *icon_theme,
                                                gchar            *subdir);
 static void         do_theme_change           (GtkIconTheme     *icon_theme);
 static void         blow_themes               (GtkIconTheme     *icon_themes);
-static gboolean     rescan_themes             (GtkIconTheme     *icon_themes);
+static gboolean     rescan_themes             (GtkIconTheme     *icon_themes,
+                                               gboolean          only_unmonitored);
 static IconSuffix   theme_dir_get_icon_suffix (IconThemeDir     *dir,
                                                const gchar      *icon_name,
                                                gboolean         *has_icon_file);
@@ -752,16 +777,166 @@ gtk_icon_theme_init (GtkIconTheme *icon_theme)
   priv->pixbuf_supports_svg = pixbuf_supports_svg ();
 }
 
+static gboolean
+dir_changed_timeout (gpointer user_data)
+{
+  GtkIconTheme *icon_theme = user_data;
+
+  icon_theme->priv->dir_changed_timeout = 0;
+  do_theme_change (icon_theme);
+
+  return FALSE;
+}
+
+static void
+dir_mtime_changed (GFileMonitor      *monitor,
+                   GFile             *file,
+                   GFile             *other_file,
+                   GFileMonitorEvent  event,
+                   gpointer           user_data)
+{
+  GtkIconTheme *icon_theme = user_data;
+  GtkIconThemePrivate *priv = icon_theme->priv;
+
+  /* The same changes that update the mtime of the directory */
+  if (event != G_FILE_MONITOR_EVENT_CREATED &&
+      event != G_FILE_MONITOR_EVENT_DELETED)
+    return;
+
+  /* Installing or removing icons creates or deletes many files at
+   * once; reload the theme once for all of them.
+   */
+  if (priv->dir_changed_timeout == 0)
+    {
+      priv->dir_changed_timeout = gdk_threads_add_timeout (DIR_CHANGED_DELAY,
+                                                           dir_changed_timeout,
+                                                           icon_theme);
+      g_source_set_name_by_id (priv->dir_changed_timeout, "[gtk+] dir_changed_timeout");
+    }
+}
+
+/* Theme directories are monitored for changes. Directories for
+ * which no monitor can be created are checked with stat() every
+ * few seconds instead.
+ */
+static void
+dir_mtime_monitor (GtkIconTheme      *icon_theme,
+                   IconThemeDirMtime *dir_mtime)
+{
+  GFile *file;
+
+  file = g_file_new_for_path (dir_mtime->dir);
+  dir_mtime->monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, NULL);
+  if (dir_mtime->monitor)
+    g_signal_connect (dir_mtime->monitor, "changed",
+                      G_CALLBACK (dir_mtime_changed), icon_theme);
+  g_object_unref (file);
+}
+
 static void
 free_dir_mtime (IconThemeDirMtime *dir_mtime)
 {
   if (dir_mtime->cache)
     _gtk_icon_cache_unref (dir_mtime->cache);
 
+  if (dir_mtime->monitor)
+    {
+      g_signal_handlers_disconnect_matched (dir_mtime->monitor, G_SIGNAL_MATCH_FUNC,
+                                            0, 0, NULL, dir_mtime_changed, NULL);
+      g_file_monitor_cancel (dir_mtime->monitor);
+      g_object_unref (dir_mtime->monitor);
+    }
+
   g_free (dir_mtime->dir);
   g_slice_free (IconThemeDirMtime, dir_mtime);
 }
 
+static void
+free_icon_index_matches (gpointer data)
+{
+  GSList *matches = data;
+  GSList *l;
+
+  for (l = matches; l; l = l->next)
+    {
+      IconIndexMatch *match = l->data;
+
+      g_list_free (match->dirs);
+      g_slice_free (IconIndexMatch, match);
+    }
+  g_slist_free (matches);
+}
+
+/* The icon index maps an icon name to the directories, in all themes,
+ * that contain the icon. Entries are added the first time a name is
+ * looked up, so that looking it up again, e.g. at another size, or
+ * looking up a fallback name that no theme has, does not probe every
+ * directory of every theme again.
+ *
+ * Returns the IconIndexMatches for @icon_name, in theme search order,
+ * or %NULL if no theme has it.
+ */
+static GSList *
+icon_index_get_matches (GtkIconTheme *icon_theme,
+                        const gchar  *icon_name)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+  GSList *matches;
+  GList *l, *d;
+
+  if (g_hash_table_lookup_extended (priv->icon_index, icon_name, NULL, (gpointer *) &matches))
+    return matches;
+
+  matches = NULL;
+  for (l = priv->themes; l; l = l->next)
+    {
+      IconTheme *theme = l->data;
+      GList *dirs = NULL;
+
+      for (d = theme->dirs; d; d = d->next)
+        {
+          IconThemeDir *dir = d->data;
+
+          if (theme_dir_get_icon_suffix (dir, icon_name, NULL) != ICON_SUFFIX_NONE)
+            dirs = g_list_prepend (dirs, dir);
+        }
+
+      if (dirs)
+        {
+          IconIndexMatch *match;
+
+          match = g_slice_new (IconIndexMatch);
+          match->theme = theme;
+          match->dirs = g_list_reverse (dirs);
+          matches = g_slist_prepend (matches, match);
+        }
+    }
+  matches = g_slist_reverse (matches);
+
+  g_hash_table_insert (priv->icon_index, g_strdup (icon_name), matches);
+
+  return matches;
+}
+
+/* Returns the directories of @theme that contain @icon_name */
+static GList *
+icon_index_get_dirs (GtkIconTheme *icon_theme,
+                     IconTheme    *theme,
+                     const gchar  *icon_name)
+{
+  GSList *l;
+
+  for (l = icon_index_get_matches (icon_theme, icon_name); l; l = l->next)
+    {
+      IconIndexMatch *match = l->data;
+
+      if (match->theme == theme)
+        return match->dirs;
+    }
+
+  return NULL;
+}
+
 static gboolean
 theme_changed_idle (gpointer user_data)
 {
@@ -800,7 +975,15 @@ do_theme_change (GtkIconTheme *icon_theme)
 {
   GtkIconThemePrivate *priv = icon_theme->priv;
 
+  /* This covers any changes to the directories too */
+  if (priv->dir_changed_timeout)
+    {
+      g_source_remove (priv->dir_changed_timeout);
+      priv->dir_changed_timeout = 0;
+    }
+
   g_hash_table_remove_all (priv->info_cache);
+  gtk_icon_surface_cache_clear ();
 
   if (!priv->themes_valid)
     return;
@@ -823,9 +1006,11 @@ blow_themes (GtkIconTheme *icon_theme)
       g_list_free_full (priv->themes, (GDestroyNotify) theme_destroy);
       g_list_free_full (priv->dir_mtimes, (GDestroyNotify) free_dir_mtime);
       g_hash_table_destroy (priv->unthemed_icons);
+      g_hash_table_destroy (priv->icon_index);
     }
   priv->themes = NULL;
   priv->unthemed_icons = NULL;
+  priv->icon_index = NULL;
   priv->dir_mtimes = NULL;
   priv->themes_valid = FALSE;
 }
@@ -846,6 +1031,9 @@ gtk_icon_theme_finalize (GObject *object)
   if (priv->theme_changed_idle)
     g_source_remove (priv->theme_changed_idle);
 
+  if (priv->dir_changed_timeout)
+    g_source_remove (priv->dir_changed_timeout);
+
   unset_screen (icon_theme);
 
   g_free (priv->current_theme);
@@ -1161,6 +1349,7 @@ insert_theme (GtkIconTheme *icon_theme,
         dir_mtime->mtime = 0;
         dir_mtime->exists = FALSE;
       }
+      dir_mtime_monitor (icon_theme, dir_mtime);
 
       priv->dir_mtimes = g_list_prepend (priv->dir_mtimes, dir_mtime);
     }
@@ -1383,6 +1572,8 @@ load_themes (GtkIconTheme *icon_theme)
 
   priv->unthemed_icons = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                 g_free, (GDestroyNotify)free_unthemed_icon);
+  priv->icon_index = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                            g_free, free_icon_index_matches);
 
   for (base = 0; base < icon_theme->priv->search_path_len; base++)
     {
@@ -1395,6 +1586,7 @@ load_themes (GtkIconTheme *icon_theme)
       dir_mtime->mtime = 0;
       dir_mtime->exists = FALSE;
       dir_mtime->cache = NULL;
+      dir_mtime_monitor (icon_theme, dir_mtime);
 
       if (g_stat (dir, &stat_buf) != 0 || !S_ISDIR (stat_buf.st_mode))
         continue;
@@ -1467,7 +1659,7 @@ ensure_valid_themes (GtkIconTheme *icon_theme)
       g_get_current_time (&tv);
 
       if (ABS (tv.tv_sec - priv->last_stat_time) > 5 &&
-          rescan_themes (icon_theme))
+          rescan_themes (icon_theme, TRUE))
         {
           g_hash_table_remove_all (priv->info_cache);
           blow_themes (icon_theme);
@@ -1740,7 +1932,9 @@ real_choose_icon (GtkIconTheme       *icon_theme,
       for (i = 0; icon_names[i] && icon_name_is_symbolic (icon_names[i]); i++)
         {
           icon_name = icon_names[i];
-          icon_info = theme_lookup_icon (theme, icon_name, size, scale, allow_svg, use_builtin);
+          icon_info = theme_lookup_icon (theme, icon_name,
+                                         icon_index_get_dirs (icon_theme, theme, icon_name),
+                                         size, scale, allow_svg, use_builtin);
           if (icon_info)
             goto out;
         }
@@ -1753,7 +1947,9 @@ real_choose_icon (GtkIconTheme       *icon_theme,
       for (i = 0; icon_names[i]; i++)
         {
           icon_name = icon_names[i];
-          icon_info = theme_lookup_icon (theme, icon_name, size, scale, allow_svg, use_builtin);
+          icon_info = theme_lookup_icon (theme, icon_name,
+                                         icon_index_get_dirs (icon_theme, theme, icon_name),
+                                         size, scale, allow_svg, use_builtin);
           if (icon_info)
             goto out;
         }
@@ -1833,7 +2029,9 @@ real_choose_icon (GtkIconTheme       *icon_theme,
       icon_info->unscaled_scale = 1.0;
       if (scale != 1 && !icon_info->forced_size && theme != NULL)
         {
-          unscaled_icon_info = theme_lookup_icon (theme, icon_name, size, 1, allow_svg, use_builtin);
+          unscaled_icon_info = theme_lookup_icon (theme, icon_name,
+                                                  icon_index_get_dirs (icon_theme, theme, icon_name),
+                                                  size, 1, allow_svg, use_builtin);
           if (unscaled_icon_info)
             {
               icon_info->unscaled_scale =
@@ -2448,11 +2646,8 @@ gtk_icon_theme_has_icon (GtkIconTheme *icon_theme,
         return TRUE;
     }
 
-  for (l = priv->themes; l; l = l->next)
-    {
-      if (theme_has_icon (l->data, icon_name))
-        return TRUE;
-    }
+  if (icon_index_get_matches (icon_theme, icon_name) != NULL)
+    return TRUE;
 
   if (icon_theme_builtin_icons &&
       g_hash_table_lookup_extended (icon_theme_builtin_icons,
@@ -2728,8 +2923,13 @@ gtk_icon_theme_get_example_icon_name (GtkIconTheme *icon_theme)
 }
 
 
+/* Directories with a file monitor are only checked if
+ * @only_unmonitored is %FALSE; changes to them are picked
+ * up by dir_mtime_changed().
+ */
 static gboolean
-rescan_themes (GtkIconTheme *icon_theme)
+rescan_themes (GtkIconTheme *icon_theme,
+               gboolean      only_unmonitored)
 {
   GtkIconThemePrivate *priv;
   IconThemeDirMtime *dir_mtime;
@@ -2744,6 +2944,9 @@ rescan_themes (GtkIconTheme *icon_theme)
     {
       dir_mtime = d->data;
 
+      if (only_unmonitored && dir_mtime->monitor != NULL)
+        continue;
+
       stat_res = g_stat (dir_mtime->dir, &stat_buf);
 
       /* dir mtime didn't change */
@@ -2785,7 +2988,7 @@ gtk_icon_theme_rescan_if_needed (GtkIconTheme *icon_theme)
 
   g_return_val_if_fail (GTK_IS_ICON_THEME (icon_theme), FALSE);
 
-  retval = rescan_themes (icon_theme);
+  retval = rescan_themes (icon_theme, FALSE);
   if (retval)
       do_theme_change (icon_theme);
 
@@ -3017,15 +3220,19 @@ compare_dir_matches (IconThemeDir *dir_a, gint difference_a,
   return diff_a <= diff_b;
 }
 
+/* @dirs are the directories of @theme that contain @icon_name,
+ * as returned by icon_index_get_dirs()
+ */
 static GtkIconInfo *
 theme_lookup_icon (IconTheme   *theme,
                    const gchar *icon_name,
+                   GList       *dirs,
                    gint         size,
                    gint         scale,
                    gboolean     allow_svg,
                    gboolean     use_builtin)
 {
-  GList *dirs, *l;
+  GList *l;
   IconThemeDir *dir, *min_dir;
   gchar *file;
   gint min_difference, difference;
@@ -3048,8 +3255,6 @@ theme_lookup_icon (IconTheme   *theme,
         return icon_info_new_builtin (closest_builtin);
     }
 
-  dirs = theme->dirs;
-
   l = dirs;
   while (l != NULL)
     {
@@ -3150,31 +3355,6 @@ theme_list_icons (IconTheme  *theme,
     }
 }
 
-static gboolean
-theme_has_icon (IconTheme   *theme,
-                const gchar *icon_name)
-{
-  GList *l;
-
-  for (l = theme->dirs; l; l = l->next)
-    {
-      IconThemeDir *dir = l->data;
-
-      if (dir->cache)
-        {
-          if (_gtk_icon_cache_has_icon (dir->cache, icon_name))
-            return TRUE;
-        }
-      else
-        {
-          if (g_hash_table_lookup (dir->icons, icon_name) != NULL)
-            return TRUE;
-        }
-    }
-
-  return FALSE;
-}
-
 static void
 theme_list_contexts (IconTheme  *theme, 
                      GHashTable *contexts)
@@ -3492,10 +3672,14 @@ icon_info_dup (GtkIconInfo *icon_info)
   dup->forced_size = icon_info->forced_size;
   dup->emblems_applied = icon_info->emblems_applied;
   dup->is_resource = icon_info->is_resource;
+  dup->has_file_mtime = icon_info->has_file_mtime;
+  dup->file_mtime = icon_info->file_mtime;
   dup->min_size = icon_info->min_size;
   dup->max_size = icon_info->max_size;
   dup->symbolic_width = icon_info->symbolic_width;
   dup->symbolic_height = icon_info->symbolic_height;
+  if (icon_info->symbolic_mask)
+    dup->symbolic_mask = g_object_ref (icon_info->symbolic_mask);
 
   return dup;
 }
@@ -3564,6 +3748,7 @@ gtk_icon_info_finalize (GObject *object)
   g_clear_object (&icon_info->pixbuf);
   g_clear_object (&icon_info->proxy_pixbuf);
   g_clear_object (&icon_info->cache_pixbuf);
+  g_clear_object (&icon_info->symbolic_mask);
   g_clear_error (&icon_info->load_error);
 
   symbolic_pixbuf_cache_free (icon_info->symbolic_pixbuf_cache);
@@ -3822,6 +4007,78 @@ icon_info_get_pixbuf_ready (GtkIconInfo *icon_info)
   return FALSE;
 }
 
+/* Whether loading @icon_info, as a symbolic icon or not, can be done
+ * without reading or decoding the icon file.
+ */
+gboolean
+gtk_icon_info_is_loaded (GtkIconInfo *icon_info)
+{
+  g_return_val_if_fail (GTK_IS_ICON_INFO (icon_info), FALSE);
+
+  return icon_info_get_pixbuf_ready (icon_info) || icon_info->symbolic_mask != NULL;
+}
+
+/* Whether @icon_info draws emblems over its icon. Such infos have
+ * the filename of their base icon, but not its pixels.
+ */
+gboolean
+gtk_icon_info_has_emblems (GtkIconInfo *icon_info)
+{
+  g_return_val_if_fail (GTK_IS_ICON_INFO (icon_info), FALSE);
+
+  return icon_info->emblem_infos != NULL;
+}
+
+/* Returns the modification time, in microseconds, that the file of
+ * @icon_info had when it was loaded, or 0 if it was found by name in
+ * an icon theme or is not loaded yet. Theme directories are monitored,
+ * but files passed in with a GFileIcon can be rewritten under the same
+ * name at any time, e.g. thumbnails.
+ *
+ * This does no I/O; the time is queried together with the loading,
+ * which happens in a thread for asynchronous loads.
+ */
+guint64
+gtk_icon_info_get_file_mtime (GtkIconInfo *icon_info)
+{
+  g_return_val_if_fail (GTK_IS_ICON_INFO (icon_info), 0);
+
+  return icon_info->file_mtime;
+}
+
+/* Queried before the file is read, so that a file rewritten while it
+ * is loaded looks changed afterwards rather than the other way round.
+ */
+static void
+icon_info_ensure_file_mtime (GtkIconInfo *icon_info)
+{
+  GFileInfo *info;
+
+  if (icon_info->has_file_mtime)
+    return;
+
+  icon_info->has_file_mtime = TRUE;
+
+  if (icon_info->key.icon_names != NULL ||
+      icon_info->icon_file == NULL ||
+      icon_info->is_resource)
+    return;
+
+  info = g_file_query_info (icon_info->icon_file,
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL, NULL);
+  if (info == NULL)
+    return;
+
+  icon_info->file_mtime =
+    g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+    g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+
+  g_object_unref (info);
+}
+
 /* This function contains the complicated logic for deciding
  * on the size at which to load the icon and loading it at
  * that size.
@@ -3843,6 +4100,8 @@ icon_info_ensure_scale_and_pixbuf (GtkIconInfo *icon_info)
   if (icon_info->load_error)
     return FALSE;
 
+  icon_info_ensure_file_mtime (icon_info);
+
   if (icon_info->icon_file && !icon_info->loadable)
     icon_info->loadable = G_LOADABLE_ICON (g_file_icon_new (icon_info->icon_file));
 
@@ -4247,6 +4506,8 @@ gtk_icon_info_load_icon_finish (GtkIconInfo   *icon_info,
       /* If not, copy results from dup back to icon_info */
       icon_info->emblems_applied = dup->emblems_applied;
       icon_info->scale = dup->scale;
+      icon_info->has_file_mtime = dup->has_file_mtime;
+      icon_info->file_mtime = dup->file_mtime;
       g_clear_object (&icon_info->pixbuf);
       if (dup->pixbuf)
         icon_info->pixbuf = g_object_ref (dup->pixbuf);
@@ -4311,17 +4572,6 @@ symbolic_cache_get_proxy (SymbolicPixbufCache *symbolic_cache,
   return symbolic_cache->proxy_pixbuf;
 }
 
-static gchar *
-rgba_to_string_noalpha (const GdkRGBA *rgba)
-{
-  GdkRGBA color;
-
-  color = *rgba;
-  color.alpha = 1.0;
-
-  return gdk_rgba_to_string (&color);
-}
-
 static void
 rgba_to_pixel(const GdkRGBA  *rgba,
 	      guint8 pixel[4])
@@ -4416,6 +4666,11 @@ gtk_icon_theme_color_symbolic_pixbuf (GdkPixbuf     *symbolic,
   return colored;
 }
 
+static const GdkRGBA fg_default = { 0.7450980392156863, 0.7450980392156863, 0.7450980392156863, 1.0};
+static const GdkRGBA success_default = { 0.3046921492332342,0.6015716792553597, 0.023437857633325704, 1.0};
+static const GdkRGBA warning_default = {0.9570458533607996, 0.47266346227206835, 0.2421911955443656, 1.0 };
+static const GdkRGBA error_default = { 0.796887159533074, 0 ,0, 1.0 };
+
 static GdkPixbuf *
 gtk_icon_info_load_symbolic_png (GtkIconInfo    *icon_info,
                                  const GdkRGBA  *fg,
@@ -4424,11 +4679,6 @@ gtk_icon_info_load_symbolic_png (GtkIconInfo    *icon_info,
                                  const GdkRGBA  *error_color,
                                  GError        **error)
 {
-  GdkRGBA fg_default = { 0.7450980392156863, 0.7450980392156863, 0.7450980392156863, 1.0};
-  GdkRGBA success_default = { 0.3046921492332342,0.6015716792553597, 0.023437857633325704, 1.0};
-  GdkRGBA warning_default = {0.9570458533607996, 0.47266346227206835, 0.2421911955443656, 1.0 };
-  GdkRGBA error_default = { 0.796887159533074, 0 ,0, 1.0 };
-
   if (!icon_info_ensure_scale_and_pixbuf (icon_info))
     {
       if (icon_info->load_error)
@@ -4454,55 +4704,35 @@ gtk_icon_info_load_symbolic_png (GtkIconInfo    *icon_info,
                                                error_color ? error_color : &error_default);
 }
 
+/* Renders the symbolic SVG into a mask in the format that
+ * gtk-encode-symbolic-svg produces for .symbolic.png files: the
+ * alpha channel is the icon's alpha, and the red, green and blue
+ * channels hold the fraction of the success, warning and error
+ * colors. The foreground color is the rest. Rendering the foreground
+ * as black and the other colors as pure red, green and blue gives
+ * exactly that in a single pass.
+ */
 static GdkPixbuf *
-gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
-                                 const GdkRGBA  *fg,
-                                 const GdkRGBA  *success_color,
-                                 const GdkRGBA  *warning_color,
-                                 const GdkRGBA  *error_color,
-                                 GError        **error)
+gtk_icon_info_render_symbolic_mask (GtkIconInfo  *icon_info,
+                                    GError      **error)
 {
   GInputStream *stream;
   GdkPixbuf *pixbuf;
-  gchar *css_fg;
-  gchar *css_success;
-  gchar *css_warning;
-  gchar *css_error;
   gchar *data;
   gchar *width;
   gchar *height;
   gchar *file_data, *escaped_file_data;
   gsize file_len;
   gint symbolic_size;
-  double alpha;
-  gchar alphastr[G_ASCII_DTOSTR_BUF_SIZE];
-
-  alpha = fg->alpha;
-
-  css_fg = rgba_to_string_noalpha (fg);
 
-  css_success = css_warning = css_error = NULL;
-
-  if (warning_color)
-    css_warning = rgba_to_string_noalpha (warning_color);
-  else
-    css_warning = g_strdup ("rgb(245,121,62)");
-
-  if (error_color)
-    css_error = rgba_to_string_noalpha (error_color);
-  else
-    css_error = g_strdup ("rgb(204,0,0)");
-
-  if (success_color)
-    css_success = rgba_to_string_noalpha (success_color);
-  else
-    css_success = g_strdup ("rgb(78,154,6)");
+  icon_info_ensure_file_mtime (icon_info);
 
   if (!g_file_load_contents (icon_info->icon_file, NULL, &file_data, &file_len, NULL, error))
     return NULL;
 
   if (!icon_info_ensure_scale_and_pixbuf (icon_info))
     {
+      g_free (file_data);
       g_propagate_error (error, icon_info->load_error);
       icon_info->load_error = NULL;
       return NULL;
@@ -4517,7 +4747,10 @@ gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
       g_object_unref (stream);
 
       if (!pixbuf)
-        return NULL;
+        {
+          g_free (file_data);
+          return NULL;
+        }
 
       icon_info->symbolic_width = gdk_pixbuf_get_width (pixbuf);
       icon_info->symbolic_height = gdk_pixbuf_get_height (pixbuf);
@@ -4543,8 +4776,6 @@ gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
   escaped_file_data = g_markup_escape_text (file_data, file_len);
   g_free (file_data);
 
-  g_ascii_dtostr (alphastr, G_ASCII_DTOSTR_BUF_SIZE, CLAMP (alpha, 0, 1));
-
   data = g_strconcat ("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
                       "<svg version=\"1.1\"\n"
                       "     xmlns=\"http://www.w3.org/2000/svg\"\n"
@@ -4553,26 +4784,22 @@ gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
                       "     height=\"", height, "\">\n"
                       "  <style type=\"text/css\">\n"
                       "    rect,path {\n"
-                      "      fill: ", css_fg," !important;\n"
+                      "      fill: rgb(0,0,0) !important;\n"
                       "    }\n"
                       "    .warning {\n"
-                      "      fill: ", css_warning, " !important;\n"
+                      "      fill: rgb(0,255,0) !important;\n"
                       "    }\n"
                       "    .error {\n"
-                      "      fill: ", css_error ," !important;\n"
+                      "      fill: rgb(0,0,255) !important;\n"
                       "    }\n"
                       "    .success {\n"
-                      "      fill: ", css_success, " !important;\n"
+                      "      fill: rgb(255,0,0) !important;\n"
                       "    }\n"
                       "  </style>\n"
-                      "  <g opacity=\"", alphastr, "\" ><xi:include href=\"data:text/xml,", escaped_file_data, "\"/></g>\n"
+                      "  <xi:include href=\"data:text/xml,", escaped_file_data, "\"/>\n"
                       "</svg>",
                       NULL);
   g_free (escaped_file_data);
-  g_free (css_fg);
-  g_free (css_warning);
-  g_free (css_error);
-  g_free (css_success);
   g_free (width);
   g_free (height);
 
@@ -4588,6 +4815,28 @@ gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
   return pixbuf;
 }
 
+static GdkPixbuf *
+gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
+                                 const GdkRGBA  *fg,
+                                 const GdkRGBA  *success_color,
+                                 const GdkRGBA  *warning_color,
+                                 const GdkRGBA  *error_color,
+                                 GError        **error)
+{
+  if (icon_info->symbolic_mask == NULL)
+    {
+      icon_info->symbolic_mask = gtk_icon_info_render_symbolic_mask (icon_info, error);
+      if (icon_info->symbolic_mask == NULL)
+        return NULL;
+    }
+
+  return gtk_icon_theme_color_symbolic_pixbuf (icon_info->symbolic_mask,
+                                               fg,
+                                               success_color ? success_color : &success_default,
+                                               warning_color ? warning_color : &warning_default,
+                                               error_color ? error_color : &error_default);
+}
+
 
 static GdkPixbuf *
 gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
@@ -5023,6 +5272,25 @@ gtk_icon_info_load_symbolic_finish (GtkIconInfo   *icon_info,
 
       g_object_unref (pixbuf);
 
+      if (!icon_info->has_file_mtime)
+        {
+          icon_info->has_file_mtime = data->dup->has_file_mtime;
+          icon_info->file_mtime = data->dup->file_mtime;
+        }
+
+      /* Keep what was loaded, so that other colors don't load it again */
+      if (icon_info->symbolic_mask == NULL && data->dup->symbolic_mask != NULL)
+        icon_info->symbolic_mask = g_object_ref (data->dup->symbolic_mask);
+
+      if (!icon_info_get_pixbuf_ready (icon_info) && data->dup->pixbuf != NULL &&
+          icon_info_get_pixbuf_ready (data->dup))
+        {
+          icon_info->emblems_applied = data->dup->emblems_applied;
+          icon_info->scale = data->dup->scale;
+          g_clear_object (&icon_info->pixbuf);
+          icon_info->pixbuf = g_object_ref (data->dup->pixbuf);
+        }
+
       return symbolic_cache_get_proxy (symbolic_cache, icon_info);
     }
 
@@ -31,6 +31,10 @@ GtkIconInfo *gtk_icon_info_new_for_file (GFile *file,
                                          gint   size,
                                          gint   scale);
 
+gboolean    gtk_icon_info_is_loaded (GtkIconInfo *icon_info);
+gboolean    gtk_icon_info_has_emblems (GtkIconInfo *icon_info);
+guint64     gtk_icon_info_get_file_mtime (GtkIconInfo *icon_info);
+
 GdkPixbuf * gtk_icon_theme_color_symbolic_pixbuf (GdkPixbuf     *symbolic,
                                                   const GdkRGBA *fg_color,
                                                   const GdkRGBA *success_color,
@@ -45,6 +45,7 @@
 #include "gtktypebuiltins.h"
 #include "gtkprivate.h"
 #include "gtkcssnodeprivate.h"
+#include "gtkdebug.h"
 #include "gtkwidgetprivate.h"
 #include "gtkstylecontextprivate.h"
 #include "a11y/gtkiconviewaccessibleprivate.h"
@@ -130,6 +131,7 @@ enum
 /* GObject vfuncs */
 static void             gtk_icon_view_cell_layout_init          (GtkCellLayoutIface *iface);
 static void             gtk_icon_view_dispose                   (GObject            *object);
+static void             gtk_icon_view_finalize                  (GObject            *object);
 static void             gtk_icon_view_constructed               (GObject            *object);
 static void             gtk_icon_view_set_property              (GObject            *object,
 								 guint               prop_id,
@@ -143,6 +145,7 @@ static void             gtk_icon_view_get_property              (GObject
 static void             gtk_icon_view_destroy                   (GtkWidget          *widget);
 static void             gtk_icon_view_realize                   (GtkWidget          *widget);
 static void             gtk_icon_view_unrealize                 (GtkWidget          *widget);
+static void             gtk_icon_view_style_updated             (GtkWidget          *widget);
 static GtkSizeRequestMode gtk_icon_view_get_request_mode        (GtkWidget          *widget);
 static void             gtk_icon_view_get_preferred_width       (GtkWidget          *widget,
 								 gint               *minimum,
@@ -231,6 +234,13 @@ static gboolean             gtk_icon_view_unselect_all_internal          (GtkIco
 static void                 gtk_icon_view_update_rubberband              (gpointer                data);
 static void                 gtk_icon_view_item_invalidate_size           (GtkIconViewItem        *item);
 static void                 gtk_icon_view_invalidate_sizes               (GtkIconView            *icon_view);
+static void                 gtk_icon_view_invalidate_layout              (GtkIconView            *icon_view);
+static void                 gtk_icon_view_validate_visible_rows          (GtkIconView            *icon_view);
+static GtkIconViewItem *    gtk_icon_view_get_nth_item                   (GtkIconView            *icon_view,
+                                                                          gint                    index);
+static gboolean             gtk_icon_view_layout_is_current              (GtkIconView            *icon_view);
+static gint                 gtk_icon_view_row_at_y                       (GtkIconView            *icon_view,
+                                                                          gint                    y);
 static void                 gtk_icon_view_add_move_binding               (GtkBindingSet          *binding_set,
 									  guint                   keyval,
 									  guint                   modmask,
@@ -354,12 +364,14 @@ gtk_icon_view_class_init (GtkIconViewClass *klass)
 
   gobject_class->constructed = gtk_icon_view_constructed;
   gobject_class->dispose = gtk_icon_view_dispose;
+  gobject_class->finalize = gtk_icon_view_finalize;
   gobject_class->set_property = gtk_icon_view_set_property;
   gobject_class->get_property = gtk_icon_view_get_property;
 
   widget_class->destroy = gtk_icon_view_destroy;
   widget_class->realize = gtk_icon_view_realize;
   widget_class->unrealize = gtk_icon_view_unrealize;
+  widget_class->style_updated = gtk_icon_view_style_updated;
   widget_class->get_request_mode = gtk_icon_view_get_request_mode;
   widget_class->get_preferred_width = gtk_icon_view_get_preferred_width;
   widget_class->get_preferred_height = gtk_icon_view_get_preferred_height;
@@ -1013,6 +1025,8 @@ gtk_icon_view_init (GtkIconView *icon_view)
 
   icon_view->priv->row_contexts = 
     g_ptr_array_new_with_free_func ((GDestroyNotify)g_object_unref);
+  icon_view->priv->items = g_ptr_array_new ();
+  icon_view->priv->rows = g_array_new (FALSE, TRUE, sizeof (GtkIconViewRow));
 
   gtk_style_context_add_class (gtk_widget_get_style_context (GTK_WIDGET (icon_view)),
                                GTK_STYLE_CLASS_VIEW);
@@ -1041,6 +1055,9 @@ gtk_icon_view_dispose (GObject *object)
 
   if (priv->cell_area_context)
     {
+      g_signal_handler_disconnect (priv->cell_area_context, priv->context_changed_id);
+      priv->context_changed_id = 0;
+
       g_object_unref (priv->cell_area_context);
       priv->cell_area_context = NULL;
     }
@@ -1067,6 +1084,17 @@ gtk_icon_view_dispose (GObject *object)
   G_OBJECT_CLASS (gtk_icon_view_parent_class)->dispose (object);
 }
 
+static void
+gtk_icon_view_finalize (GObject *object)
+{
+  GtkIconViewPrivate *priv = GTK_ICON_VIEW (object)->priv;
+
+  g_ptr_array_unref (priv->items);
+  g_array_unref (priv->rows);
+
+  G_OBJECT_CLASS (gtk_icon_view_parent_class)->finalize (object);
+}
+
 static void
 gtk_icon_view_set_property (GObject      *object,
 			    guint         prop_id,
@@ -1361,15 +1389,19 @@ gtk_icon_view_unrealize (GtkWidget *widget)
   GTK_WIDGET_CLASS (gtk_icon_view_parent_class)->unrealize (widget);
 }
 
-static gint
-gtk_icon_view_get_n_items (GtkIconView *icon_view)
+static void
+gtk_icon_view_style_updated (GtkWidget *widget)
 {
-  GtkIconViewPrivate *priv = icon_view->priv;
+  GTK_WIDGET_CLASS (gtk_icon_view_parent_class)->style_updated (widget);
 
-  if (priv->model == NULL)
-    return 0;
+  /* fonts and paddings of the cells may have changed */
+  gtk_icon_view_invalidate_layout (GTK_ICON_VIEW (widget));
+}
 
-  return gtk_tree_model_iter_n_children (priv->model, NULL);
+static gint
+gtk_icon_view_get_n_items (GtkIconView *icon_view)
+{
+  return icon_view->priv->items->len;
 }
 
 static void
@@ -1379,7 +1411,7 @@ adjust_wrap_width (GtkIconView *icon_view)
     {
       gint pixbuf_width, wrap_width;
 
-      if (icon_view->priv->items && icon_view->priv->pixbuf_cell)
+      if (icon_view->priv->items->len > 0 && icon_view->priv->pixbuf_cell)
         {
           gtk_cell_renderer_get_preferred_width (icon_view->priv->pixbuf_cell,
                                                  GTK_WIDGET (icon_view),
@@ -1408,7 +1440,7 @@ adjust_wrap_width (GtkIconView *icon_view)
           wrap_width = MAX (pixbuf_width * 2, 50);
         }
 
-      if (icon_view->priv->items && icon_view->priv->pixbuf_cell)
+      if (icon_view->priv->items->len > 0 && icon_view->priv->pixbuf_cell)
 	{
           /* Here we go with the same old guess, try the icon size and set double
            * the size of the first icon found in the list, naive but works much
@@ -1488,22 +1520,64 @@ cell_area_get_preferred_size (GtkIconView        *icon_view,
 static gboolean
 gtk_icon_view_is_empty (GtkIconView *icon_view)
 {
-  return icon_view->priv->items == NULL;
+  return icon_view->priv->items->len == 0;
 }
 
+/* Properties set on a cell outside of the cell data change the size of
+ * every item, which the cached item sizes know nothing about.
+ */
 static void
-gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
-                                       GtkOrientation  orientation,
-                                       gint            for_size,
-                                       gint           *minimum,
-                                       gint           *natural)
+gtk_icon_view_cell_changed (GObject    *cell,
+                            GParamSpec *pspec,
+                            gpointer    data)
+{
+  GtkIconView *icon_view = GTK_ICON_VIEW (data);
+
+  if (icon_view->priv->setting_cell_data)
+    return;
+
+  gtk_icon_view_invalidate_sizes (icon_view);
+}
+
+/* The cached item sizes are only as good as the cells they were
+ * measured with, so follow every cell that has been measured.
+ */
+static void
+gtk_icon_view_watch_cells (GtkIconView *icon_view)
+{
+  GList *cells, *l;
+
+  cells = gtk_cell_layout_get_cells (GTK_CELL_LAYOUT (icon_view->priv->cell_area));
+
+  for (l = cells; l; l = l->next)
+    {
+      if (g_signal_handler_find (l->data,
+                                 G_SIGNAL_MATCH_FUNC | G_SIGNAL_MATCH_DATA,
+                                 0, 0, NULL,
+                                 gtk_icon_view_cell_changed, icon_view) == 0)
+        g_signal_connect_object (l->data, "notify",
+                                 G_CALLBACK (gtk_icon_view_cell_changed),
+                                 icon_view, 0);
+    }
+
+  g_list_free (cells);
+}
+
+static void
+gtk_icon_view_measure_item_size (GtkIconView    *icon_view,
+                                 GtkOrientation  orientation,
+                                 gint            for_size,
+                                 gint           *minimum,
+                                 gint           *natural)
 {
   GtkIconViewPrivate *priv = icon_view->priv;
   GtkCellAreaContext *context;
-  GList *items;
+  guint i;
 
   g_assert (!gtk_icon_view_is_empty (icon_view));
 
+  gtk_icon_view_watch_cells (icon_view);
+
   context = gtk_cell_area_create_context (priv->cell_area);
 
   for_size -= 2 * priv->item_padding;
@@ -1511,21 +1585,21 @@ gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
   if (for_size > 0)
     {
       /* This is necessary for the context to work properly */
-      for (items = priv->items; items; items = items->next)
+      for (i = 0; i < priv->items->len; i++)
         {
-          GtkIconViewItem *item = items->data;
+          GtkIconViewItem *item = g_ptr_array_index (priv->items, i);
 
           _gtk_icon_view_set_cell_data (icon_view, item);
           cell_area_get_preferred_size (icon_view, context, 1 - orientation, -1, NULL, NULL);
         }
     }
 
-  for (items = priv->items; items; items = items->next)
+  for (i = 0; i < priv->items->len; i++)
     {
-      GtkIconViewItem *item = items->data;
+      GtkIconViewItem *item = g_ptr_array_index (priv->items, i);
 
       _gtk_icon_view_set_cell_data (icon_view, item);
-      if (items == priv->items)
+      if (i == 0)
         adjust_wrap_width (icon_view);
       cell_area_get_preferred_size (icon_view, context, orientation, for_size, NULL, NULL);
     }
@@ -1567,6 +1641,49 @@ gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
   g_object_unref (context);
 }
 
+/* Measuring the item size means measuring every item, so keep
+ * the last few results until the item sizes get invalidated.
+ */
+static void
+gtk_icon_view_get_preferred_item_size (GtkIconView    *icon_view,
+                                       GtkOrientation  orientation,
+                                       gint            for_size,
+                                       gint           *minimum,
+                                       gint           *natural)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  GtkIconViewItemSize *size;
+  guint i;
+
+  for (i = 0; i < priv->n_item_sizes; i++)
+    {
+      size = &priv->item_sizes[i];
+
+      if (size->orientation == orientation && size->for_size == for_size)
+        {
+          if (minimum)
+            *minimum = size->minimum;
+          if (natural)
+            *natural = size->natural;
+          return;
+        }
+    }
+
+  size = &priv->item_sizes[priv->next_item_size];
+  size->orientation = orientation;
+  size->for_size = for_size;
+  gtk_icon_view_measure_item_size (icon_view, orientation, for_size,
+                                   &size->minimum, &size->natural);
+
+  priv->next_item_size = (priv->next_item_size + 1) % GTK_ICON_VIEW_ITEM_SIZE_CACHE;
+  priv->n_item_sizes = MIN (priv->n_item_sizes + 1, GTK_ICON_VIEW_ITEM_SIZE_CACHE);
+
+  if (minimum)
+    *minimum = size->minimum;
+  if (natural)
+    *natural = size->natural;
+}
+
 static void
 gtk_icon_view_compute_n_items_for_size (GtkIconView    *icon_view,
                                         GtkOrientation  orientation,
@@ -1847,12 +1964,14 @@ gtk_icon_view_draw (GtkWidget *widget,
                     cairo_t   *cr)
 {
   GtkIconView *icon_view;
-  GList *icons;
   GtkTreePath *path;
   gint dest_index;
   GtkIconViewDropPosition dest_pos;
   GtkIconViewItem *dest_item = NULL;
   GtkStyleContext *context;
+  GdkRectangle clip;
+  gboolean windowed;
+  gint i, first;
 
   icon_view = GTK_ICON_VIEW (widget);
 
@@ -1881,11 +2000,22 @@ gtk_icon_view_draw (GtkWidget *widget,
   else
     dest_index = -1;
 
-  for (icons = icon_view->priv->items; icons; icons = icons->next)
+  /* With a current layout, only walk the rows that intersect the clip */
+  first = 0;
+  windowed = gdk_cairo_get_clip_rectangle (cr, &clip) &&
+             gtk_icon_view_layout_is_current (icon_view);
+  if (windowed)
+    first = MAX (gtk_icon_view_row_at_y (icon_view, clip.y) - 1, 0) * icon_view->priv->n_columns;
+
+  for (i = first; i < icon_view->priv->items->len; i++)
     {
-      GtkIconViewItem *item = icons->data;
+      GtkIconViewItem *item = g_ptr_array_index (icon_view->priv->items, i);
       GdkRectangle paint_area;
 
+      if (windowed &&
+          item->cell_area.y - icon_view->priv->item_padding > clip.y + clip.height)
+        break;
+
       paint_area.x      = item->cell_area.x      - icon_view->priv->item_padding;
       paint_area.y      = item->cell_area.y      - icon_view->priv->item_padding;
       paint_area.width  = item->cell_area.width  + icon_view->priv->item_padding * 2;
@@ -2215,8 +2345,8 @@ gtk_icon_view_set_cursor (GtkIconView     *icon_view,
     gtk_cell_area_stop_editing (icon_view->priv->cell_area, TRUE);
 
   if (gtk_tree_path_get_depth (path) == 1)
-    item = g_list_nth_data (icon_view->priv->items,
-			    gtk_tree_path_get_indices(path)[0]);
+    item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices (path)[0]);
   
   if (!item)
     return;
@@ -2564,15 +2694,15 @@ gtk_icon_view_start_rubberbanding (GtkIconView  *icon_view,
 				   gint          y)
 {
   GtkIconViewPrivate *priv = icon_view->priv;
-  GList *items;
+  guint i;
   GtkCssNode *widget_node;
 
   if (priv->rubberband_device)
     return;
 
-  for (items = priv->items; items; items = items->next)
+  for (i = 0; i < priv->items->len; i++)
     {
-      GtkIconViewItem *item = items->data;
+      GtkIconViewItem *item = g_ptr_array_index (priv->items, i);
 
       item->selected_before_rubberbanding = item->selected;
     }
@@ -2612,7 +2742,7 @@ gtk_icon_view_stop_rubberbanding (GtkIconView *icon_view)
 static void
 gtk_icon_view_update_rubberband_selection (GtkIconView *icon_view)
 {
-  GList *items;
+  guint i;
   gint x, y, width, height;
   gboolean dirty = FALSE;
   
@@ -2625,9 +2755,9 @@ gtk_icon_view_update_rubberband_selection (GtkIconView *icon_view)
   height = ABS (icon_view->priv->rubberband_y1 - 
 		icon_view->priv->rubberband_y2);
   
-  for (items = icon_view->priv->items; items; items = items->next)
+  for (i = 0; i < icon_view->priv->items->len; i++)
     {
-      GtkIconViewItem *item = items->data;
+      GtkIconViewItem *item = g_ptr_array_index (icon_view->priv->items, i);
       gboolean is_in;
       gboolean selected;
       
@@ -2700,14 +2830,14 @@ static gboolean
 gtk_icon_view_unselect_all_internal (GtkIconView  *icon_view)
 {
   gboolean dirty = FALSE;
-  GList *items;
+  guint i;
 
   if (icon_view->priv->selection_mode == GTK_SELECTION_NONE)
     return FALSE;
 
-  for (items = icon_view->priv->items; items; items = items->next)
+  for (i = 0; i < icon_view->priv->items->len; i++)
     {
-      GtkIconViewItem *item = items->data;
+      GtkIconViewItem *item = g_ptr_array_index (icon_view->priv->items, i);
 
       if (item->selected)
 	{
@@ -2925,6 +3055,9 @@ gtk_icon_view_adjustment_changed (GtkAdjustment *adjustment,
 {
   GtkIconViewPrivate *priv = icon_view->priv;
 
+  if (adjustment == priv->vadjustment)
+    gtk_icon_view_validate_visible_rows (icon_view);
+
   if (gtk_widget_get_realized (GTK_WIDGET (icon_view)))
     {
       gdk_window_move (priv->bin_window,
@@ -2947,17 +3080,291 @@ compare_sizes (gconstpointer p1,
        - GPOINTER_TO_INT (((const GtkRequestedSize *) p2)->data);
 }
 
+/* Above this number of rows, only the rows around the visible area
+ * get measured during layout; the others are given an estimated height
+ * and are measured when they get scrolled into view.
+ */
+#define GTK_ICON_VIEW_VIRTUAL_ROWS 256
+
+static GtkIconViewItem *
+gtk_icon_view_get_nth_item (GtkIconView *icon_view,
+                            gint         index)
+{
+  GPtrArray *items = icon_view->priv->items;
+
+  if (index < 0 || index >= items->len)
+    return NULL;
+
+  return g_ptr_array_index (items, index);
+}
+
+static gint
+gtk_icon_view_get_n_rows (GtkIconView *icon_view)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+
+  if (priv->n_columns <= 0)
+    return 0;
+
+  return (priv->items->len + priv->n_columns - 1) / priv->n_columns;
+}
+
+/* Whether the row table matches the items, so that rows can be
+ * used to find items by position.
+ */
+static gboolean
+gtk_icon_view_layout_is_current (GtkIconView *icon_view)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+
+  return priv->rows->len > 0 &&
+         priv->rows->len == gtk_icon_view_get_n_rows (icon_view);
+}
+
+static gint
+gtk_icon_view_row_at_y (GtkIconView *icon_view,
+                        gint         y)
+{
+  GArray *rows = icon_view->priv->rows;
+  guint lo, hi;
+
+  lo = 0;
+  hi = rows->len;
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (g_array_index (rows, GtkIconViewRow, mid).y <= y)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo > 0 ? lo - 1 : 0;
+}
+
+/* Measures the items of @row with a fresh copy of the base context,
+ * which becomes the row context. Returns the minimum height.
+ */
+static gint
+gtk_icon_view_measure_row (GtkIconView *icon_view,
+                           gint         row,
+                           gint        *natural)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  GtkWidget *widget = GTK_WIDGET (icon_view);
+  GtkCellAreaContext *context;
+  gint i, first, last;
+  gint minimum;
+
+  context = gtk_cell_area_copy_context (priv->cell_area, priv->cell_area_context);
+  if (g_ptr_array_index (priv->row_contexts, row))
+    g_object_unref (g_ptr_array_index (priv->row_contexts, row));
+  g_ptr_array_index (priv->row_contexts, row) = context;
+
+  first = row * priv->n_columns;
+  last = MIN (first + priv->n_columns, priv->items->len);
+
+  for (i = first; i < last; i++)
+    {
+      _gtk_icon_view_set_cell_data (icon_view, g_ptr_array_index (priv->items, i));
+      gtk_cell_area_get_preferred_height_for_width (priv->cell_area,
+                                                    context,
+                                                    widget,
+                                                    priv->layout_item_width,
+                                                    NULL, NULL);
+    }
+
+  gtk_cell_area_context_get_preferred_height_for_width (context,
+                                                        priv->layout_item_width,
+                                                        &minimum, natural);
+
+  return minimum;
+}
+
+/* Recomputes the position of all rows starting at @first_row and
+ * moves their items along.
+ */
+static void
+gtk_icon_view_position_rows (GtkIconView *icon_view,
+                             gint         first_row)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  GtkIconViewRow *row = NULL;
+  gint r, i, y;
+
+  if (first_row == 0)
+    y = priv->margin + priv->item_padding;
+  else
+    {
+      row = &g_array_index (priv->rows, GtkIconViewRow, first_row - 1);
+      y = row->y + row->height + 2 * priv->item_padding + priv->row_spacing;
+    }
+
+  for (r = first_row; r < priv->rows->len; r++)
+    {
+      row = &g_array_index (priv->rows, GtkIconViewRow, r);
+      row->y = y;
+
+      for (i = r * priv->n_columns; i < MIN ((r + 1) * priv->n_columns, priv->items->len); i++)
+        {
+          GtkIconViewItem *item = g_ptr_array_index (priv->items, i);
+
+          item->cell_area.y = row->y;
+          item->cell_area.height = row->height;
+        }
+
+      y += row->height + 2 * priv->item_padding + priv->row_spacing;
+    }
+
+  if (row)
+    priv->height = row->y + row->height + priv->item_padding + priv->margin;
+  else
+    priv->height = 2 * priv->margin;
+}
+
+/* Measures the rows between @first and @last that only have an
+ * estimated height. Returns the first row whose height changed,
+ * or -1.
+ */
+static gint
+gtk_icon_view_measure_rows (GtkIconView *icon_view,
+                            gint         first,
+                            gint         last)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  gint r, changed = -1;
+
+  last = MIN (last, (gint) priv->rows->len - 1);
+
+  for (r = MAX (first, 0); r <= last; r++)
+    {
+      GtkIconViewRow *row = &g_array_index (priv->rows, GtkIconViewRow, r);
+      gint height;
+
+      if (row->measured)
+        continue;
+
+      height = gtk_icon_view_measure_row (icon_view, r, NULL);
+      gtk_cell_area_context_allocate (g_ptr_array_index (priv->row_contexts, r),
+                                      priv->layout_item_width, height);
+      row->measured = TRUE;
+
+      if (height != row->height)
+        {
+          row->height = height;
+          if (changed < 0)
+            changed = r;
+        }
+    }
+
+  return changed;
+}
+
+static void
+gtk_icon_view_estimate_rows (GtkIconView *icon_view)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  gint r, n_measured = 0, total = 0, estimate;
+
+  for (r = 0; r < priv->rows->len; r++)
+    {
+      GtkIconViewRow *row = &g_array_index (priv->rows, GtkIconViewRow, r);
+
+      if (row->measured)
+        {
+          total += row->height;
+          n_measured++;
+        }
+    }
+
+  if (n_measured == 0)
+    {
+      gtk_icon_view_measure_rows (icon_view, 0, 0);
+      total = g_array_index (priv->rows, GtkIconViewRow, 0).height;
+      n_measured = 1;
+    }
+
+  estimate = total / n_measured;
+
+  for (r = 0; r < priv->rows->len; r++)
+    {
+      GtkIconViewRow *row = &g_array_index (priv->rows, GtkIconViewRow, r);
+      GtkCellAreaContext *context;
+
+      if (row->measured)
+        continue;
+
+      if (g_ptr_array_index (priv->row_contexts, r) == NULL)
+        {
+          context = gtk_cell_area_copy_context (priv->cell_area, priv->cell_area_context);
+          g_ptr_array_index (priv->row_contexts, r) = context;
+        }
+      else
+        context = g_ptr_array_index (priv->row_contexts, r);
+
+      row->height = estimate;
+      gtk_cell_area_context_allocate (context, priv->layout_item_width, estimate);
+    }
+}
+
+static void
+gtk_icon_view_validate_visible_rows (GtkIconView *icon_view)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+  gdouble value, page_size;
+  gint first, last, changed, anchor, anchor_y;
+
+  if (priv->validating_rows ||
+      priv->rows->len <= GTK_ICON_VIEW_VIRTUAL_ROWS ||
+      !gtk_icon_view_layout_is_current (icon_view))
+    return;
+
+  value = gtk_adjustment_get_value (priv->vadjustment);
+  page_size = gtk_adjustment_get_page_size (priv->vadjustment);
+
+  first = gtk_icon_view_row_at_y (icon_view, value - page_size);
+  last = gtk_icon_view_row_at_y (icon_view, value + 2 * page_size);
+
+  priv->in_layout = TRUE;
+  changed = gtk_icon_view_measure_rows (icon_view, first, last);
+  priv->in_layout = FALSE;
+
+  if (changed < 0)
+    return;
+
+  priv->validating_rows = TRUE;
+
+  /* keep the row at the top of the view in place */
+  anchor = gtk_icon_view_row_at_y (icon_view, value);
+  anchor_y = g_array_index (priv->rows, GtkIconViewRow, anchor).y;
+
+  gtk_icon_view_position_rows (icon_view, changed);
+  priv->height = MAX (priv->height, gtk_widget_get_allocated_height (GTK_WIDGET (icon_view)));
+
+  if (gtk_widget_get_realized (GTK_WIDGET (icon_view)))
+    gdk_window_resize (priv->bin_window,
+                       MAX (priv->width, gtk_widget_get_allocated_width (GTK_WIDGET (icon_view))),
+                       MAX (priv->height, gtk_widget_get_allocated_height (GTK_WIDGET (icon_view))));
+
+  gtk_icon_view_set_vadjustment_values (icon_view);
+  gtk_adjustment_set_value (priv->vadjustment,
+                            value + g_array_index (priv->rows, GtkIconViewRow, anchor).y - anchor_y);
+
+  priv->validating_rows = FALSE;
+
+  gtk_widget_queue_draw (GTK_WIDGET (icon_view));
+}
+
 static void
 gtk_icon_view_layout (GtkIconView *icon_view)
 {
   GtkIconViewPrivate *priv = icon_view->priv;
   GtkWidget *widget = GTK_WIDGET (icon_view);
-  GList *items;
   gint item_width; /* this doesn't include item_padding */
   gint n_columns, n_rows, n_items;
-  gint col, row;
-  GtkRequestedSize *sizes;
-  gboolean rtl;
+  gint col, row, i;
+  gboolean rtl, reset;
 
   if (gtk_icon_view_is_empty (icon_view))
     return;
@@ -2976,104 +3383,171 @@ gtk_icon_view_layout (GtkIconView *icon_view)
   priv->width += 2 * priv->margin;
   priv->width = MAX (priv->width, gtk_widget_get_allocated_width (widget));
 
-  /* Clear the per row contexts */
-  g_ptr_array_set_size (icon_view->priv->row_contexts, 0);
+  priv->in_layout = TRUE;
 
-  gtk_cell_area_context_reset (priv->cell_area_context);
-  /* because layouting is complicated. We designed an API
-   * that is O(N²) and nonsensical.
-   * And we're proud of it. */
-  for (items = priv->items; items; items = items->next)
+  reset = !priv->item_widths_valid ||
+          priv->n_columns != n_columns ||
+          priv->layout_item_width != item_width ||
+          priv->rows->len != n_rows;
+
+  if (!priv->item_widths_valid)
     {
-      _gtk_icon_view_set_cell_data (icon_view, items->data);
-      gtk_cell_area_get_preferred_width (priv->cell_area,
-                                         priv->cell_area_context,
-                                         widget,
-                                         NULL, NULL);
+      gtk_cell_area_context_reset (priv->cell_area_context);
+      /* because layouting is complicated. We designed an API
+       * that is O(N²) and nonsensical.
+       * And we're proud of it. */
+      for (i = 0; i < n_items; i++)
+        {
+          _gtk_icon_view_set_cell_data (icon_view, g_ptr_array_index (priv->items, i));
+          gtk_cell_area_get_preferred_width (priv->cell_area,
+                                             priv->cell_area_context,
+                                             widget,
+                                             NULL, NULL);
+        }
+
+      priv->item_widths_valid = TRUE;
     }
 
-  sizes = g_newa (GtkRequestedSize, n_rows);
-  items = priv->items;
-  priv->height = priv->margin;
+  priv->n_columns = n_columns;
+  priv->layout_item_width = item_width;
 
-  /* Collect the heights for all rows */
-  for (row = 0; row < n_rows; row++)
+  if (n_rows <= GTK_ICON_VIEW_VIRTUAL_ROWS)
     {
-      GtkCellAreaContext *context = gtk_cell_area_copy_context (priv->cell_area, priv->cell_area_context);
-      g_ptr_array_add (priv->row_contexts, context);
+      GtkRequestedSize *sizes;
+      gint height;
+
+      /* Clear the per row contexts */
+      g_ptr_array_set_size (priv->row_contexts, 0);
+      g_ptr_array_set_size (priv->row_contexts, n_rows);
+      g_array_set_size (priv->rows, n_rows);
 
-      for (col = 0; col < n_columns && items; col++, items = items->next)
+      sizes = g_newa (GtkRequestedSize, n_rows);
+      height = priv->margin;
+
+      /* Collect the heights for all rows */
+      for (row = 0; row < n_rows; row++)
         {
-          GtkIconViewItem *item = items->data;
+          sizes[row].data = GINT_TO_POINTER (row);
+          sizes[row].minimum_size = gtk_icon_view_measure_row (icon_view, row,
+                                                               &sizes[row].natural_size);
+          height += sizes[row].minimum_size + 2 * priv->item_padding + priv->row_spacing;
+        }
 
-          _gtk_icon_view_set_cell_data (icon_view, item);
-          gtk_cell_area_get_preferred_height_for_width (priv->cell_area,
-                                                        context,
-                                                        widget,
-                                                        item_width, 
-                                                        NULL, NULL);
+      height -= priv->row_spacing;
+      height += priv->margin;
+      height = MIN (height, gtk_widget_get_allocated_height (widget));
+
+      gtk_distribute_natural_allocation (gtk_widget_get_allocated_height (widget) - height,
+                                         n_rows,
+                                         sizes);
+
+      /* Actually allocate the rows */
+      g_qsort_with_data (sizes, n_rows, sizeof (GtkRequestedSize), compare_sizes, NULL);
+
+      for (row = 0; row < n_rows; row++)
+        {
+          GtkIconViewRow *r = &g_array_index (priv->rows, GtkIconViewRow, row);
+
+          gtk_cell_area_context_allocate (g_ptr_array_index (priv->row_contexts, row),
+                                          item_width, sizes[row].minimum_size);
+          r->height = sizes[row].minimum_size;
+          r->measured = TRUE;
         }
-      
-      sizes[row].data = GINT_TO_POINTER (row);
-      gtk_cell_area_context_get_preferred_height_for_width (context,
-                                                            item_width,
-                                                            &sizes[row].minimum_size,
-                                                            &sizes[row].natural_size);
-      priv->height += sizes[row].minimum_size + 2 * priv->item_padding + priv->row_spacing;
+
+      gtk_icon_view_position_rows (icon_view, 0);
     }
+  else
+    {
+      if (reset)
+        {
+          g_ptr_array_set_size (priv->row_contexts, 0);
+          g_ptr_array_set_size (priv->row_contexts, n_rows);
+          g_array_set_size (priv->rows, 0);
+          g_array_set_size (priv->rows, n_rows);
 
-  priv->height -= priv->row_spacing;
-  priv->height += priv->margin;
-  priv->height = MIN (priv->height, gtk_widget_get_allocated_height (widget));
+          gtk_icon_view_estimate_rows (icon_view);
+          gtk_icon_view_position_rows (icon_view, 0);
+        }
 
-  gtk_distribute_natural_allocation (gtk_widget_get_allocated_height (widget) - priv->height,
-                                     n_rows,
-                                     sizes);
+      if (priv->vadjustment)
+        {
+          gdouble value = gtk_adjustment_get_value (priv->vadjustment);
+          gint height = gtk_widget_get_allocated_height (widget);
+          gint changed;
+
+          changed = gtk_icon_view_measure_rows (icon_view,
+                                                gtk_icon_view_row_at_y (icon_view, value - height),
+                                                gtk_icon_view_row_at_y (icon_view, value + 2 * height));
+          if (changed >= 0)
+            gtk_icon_view_position_rows (icon_view, changed);
+        }
+    }
 
-  /* Actually allocate the rows */
-  g_qsort_with_data (sizes, n_rows, sizeof (GtkRequestedSize), compare_sizes, NULL);
-  
-  items = priv->items;
-  priv->height = priv->margin;
+  priv->in_layout = FALSE;
 
-  for (row = 0; row < n_rows; row++)
+  for (i = 0; i < n_items; i++)
     {
-      GtkCellAreaContext *context = g_ptr_array_index (priv->row_contexts, row);
-      gtk_cell_area_context_allocate (context, item_width, sizes[row].minimum_size);
+      GtkIconViewItem *item = g_ptr_array_index (priv->items, i);
 
-      priv->height += priv->item_padding;
+      row = i / n_columns;
+      col = i % n_columns;
 
-      for (col = 0; col < n_columns && items; col++, items = items->next)
+      item->cell_area.x = priv->margin + (col * 2 + 1) * priv->item_padding + col * (priv->column_spacing + item_width);
+      item->cell_area.width = item_width;
+      item->row = row;
+      item->col = col;
+      if (rtl)
         {
-          GtkIconViewItem *item = items->data;
-
-          item->cell_area.x = priv->margin + (col * 2 + 1) * priv->item_padding + col * (priv->column_spacing + item_width);
-          item->cell_area.width = item_width;
-          item->cell_area.y = priv->height;
-          item->cell_area.height = sizes[row].minimum_size;
-          item->row = row;
-          item->col = col;
-          if (rtl)
-            {
-              item->cell_area.x = priv->width - item_width - item->cell_area.x;
-              item->col = n_columns - 1 - col;
-            }
+          item->cell_area.x = priv->width - item_width - item->cell_area.x;
+          item->col = n_columns - 1 - col;
         }
-
-      priv->height += sizes[row].minimum_size + priv->item_padding + priv->row_spacing;
     }
 
-  priv->height -= priv->row_spacing;
-  priv->height += priv->margin;
   priv->height = MAX (priv->height, gtk_widget_get_allocated_height (widget));
 }
 
+static void
+gtk_icon_view_invalidate_rows (GtkIconView *icon_view)
+{
+  g_array_set_size (icon_view->priv->rows, 0);
+}
+
+/* Drops everything the layout caches: the item widths, the
+ * cached item sizes and the row table.
+ */
+static void
+gtk_icon_view_invalidate_layout (GtkIconView *icon_view)
+{
+  GtkIconViewPrivate *priv = icon_view->priv;
+
+  priv->item_widths_valid = FALSE;
+  priv->n_item_sizes = 0;
+  gtk_icon_view_invalidate_rows (icon_view);
+}
+
+static void
+gtk_icon_view_context_changed (GObject    *context,
+                               GParamSpec *pspec,
+                               gpointer    data)
+{
+  GtkIconView *icon_view = GTK_ICON_VIEW (data);
+
+  /* the layout itself measures into this context */
+  if (icon_view->priv->in_layout)
+    return;
+
+  gtk_icon_view_invalidate_layout (icon_view);
+  gtk_widget_queue_resize (GTK_WIDGET (icon_view));
+}
+
 static void
 gtk_icon_view_invalidate_sizes (GtkIconView *icon_view)
 {
+  gtk_icon_view_invalidate_layout (icon_view);
+
   /* Clear all item sizes */
-  g_list_foreach (icon_view->priv->items,
-		  (GFunc)gtk_icon_view_item_invalidate_size, NULL);
+  g_ptr_array_foreach (icon_view->priv->items,
+		       (GFunc)gtk_icon_view_item_invalidate_size, NULL);
 
   /* Re-layout the items */
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
@@ -3194,21 +3668,11 @@ static void
 gtk_icon_view_queue_draw_path (GtkIconView *icon_view,
 			       GtkTreePath *path)
 {
-  GList *l;
-  gint index;
-
-  index = gtk_tree_path_get_indices (path)[0];
-
-  for (l = icon_view->priv->items; l; l = l->next) 
-    {
-      GtkIconViewItem *item = l->data;
+  GtkIconViewItem *item;
 
-      if (item->index == index)
-	{
-	  gtk_icon_view_queue_draw_item (icon_view, item);
-	  break;
-	}
-    }
+  item = gtk_icon_view_get_nth_item (icon_view, gtk_tree_path_get_indices (path)[0]);
+  if (item)
+    gtk_icon_view_queue_draw_item (icon_view, item);
 }
 
 static void
@@ -3311,14 +3775,26 @@ _gtk_icon_view_get_item_at_coords (GtkIconView          *icon_view,
                                    gboolean              only_in_cell,
                                    GtkCellRenderer     **cell_at_pos)
 {
-  GList *items;
+  GtkIconViewPrivate *priv = icon_view->priv;
+  gint i, first, last;
 
   if (cell_at_pos)
     *cell_at_pos = NULL;
 
-  for (items = icon_view->priv->items; items; items = items->next)
+  /* Items can only be hit from their own row or a neighbouring one */
+  first = 0;
+  last = priv->items->len;
+  if (gtk_icon_view_layout_is_current (icon_view))
+    {
+      gint row = gtk_icon_view_row_at_y (icon_view, y);
+
+      first = MAX (row - 1, 0) * priv->n_columns;
+      last = MIN ((row + 2) * priv->n_columns, priv->items->len);
+    }
+
+  for (i = first; i < last; i++)
     {
-      GtkIconViewItem *item = items->data;
+      GtkIconViewItem *item = g_ptr_array_index (priv->items, i);
       GdkRectangle    *item_area = &item->cell_area;
 
       if (x >= item_area->x - icon_view->priv->column_spacing/2 && 
@@ -3404,18 +3880,18 @@ _gtk_icon_view_unselect_item (GtkIconView      *icon_view,
 static void
 verify_items (GtkIconView *icon_view)
 {
-  GList *items;
-  int i = 0;
+  guint i;
 
-  for (items = icon_view->priv->items; items; items = items->next)
+  if (!GTK_DEBUG_CHECK (TREE))
+    return;
+
+  for (i = 0; i < icon_view->priv->items->len; i++)
     {
-      GtkIconViewItem *item = items->data;
+      GtkIconViewItem *item = g_ptr_array_index (icon_view->priv->items, i);
 
-      if (item->index != i)
+      if (item->index != (gint) i)
 	g_error ("List item does not match its index: "
-		 "item index %d and list index %d\n", item->index, i);
-
-      i++;
+		 "item index %d and list index %u\n", item->index, i);
     }
 }
 
@@ -3458,9 +3934,8 @@ gtk_icon_view_row_inserted (GtkTreeModel *model,
 			    gpointer      data)
 {
   GtkIconView *icon_view = GTK_ICON_VIEW (data);
-  gint index;
+  gint index, i;
   GtkIconViewItem *item;
-  GList *list;
 
   /* ignore changes in branches */
   if (gtk_tree_path_get_depth (path) > 1)
@@ -3472,23 +3947,18 @@ gtk_icon_view_row_inserted (GtkTreeModel *model,
 
   item->index = index;
 
-  /* FIXME: We can be more efficient here,
-     we can store a tail pointer and use that when
-     appending (which is a rather common operation)
-  */
-  icon_view->priv->items = g_list_insert (icon_view->priv->items,
-					 item, index);
-  
-  list = g_list_nth (icon_view->priv->items, index + 1);
-  for (; list; list = list->next)
+  g_ptr_array_insert (icon_view->priv->items, index, item);
+
+  for (i = index + 1; i < icon_view->priv->items->len; i++)
     {
-      item = list->data;
+      item = g_ptr_array_index (icon_view->priv->items, i);
 
       item->index++;
     }
     
   verify_items (icon_view);
 
+  gtk_icon_view_invalidate_layout (icon_view);
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 }
 
@@ -3500,8 +3970,8 @@ gtk_icon_view_row_deleted (GtkTreeModel *model,
   GtkIconView *icon_view = GTK_ICON_VIEW (data);
   gint index;
   GtkIconViewItem *item;
-  GList *list, *next;
   gboolean emit = FALSE;
+  gint i;
 
   /* ignore changes in branches */
   if (gtk_tree_path_get_depth (path) > 1)
@@ -3509,8 +3979,7 @@ gtk_icon_view_row_deleted (GtkTreeModel *model,
 
   index = gtk_tree_path_get_indices(path)[0];
 
-  list = g_list_nth (icon_view->priv->items, index);
-  item = list->data;
+  item = gtk_icon_view_get_nth_item (icon_view, index);
 
   if (icon_view->priv->cell_area)
     gtk_cell_area_stop_editing (icon_view->priv->cell_area, TRUE);
@@ -3527,19 +3996,19 @@ gtk_icon_view_row_deleted (GtkTreeModel *model,
   if (item->selected)
     emit = TRUE;
   
+  g_ptr_array_remove_index (icon_view->priv->items, index);
   gtk_icon_view_item_free (item);
 
-  for (next = list->next; next; next = next->next)
+  for (i = index; i < icon_view->priv->items->len; i++)
     {
-      item = next->data;
+      item = g_ptr_array_index (icon_view->priv->items, i);
 
       item->index--;
     }
-  
-  icon_view->priv->items = g_list_delete_link (icon_view->priv->items, list);
 
   verify_items (icon_view);  
   
+  gtk_icon_view_invalidate_layout (icon_view);
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 
   if (emit)
@@ -3556,7 +4025,6 @@ gtk_icon_view_rows_reordered (GtkTreeModel *model,
   GtkIconView *icon_view = GTK_ICON_VIEW (data);
   int i;
   int length;
-  GList *items = NULL, *list;
   GtkIconViewItem **item_array;
   gint *order;
 
@@ -3574,19 +4042,20 @@ gtk_icon_view_rows_reordered (GtkTreeModel *model,
     order [new_order[i]] = i;
 
   item_array = g_new (GtkIconViewItem *, length);
-  for (i = 0, list = icon_view->priv->items; list != NULL; list = list->next, i++)
-    item_array[order[i]] = list->data;
+  for (i = 0; i < length; i++)
+    item_array[order[i]] = g_ptr_array_index (icon_view->priv->items, i);
   g_free (order);
 
-  for (i = length - 1; i >= 0; i--)
+  for (i = 0; i < length; i++)
     {
       item_array[i]->index = i;
-      items = g_list_prepend (items, item_array[i]);
+      g_ptr_array_index (icon_view->priv->items, i) = item_array[i];
     }
   
   g_free (item_array);
-  g_list_free (icon_view->priv->items);
-  icon_view->priv->items = items;
+
+  /* the rows keep their items, but the items changed places */
+  gtk_icon_view_invalidate_rows (icon_view);
 
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 
@@ -3598,7 +4067,6 @@ gtk_icon_view_build_items (GtkIconView *icon_view)
 {
   GtkTreeIter iter;
   int i;
-  GList *items = NULL;
 
   if (!gtk_tree_model_get_iter_first (icon_view->priv->model,
 				      &iter))
@@ -3614,11 +4082,9 @@ gtk_icon_view_build_items (GtkIconView *icon_view)
       
       i++;
 
-      items = g_list_prepend (items, item);
+      g_ptr_array_add (icon_view->priv->items, item);
       
     } while (gtk_tree_model_iter_next (icon_view->priv->model, &iter));
-
-  icon_view->priv->items = g_list_reverse (items);
 }
 
 static void
@@ -3726,7 +4192,7 @@ find_item (GtkIconView     *icon_view,
 	   gint             col_ofs)
 {
   gint row, col;
-  GList *items;
+  guint i;
   GtkIconViewItem *item;
 
   /* FIXME: this could be more efficient 
@@ -3734,9 +4200,9 @@ find_item (GtkIconView     *icon_view,
   row = current->row + row_ofs;
   col = current->col + col_ofs;
 
-  for (items = icon_view->priv->items; items; items = items->next)
+  for (i = 0; i < icon_view->priv->items->len; i++)
     {
-      item = items->data;
+      item = g_ptr_array_index (icon_view->priv->items, i);
       if (item->row == row && item->col == col)
 	return item;
     }
@@ -3749,23 +4215,23 @@ find_item_page_up_down (GtkIconView     *icon_view,
 			GtkIconViewItem *current,
 			gint             count)
 {
-  GList *item, *next;
-  gint y, col;
+  GtkIconViewItem *item, *next;
+  gint y, col, i;
   
   col = current->col;
   y = current->cell_area.y + count * gtk_adjustment_get_page_size (icon_view->priv->vadjustment);
 
-  item = g_list_find (icon_view->priv->items, current);
+  item = current;
   if (count > 0)
     {
-      while (item)
+      while (TRUE)
 	{
-	  for (next = item->next; next; next = next->next)
+	  for (i = item->index + 1; (next = gtk_icon_view_get_nth_item (icon_view, i)); i++)
 	    {
-	      if (((GtkIconViewItem *)next->data)->col == col)
+	      if (next->col == col)
 		break;
 	    }
-	  if (!next || ((GtkIconViewItem *)next->data)->cell_area.y > y)
+	  if (!next || next->cell_area.y > y)
 	    break;
 
 	  item = next;
@@ -3773,24 +4239,21 @@ find_item_page_up_down (GtkIconView     *icon_view,
     }
   else 
     {
-      while (item)
+      while (TRUE)
 	{
-	  for (next = item->prev; next; next = next->prev)
+	  for (i = item->index - 1; (next = gtk_icon_view_get_nth_item (icon_view, i)); i--)
 	    {
-	      if (((GtkIconViewItem *)next->data)->col == col)
+	      if (next->col == col)
 		break;
 	    }
-	  if (!next || ((GtkIconViewItem *)next->data)->cell_area.y < y)
+	  if (!next || next->cell_area.y < y)
 	    break;
 
 	  item = next;
 	}
     }
 
-  if (item)
-    return item->data;
-
-  return NULL;
+  return item;
 }
 
 static gboolean
@@ -3798,7 +4261,7 @@ gtk_icon_view_select_all_between (GtkIconView     *icon_view,
 				  GtkIconViewItem *anchor,
 				  GtkIconViewItem *cursor)
 {
-  GList *items;
+  guint i;
   GtkIconViewItem *item;
   gint row1, row2, col1, col2;
   gboolean dirty = FALSE;
@@ -3825,9 +4288,9 @@ gtk_icon_view_select_all_between (GtkIconView     *icon_view,
       col2 = anchor->col;
     }
 
-  for (items = icon_view->priv->items; items; items = items->next)
+  for (i = 0; i < icon_view->priv->items->len; i++)
     {
-      item = items->data;
+      item = g_ptr_array_index (icon_view->priv->items, i);
 
       if (row1 <= item->row && item->row <= row2 &&
 	  col1 <= item->col && item->col <= col2)
@@ -3862,25 +4325,17 @@ gtk_icon_view_move_cursor_up_down (GtkIconView *icon_view,
 
   if (!icon_view->priv->cursor_item)
     {
-      GList *list;
-
       if (count > 0)
-	list = icon_view->priv->items;
+	item = gtk_icon_view_get_nth_item (icon_view, 0);
       else
-	list = g_list_last (icon_view->priv->items);
+	item = gtk_icon_view_get_nth_item (icon_view, icon_view->priv->items->len - 1);
 
-      if (list)
+      if (item)
         {
-          item = list->data;
-
           /* Give focus to the first cell initially */
           _gtk_icon_view_set_cell_data (icon_view, item);
           gtk_cell_area_focus (icon_view->priv->cell_area, direction);
         }
-      else
-        {
-          item = NULL;
-        }
     }
   else
     {
@@ -3954,14 +4409,10 @@ gtk_icon_view_move_cursor_page_up_down (GtkIconView *icon_view,
   
   if (!icon_view->priv->cursor_item)
     {
-      GList *list;
-
       if (count > 0)
-	list = icon_view->priv->items;
+	item = gtk_icon_view_get_nth_item (icon_view, 0);
       else
-	list = g_list_last (icon_view->priv->items);
-
-      item = list ? list->data : NULL;
+	item = gtk_icon_view_get_nth_item (icon_view, icon_view->priv->items->len - 1);
     }
   else
     item = find_item_page_up_down (icon_view, 
@@ -4014,25 +4465,17 @@ gtk_icon_view_move_cursor_left_right (GtkIconView *icon_view,
 
   if (!icon_view->priv->cursor_item)
     {
-      GList *list;
-
       if (count > 0)
-	list = icon_view->priv->items;
+	item = gtk_icon_view_get_nth_item (icon_view, 0);
       else
-	list = g_list_last (icon_view->priv->items);
+	item = gtk_icon_view_get_nth_item (icon_view, icon_view->priv->items->len - 1);
 
-      if (list)
+      if (item)
         {
-          item = list->data;
-
           /* Give focus to the first cell initially */
           _gtk_icon_view_set_cell_data (icon_view, item);
           gtk_cell_area_focus (icon_view->priv->cell_area, direction);
         }
-      else
-        {
-          item = NULL;
-        }
     }
   else
     {
@@ -4099,18 +4542,15 @@ gtk_icon_view_move_cursor_start_end (GtkIconView *icon_view,
 				     gint         count)
 {
   GtkIconViewItem *item;
-  GList *list;
   gboolean dirty = FALSE;
   
   if (!gtk_widget_has_focus (GTK_WIDGET (icon_view)))
     return;
   
   if (count < 0)
-    list = icon_view->priv->items;
+    item = gtk_icon_view_get_nth_item (icon_view, 0);
   else
-    list = g_list_last (icon_view->priv->items);
-  
-  item = list ? list->data : NULL;
+    item = gtk_icon_view_get_nth_item (icon_view, icon_view->priv->items->len - 1);
 
   if (item == icon_view->priv->cursor_item)
     gtk_widget_error_bell (GTK_WIDGET (icon_view));
@@ -4184,8 +4624,8 @@ gtk_icon_view_scroll_to_path (GtkIconView *icon_view,
   widget = GTK_WIDGET (icon_view);
 
   if (gtk_tree_path_get_depth (path) > 0)
-    item = g_list_nth_data (icon_view->priv->items,
-			    gtk_tree_path_get_indices(path)[0]);
+    item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices (path)[0]);
   
   if (!item || item->cell_area.width < 0 ||
       !gtk_widget_get_realized (widget))
@@ -4300,6 +4740,9 @@ gtk_icon_view_ensure_cell_area (GtkIconView *icon_view,
     gtk_orientable_set_orientation (GTK_ORIENTABLE (priv->cell_area), priv->item_orientation);
 
   priv->cell_area_context = gtk_cell_area_create_context (priv->cell_area);
+  priv->context_changed_id =
+    g_signal_connect (priv->cell_area_context, "notify",
+                      G_CALLBACK (gtk_icon_view_context_changed), icon_view);
 
   priv->add_editable_id =
     g_signal_connect (priv->cell_area, "add-editable",
@@ -4336,9 +4779,12 @@ _gtk_icon_view_set_cell_data (GtkIconView     *icon_view,
     return;
   gtk_tree_path_free (path);
 
+  /* applying attributes notifies on the cells, that is not a change */
+  icon_view->priv->setting_cell_data = TRUE;
   gtk_cell_area_apply_attributes (icon_view->priv->cell_area, 
 				  icon_view->priv->model,
 				  &iter, FALSE, FALSE);
+  icon_view->priv->setting_cell_data = FALSE;
 }
 
 
@@ -4543,8 +4989,8 @@ gtk_icon_view_get_cell_rect (GtkIconView     *icon_view,
   g_return_val_if_fail (cell == NULL || GTK_IS_CELL_RENDERER (cell), FALSE);
 
   if (gtk_tree_path_get_depth (path) > 0)
-    item = g_list_nth_data (icon_view->priv->items,
-			    gtk_tree_path_get_indices(path)[0]);
+    item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices (path)[0]);
 
   if (!item)
     return FALSE;
@@ -4835,7 +5281,7 @@ gtk_icon_view_get_visible_range (GtkIconView  *icon_view,
 {
   gint start_index = -1;
   gint end_index = -1;
-  GList *icons;
+  guint i;
 
   g_return_val_if_fail (GTK_IS_ICON_VIEW (icon_view), FALSE);
 
@@ -4846,9 +5292,9 @@ gtk_icon_view_get_visible_range (GtkIconView  *icon_view,
   if (start_path == NULL && end_path == NULL)
     return FALSE;
   
-  for (icons = icon_view->priv->items; icons; icons = icons->next) 
+  for (i = 0; i < icon_view->priv->items->len; i++)
     {
-      GtkIconViewItem *item = icons->data;
+      GtkIconViewItem *item = g_ptr_array_index (icon_view->priv->items, i);
       GdkRectangle    *item_area = &item->cell_area;
 
       if ((item_area->x + item_area->width >= (int)gtk_adjustment_get_value (icon_view->priv->hadjustment)) &&
@@ -4890,11 +5336,11 @@ gtk_icon_view_selected_foreach (GtkIconView           *icon_view,
 				GtkIconViewForeachFunc func,
 				gpointer               data)
 {
-  GList *list;
+  guint i;
   
-  for (list = icon_view->priv->items; list; list = list->next)
+  for (i = 0; i < icon_view->priv->items->len; i++)
     {
-      GtkIconViewItem *item = list->data;
+      GtkIconViewItem *item = g_ptr_array_index (icon_view->priv->items, i);
       GtkTreePath *path = gtk_tree_path_new_from_indices (item->index, -1);
 
       if (item->selected)
@@ -5032,8 +5478,8 @@ gtk_icon_view_set_model (GtkIconView *icon_view,
 
       g_object_unref (icon_view->priv->model);
       
-      g_list_free_full (icon_view->priv->items, (GDestroyNotify) gtk_icon_view_item_free);
-      icon_view->priv->items = NULL;
+      g_ptr_array_foreach (icon_view->priv->items, (GFunc) gtk_icon_view_item_free, NULL);
+      g_ptr_array_set_size (icon_view->priv->items, 0);
       icon_view->priv->anchor_item = NULL;
       icon_view->priv->cursor_item = NULL;
       icon_view->priv->last_single_clicked = NULL;
@@ -5072,6 +5518,7 @@ gtk_icon_view_set_model (GtkIconView *icon_view,
   if (dirty)
     g_signal_emit (icon_view, icon_view_signals[SELECTION_CHANGED], 0);
 
+  gtk_icon_view_invalidate_layout (icon_view);
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 }
 
@@ -5397,8 +5844,8 @@ gtk_icon_view_select_path (GtkIconView *icon_view,
   g_return_if_fail (path != NULL);
 
   if (gtk_tree_path_get_depth (path) > 0)
-    item = g_list_nth_data (icon_view->priv->items,
-			    gtk_tree_path_get_indices(path)[0]);
+    item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices (path)[0]);
 
   if (item)
     _gtk_icon_view_select_item (icon_view, item);
@@ -5423,8 +5870,8 @@ gtk_icon_view_unselect_path (GtkIconView *icon_view,
   g_return_if_fail (icon_view->priv->model != NULL);
   g_return_if_fail (path != NULL);
 
-  item = g_list_nth_data (icon_view->priv->items,
-			  gtk_tree_path_get_indices(path)[0]);
+  item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices (path)[0]);
 
   if (!item)
     return;
@@ -5453,14 +5900,14 @@ gtk_icon_view_unselect_path (GtkIconView *icon_view,
 GList *
 gtk_icon_view_get_selected_items (GtkIconView *icon_view)
 {
-  GList *list;
   GList *selected = NULL;
+  guint i;
   
   g_return_val_if_fail (GTK_IS_ICON_VIEW (icon_view), NULL);
   
-  for (list = icon_view->priv->items; list != NULL; list = list->next)
+  for (i = 0; i < icon_view->priv->items->len; i++)
     {
-      GtkIconViewItem *item = list->data;
+      GtkIconViewItem *item = g_ptr_array_index (icon_view->priv->items, i);
 
       if (item->selected)
 	{
@@ -5485,7 +5932,7 @@ gtk_icon_view_get_selected_items (GtkIconView *icon_view)
 void
 gtk_icon_view_select_all (GtkIconView *icon_view)
 {
-  GList *items;
+  guint i;
   gboolean dirty = FALSE;
   
   g_return_if_fail (GTK_IS_ICON_VIEW (icon_view));
@@ -5493,9 +5940,9 @@ gtk_icon_view_select_all (GtkIconView *icon_view)
   if (icon_view->priv->selection_mode != GTK_SELECTION_MULTIPLE)
     return;
 
-  for (items = icon_view->priv->items; items; items = items->next)
+  for (i = 0; i < icon_view->priv->items->len; i++)
     {
-      GtkIconViewItem *item = items->data;
+      GtkIconViewItem *item = g_ptr_array_index (icon_view->priv->items, i);
       
       if (!item->selected)
 	{
@@ -5555,8 +6002,8 @@ gtk_icon_view_path_is_selected (GtkIconView *icon_view,
   g_return_val_if_fail (icon_view->priv->model != NULL, FALSE);
   g_return_val_if_fail (path != NULL, FALSE);
   
-  item = g_list_nth_data (icon_view->priv->items,
-			  gtk_tree_path_get_indices(path)[0]);
+  item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices (path)[0]);
 
   if (!item)
     return FALSE;
@@ -5586,8 +6033,8 @@ gtk_icon_view_get_item_row (GtkIconView *icon_view,
   g_return_val_if_fail (icon_view->priv->model != NULL, -1);
   g_return_val_if_fail (path != NULL, -1);
 
-  item = g_list_nth_data (icon_view->priv->items,
-                          gtk_tree_path_get_indices(path)[0]);
+  item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices (path)[0]);
 
   if (!item)
     return -1;
@@ -5617,8 +6064,8 @@ gtk_icon_view_get_item_column (GtkIconView *icon_view,
   g_return_val_if_fail (icon_view->priv->model != NULL, -1);
   g_return_val_if_fail (path != NULL, -1);
 
-  item = g_list_nth_data (icon_view->priv->items,
-                          gtk_tree_path_get_indices(path)[0]);
+  item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices (path)[0]);
 
   if (!item)
     return -1;
@@ -7092,8 +7539,8 @@ gtk_icon_view_create_drag_icon (GtkIconView *icon_view,
   GtkWidget *widget;
   cairo_t *cr;
   cairo_surface_t *surface;
-  GList *l;
-  gint index;
+  GtkIconViewItem *item;
+  GdkRectangle rect;
 
   g_return_val_if_fail (GTK_IS_ICON_VIEW (icon_view), NULL);
   g_return_val_if_fail (path != NULL, NULL);
@@ -7103,40 +7550,30 @@ gtk_icon_view_create_drag_icon (GtkIconView *icon_view,
   if (!gtk_widget_get_realized (widget))
     return NULL;
 
-  index = gtk_tree_path_get_indices (path)[0];
+  item = gtk_icon_view_get_nth_item (icon_view, gtk_tree_path_get_indices (path)[0]);
+  if (item == NULL)
+    return NULL;
 
-  for (l = icon_view->priv->items; l; l = l->next) 
-    {
-      GtkIconViewItem *item = l->data;
-      
-      if (index == item->index)
-	{
-	  GdkRectangle rect = { 
-	    item->cell_area.x - icon_view->priv->item_padding, 
-	    item->cell_area.y - icon_view->priv->item_padding, 
-	    item->cell_area.width  + icon_view->priv->item_padding * 2, 
-	    item->cell_area.height + icon_view->priv->item_padding * 2 
-	  };
+  rect.x = item->cell_area.x - icon_view->priv->item_padding;
+  rect.y = item->cell_area.y - icon_view->priv->item_padding;
+  rect.width = item->cell_area.width + icon_view->priv->item_padding * 2;
+  rect.height = item->cell_area.height + icon_view->priv->item_padding * 2;
 
-	  surface = gdk_window_create_similar_surface (icon_view->priv->bin_window,
-                                                       CAIRO_CONTENT_COLOR_ALPHA,
-                                                       rect.width,
-                                                       rect.height);
+  surface = gdk_window_create_similar_surface (icon_view->priv->bin_window,
+                                               CAIRO_CONTENT_COLOR_ALPHA,
+                                               rect.width,
+                                               rect.height);
 
-	  cr = cairo_create (surface);
+  cr = cairo_create (surface);
 
-	  gtk_icon_view_paint_item (icon_view, cr, item, 
-				    icon_view->priv->item_padding,
-				    icon_view->priv->item_padding,
-                                    FALSE);
+  gtk_icon_view_paint_item (icon_view, cr, item,
+                            icon_view->priv->item_padding,
+                            icon_view->priv->item_padding,
+                            FALSE);
 
-	  cairo_destroy (cr);
+  cairo_destroy (cr);
 
-	  return surface;
-	}
-    }
-  
-  return NULL;
+  return surface;
 }
 
 /**
@@ -35,6 +35,27 @@ struct _GtkIconViewItem
 
 };
 
+typedef struct _GtkIconViewRow GtkIconViewRow;
+struct _GtkIconViewRow
+{
+  gint y;
+  gint height;
+
+  /* FALSE if height is only an estimate */
+  guint measured : 1;
+};
+
+typedef struct _GtkIconViewItemSize GtkIconViewItemSize;
+struct _GtkIconViewItemSize
+{
+  GtkOrientation orientation;
+  gint for_size;
+  gint minimum;
+  gint natural;
+};
+
+#define GTK_ICON_VIEW_ITEM_SIZE_CACHE 4
+
 struct _GtkIconViewPrivate
 {
   GtkCellArea        *cell_area;
@@ -56,7 +77,15 @@ struct _GtkIconViewPrivate
 
   GtkTreeModel *model;
 
-  GList *items;
+  GPtrArray *items;
+
+  /* Layout of the last allocation, kept until sizes are invalidated */
+  GArray *rows;
+  gint n_columns;
+  gint layout_item_width;
+  GtkIconViewItemSize item_sizes[GTK_ICON_VIEW_ITEM_SIZE_CACHE];
+  guint n_item_sizes;
+  guint next_item_size;
 
   GtkAdjustment *hadjustment;
   GtkAdjustment *vadjustment;
@@ -130,6 +159,10 @@ struct _GtkIconViewPrivate
 
   guint doing_rubberband : 1;
 
+  guint item_widths_valid : 1;
+  guint in_layout : 1;
+  guint validating_rows : 1;
+  guint setting_cell_data : 1;
 };
 
 void                 _gtk_icon_view_set_cell_data                  (GtkIconView            *icon_view,
@@ -219,6 +219,7 @@ enum
   PROP_GICON,
   PROP_RESOURCE,
   PROP_USE_FALLBACK,
+  PROP_LOAD_ASYNC,
   NUM_PROPERTIES
 };
 
@@ -399,6 +400,21 @@ gtk_image_class_init (GtkImageClass *class)
                             FALSE,
                             GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkImage:load-async:
+   *
+   * Whether icons from the icon theme are loaded in a thread.
+   * See gtk_image_set_load_async().
+   *
+   * Since: 3.22
+   */
+  image_props[PROP_LOAD_ASYNC] =
+      g_param_spec_boolean ("load-async",
+                            P_("Load asynchronously"),
+                            P_("Whether to load icons in a thread"),
+                            FALSE,
+                            GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, image_props);
 
   gtk_widget_class_set_accessible_type (widget_class, GTK_TYPE_IMAGE_ACCESSIBLE);
@@ -505,6 +521,10 @@ gtk_image_set_property (GObject      *object,
         g_object_notify_by_pspec (object, pspec);
       break;
 
+    case PROP_LOAD_ASYNC:
+      gtk_image_set_load_async (image, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -560,6 +580,9 @@ gtk_image_get_property (GObject     *object,
     case PROP_USE_FALLBACK:
       g_value_set_boolean (value, _gtk_icon_helper_get_use_fallback (priv->icon_helper));
       break;
+    case PROP_LOAD_ASYNC:
+      g_value_set_boolean (value, _gtk_icon_helper_get_load_async (priv->icon_helper));
+      break;
     case PROP_STORAGE_TYPE:
       g_value_set_enum (value, _gtk_icon_helper_get_storage_type (priv->icon_helper));
       break;
@@ -1975,3 +1998,47 @@ gtk_image_get_pixel_size (GtkImage *image)
 
   return _gtk_icon_helper_get_pixel_size (image->priv->icon_helper);
 }
+
+/**
+ * gtk_image_set_load_async:
+ * @image: a #GtkImage
+ * @load_async: whether to load icons asynchronously
+ *
+ * Sets whether icons from the icon theme, as set with
+ * gtk_image_set_from_icon_name() or gtk_image_set_from_gicon(),
+ * are loaded in a thread.
+ *
+ * While an icon is being loaded, the image keeps the size of
+ * its icon size or pixel size, but draws nothing. This avoids
+ * blocking on disk access, e.g. when showing many thumbnails.
+ *
+ * Since: 3.22
+ */
+void
+gtk_image_set_load_async (GtkImage *image,
+                          gboolean  load_async)
+{
+  g_return_if_fail (GTK_IS_IMAGE (image));
+
+  if (_gtk_icon_helper_set_load_async (image->priv->icon_helper, load_async))
+    g_object_notify_by_pspec (G_OBJECT (image), image_props[PROP_LOAD_ASYNC]);
+}
+
+/**
+ * gtk_image_get_load_async:
+ * @image: a #GtkImage
+ *
+ * Gets whether icons are loaded asynchronously.
+ * See gtk_image_set_load_async().
+ *
+ * Returns: %TRUE if icons are loaded asynchronously
+ *
+ * Since: 3.22
+ */
+gboolean
+gtk_image_get_load_async (GtkImage *image)
+{
+  g_return_val_if_fail (GTK_IS_IMAGE (image), FALSE);
+
+  return _gtk_icon_helper_get_load_async (image->priv->icon_helper);
+}
@@ -198,6 +198,12 @@ void       gtk_image_get_gicon     (GtkImage              *image,
 GDK_AVAILABLE_IN_ALL
 gint       gtk_image_get_pixel_size (GtkImage             *image);
 
+GDK_AVAILABLE_IN_3_22
+void       gtk_image_set_load_async (GtkImage             *image,
+                                     gboolean              load_async);
+GDK_AVAILABLE_IN_3_22
+gboolean   gtk_image_get_load_async (GtkImage             *image);
+
 G_END_DECLS
 
 #endif /* __GTK_IMAGE_H__ */
@@ -247,6 +247,16 @@
  * the #GtkLabel::activate-link signal and the gtk_label_get_current_uri() function.
  */
 
+/* Number of height-for-width results kept per label */
+#define GTK_LABEL_SIZE_CACHE 4
+
+typedef struct
+{
+  gint width;
+  gint height;
+  gint baseline;
+} GtkLabelCachedSize;
+
 struct _GtkLabelPrivate
 {
   GtkLabelSelectionInfo *select_info;
@@ -283,6 +293,11 @@ struct _GtkLabelPrivate
   gint     width_chars;
   gint     max_width_chars;
   gint     lines;
+
+  GtkLabelCachedSize cached_sizes[GTK_LABEL_SIZE_CACHE];
+  guint    n_cached_sizes;
+  guint    next_cached_size;
+  guint    cached_sizes_serial;
 };
 
 /* Notes about the handling of links:
@@ -466,6 +481,7 @@ static void gtk_label_ensure_select_info  (GtkLabel *label);
 static void gtk_label_clear_select_info   (GtkLabel *label);
 static void gtk_label_update_cursor       (GtkLabel *label);
 static void gtk_label_clear_layout        (GtkLabel *label);
+static void gtk_label_clear_cached_sizes  (GtkLabel *label);
 static void gtk_label_ensure_layout       (GtkLabel *label);
 static void gtk_label_select_region_index (GtkLabel *label,
                                            gint      anchor_index,
@@ -3243,6 +3259,7 @@ gtk_label_set_line_wrap_mode (GtkLabel *label,
   if (priv->wrap_mode != wrap_mode)
     {
       priv->wrap_mode = wrap_mode;
+      gtk_label_clear_cached_sizes (label);
       g_object_notify_by_pspec (G_OBJECT (label), label_props[PROP_WRAP_MODE]);
 
       gtk_widget_queue_resize (GTK_WIDGET (label));
@@ -3304,10 +3321,17 @@ gtk_label_finalize (GObject *object)
   G_OBJECT_CLASS (gtk_label_parent_class)->finalize (object);
 }
 
+static void
+gtk_label_clear_cached_sizes (GtkLabel *label)
+{
+  label->priv->n_cached_sizes = 0;
+}
+
 static void
 gtk_label_clear_layout (GtkLabel *label)
 {
   g_clear_object (&label->priv->layout);
+  gtk_label_clear_cached_sizes (label);
 }
 
 /**
@@ -3624,9 +3648,70 @@ gtk_label_get_request_mode (GtkWidget *widget)
 }
 
 
+/* Size negotiation in boxes and grids probes a wrapping label at a
+ * handful of widths over and over; remember the last few results so
+ * that the text does not have to be laid out again for each probe.
+ * The cache is dropped whenever the layout's contents change, and
+ * when the widget's pango context changes (e.g. the font).
+ */
+static gboolean
+gtk_label_lookup_cached_size (GtkLabel *label,
+                              gint      width,
+                              gint     *height,
+                              gint     *baseline)
+{
+  GtkLabelPrivate *priv = label->priv;
+  PangoContext *context;
+  guint serial, i;
+
+  context = gtk_widget_get_pango_context (GTK_WIDGET (label));
+  serial = pango_context_get_serial (context);
+  if (serial != priv->cached_sizes_serial)
+    {
+      priv->cached_sizes_serial = serial;
+      gtk_label_clear_cached_sizes (label);
+      return FALSE;
+    }
+
+  for (i = 0; i < priv->n_cached_sizes; i++)
+    {
+      if (priv->cached_sizes[i].width == width)
+        {
+          *height = priv->cached_sizes[i].height;
+          *baseline = priv->cached_sizes[i].baseline;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static void
+gtk_label_add_cached_size (GtkLabel *label,
+                           gint      width,
+                           gint      height,
+                           gint      baseline)
+{
+  GtkLabelPrivate *priv = label->priv;
+  GtkLabelCachedSize *cached;
+
+  if (priv->n_cached_sizes < GTK_LABEL_SIZE_CACHE)
+    cached = &priv->cached_sizes[priv->n_cached_sizes++];
+  else
+    {
+      cached = &priv->cached_sizes[priv->next_cached_size];
+      priv->next_cached_size = (priv->next_cached_size + 1) % GTK_LABEL_SIZE_CACHE;
+    }
+
+  cached->width = width;
+  cached->height = height;
+  cached->baseline = baseline;
+}
+
 static void
 get_size_for_allocation (GtkLabel *label,
                          gint      allocation,
+                         gboolean  clear_layout,
                          gint     *minimum_size,
                          gint     *natural_size,
 			 gint     *minimum_baseline,
@@ -3635,24 +3720,29 @@ get_size_for_allocation (GtkLabel *label,
   PangoLayout *layout;
   gint text_height, baseline;
 
-  layout = gtk_label_get_measuring_layout (label, NULL, allocation * PANGO_SCALE);
-
-  pango_layout_get_pixel_size (layout, NULL, &text_height);
+  if (!gtk_label_lookup_cached_size (label, allocation, &text_height, &baseline))
+    {
+      if (clear_layout)
+        g_clear_object (&label->priv->layout);
 
-  *minimum_size = text_height;
-  *natural_size = text_height;
+      layout = gtk_label_get_measuring_layout (label, NULL, allocation * PANGO_SCALE);
 
-  if (minimum_baseline || natural_baseline)
-    {
+      pango_layout_get_pixel_size (layout, NULL, &text_height);
       baseline = pango_layout_get_baseline (layout) / PANGO_SCALE;
-      if (minimum_baseline)
-	*minimum_baseline = baseline;
 
-      if (natural_baseline)
-	*natural_baseline = baseline;
+      g_object_unref (layout);
+
+      gtk_label_add_cached_size (label, allocation, text_height, baseline);
     }
 
-  g_object_unref (layout);
+  *minimum_size = text_height;
+  *natural_size = text_height;
+
+  if (minimum_baseline)
+    *minimum_baseline = baseline;
+
+  if (natural_baseline)
+    *natural_baseline = baseline;
 }
 
 static gint
@@ -3813,6 +3903,7 @@ gtk_label_get_preferred_size (GtkWidget      *widget,
            */
           get_size_for_allocation (label,
                                    smallest_rect.height,
+                                   FALSE,
                                    minimum_size, natural_size,
 				   NULL, NULL);
 
@@ -3846,6 +3937,7 @@ gtk_label_get_preferred_size (GtkWidget      *widget,
            */
           get_size_for_allocation (label,
                                    widest_rect.width,
+                                   FALSE,
                                    minimum_size, natural_size,
 				   minimum_baseline, natural_baseline);
 
@@ -3892,10 +3984,8 @@ gtk_label_measure (GtkCssGadget   *gadget,
   if ((orientation == GTK_ORIENTATION_VERTICAL && for_size != -1 && priv->wrap && (priv->angle == 0 || priv->angle == 180 || priv->angle == 360)) ||
       (orientation == GTK_ORIENTATION_HORIZONTAL && priv->wrap && (priv->angle == 90 || priv->angle == 270)))
     {
-      if (priv->wrap)
-        gtk_label_clear_layout (label);
-
-      get_size_for_allocation (label, MAX (1, for_size), minimum, natural, minimum_baseline, natural_baseline);
+      get_size_for_allocation (label, MAX (1, for_size), priv->wrap,
+                               minimum, natural, minimum_baseline, natural_baseline);
     }
   else
     gtk_label_get_preferred_size (widget, orientation, minimum, natural, minimum_baseline, natural_baseline);
@@ -4204,7 +4294,10 @@ gtk_label_style_updated (GtkWidget *widget)
 
   if (change == NULL || gtk_css_style_change_affects (change, GTK_CSS_AFFECTS_TEXT_ATTRS) ||
       (priv->select_info && priv->select_info->links))
-    gtk_label_update_layout_attributes (label);
+    {
+      gtk_label_update_layout_attributes (label);
+      gtk_label_clear_cached_sizes (label);
+    }
 }
 
 static PangoDirection
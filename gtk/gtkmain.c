@@ -1609,6 +1609,20 @@ check_event_in_child_popover (GtkWidget *event_widget,
   return (popover_parent == grab_widget || gtk_widget_is_ancestor (popover_parent, grab_widget));
 }
 
+static const char *
+event_type_nick (GdkEventType type)
+{
+  static GEnumClass *enum_class = NULL;
+  GEnumValue *value;
+
+  if (enum_class == NULL)
+    enum_class = g_type_class_ref (GDK_TYPE_EVENT_TYPE);
+
+  value = g_enum_get_value (enum_class, type);
+
+  return value ? value->value_nick : NULL;
+}
+
 /**
  * gtk_main_do_event:
  * @event: An event to process (normally passed by GDK)
@@ -1660,6 +1674,7 @@ gtk_main_do_event (GdkEvent *event)
   GdkEvent *rewritten_event = NULL;
   GdkDevice *device;
   GList *tmp_list;
+  gint64 before = 0;
 
   if (event->type == GDK_SETTING)
     {
@@ -1695,6 +1710,9 @@ gtk_main_do_event (GdkEvent *event)
       return;
     }
 
+  if (GDK_PRIVATE_CALL (gdk_profiler_is_running) ())
+    before = g_get_monotonic_time ();
+
   /* If pointer or keyboard grabs are in effect, munge the events
    * so that each window group looks like a separate app.
    */
@@ -1921,6 +1939,9 @@ gtk_main_do_event (GdkEvent *event)
   current_events = g_list_remove_link (current_events, tmp_list);
   g_list_free_1 (tmp_list);
 
+  if (before != 0)
+    GDK_PRIVATE_CALL (gdk_profiler_end_mark) (before, "event", event_type_nick (event->type));
+
   if (rewritten_event)
     gdk_event_free (rewritten_event);
 }
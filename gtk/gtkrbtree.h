@@ -33,12 +33,14 @@ typedef enum
   GTK_RBNODE_IS_PARENT = 1 << 2,
   GTK_RBNODE_IS_SELECTED = 1 << 3,
   GTK_RBNODE_IS_PRELIT = 1 << 4,
+  GTK_RBNODE_WIDTH_UNMEASURED = 1 << 5,
   GTK_RBNODE_INVALID = 1 << 7,
   GTK_RBNODE_COLUMN_INVALID = 1 << 8,
   GTK_RBNODE_DESCENDANTS_INVALID = 1 << 9,
   GTK_RBNODE_NON_COLORS = GTK_RBNODE_IS_PARENT |
   			  GTK_RBNODE_IS_SELECTED |
   			  GTK_RBNODE_IS_PRELIT |
+                          GTK_RBNODE_WIDTH_UNMEASURED |
                           GTK_RBNODE_INVALID |
                           GTK_RBNODE_COLUMN_INVALID |
                           GTK_RBNODE_DESCENDANTS_INVALID
@@ -1092,6 +1092,50 @@ _gtk_text_btree_delete (GtkTextIter *start,
   gtk_text_btree_resolve_bidi (start, end);
 }
 
+/* Same as pango_find_paragraph_boundary(), but looking at bytes
+ * instead of decoding characters, which matters for large inserts.
+ * This is safe because "\n" and "\r" never occur inside a multibyte
+ * sequence, and 0xE2 is always the lead byte of U+2029.
+ */
+static void
+find_paragraph_boundary (const gchar *text,
+                         gint         length,
+                         gint        *paragraph_delimiter_index,
+                         gint        *next_paragraph_start)
+{
+  const guchar *start = (const guchar *) text;
+  const guchar *end = start + length;
+  const guchar *p;
+
+  for (p = start; p < end; p++)
+    {
+      if (*p == '\n')
+        {
+          *paragraph_delimiter_index = p - start;
+          *next_paragraph_start = p + 1 - start;
+          return;
+        }
+      else if (*p == '\r')
+        {
+          *paragraph_delimiter_index = p - start;
+          if (p + 1 < end && p[1] == '\n')
+            *next_paragraph_start = p + 2 - start;
+          else
+            *next_paragraph_start = p + 1 - start;
+          return;
+        }
+      else if (*p == 0xe2 && p + 2 < end && p[1] == 0x80 && p[2] == 0xa9)
+        {
+          *paragraph_delimiter_index = p - start;
+          *next_paragraph_start = p + 3 - start;
+          return;
+        }
+    }
+
+  *paragraph_delimiter_index = length;
+  *next_paragraph_start = length;
+}
+
 void
 _gtk_text_btree_insert (GtkTextIter *iter,
                         const gchar *text,
@@ -1121,6 +1165,8 @@ _gtk_text_btree_insert (GtkTextIter *iter,
   int char_count_delta;                /* change to number of chars */
   GtkTextBTree *tree;
   gint start_byte_index;
+  gint end_byte_index;                 /* index just after the inserted
+                                        * text in the current line */
   GtkTextLine *start_line;
 
   g_return_if_fail (text != NULL);
@@ -1135,6 +1181,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
   
   start_line = line;
   start_byte_index = gtk_text_iter_get_line_index (iter);
+  end_byte_index = start_byte_index;
 
   /* Get our insertion segment split. Note this assumes line allows
    * char insertions, which isn't true of the "last" line. But iter
@@ -1162,10 +1209,10 @@ _gtk_text_btree_insert (GtkTextIter *iter,
     {
       sol = eol;
       
-      pango_find_paragraph_boundary (text + sol,
-                                     len - sol,
-                                     &delim,
-                                     &eol);      
+      find_paragraph_boundary (text + sol,
+                               len - sol,
+                               &delim,
+                               &eol);
 
       /* make these relative to the start of the text */
       delim += sol;
@@ -1179,10 +1226,14 @@ _gtk_text_btree_insert (GtkTextIter *iter,
       
       chunk_len = eol - sol;
 
-      g_assert (g_utf8_validate (&text[sol], chunk_len, NULL));
+#ifdef G_ENABLE_DEBUG
+      if (GTK_DEBUG_CHECK (TEXT))
+        g_assert (g_utf8_validate (&text[sol], chunk_len, NULL));
+#endif
       seg = _gtk_char_segment_new (&text[sol], chunk_len);
 
       char_count_delta += seg->char_count;
+      end_byte_index += chunk_len;
 
       if (cur_seg == NULL)
         {
@@ -1215,6 +1266,7 @@ _gtk_text_btree_insert (GtkTextIter *iter,
       seg->next = NULL;
       line = newline;
       cur_seg = NULL;
+      end_byte_index = 0;
       line_count_delta++;
     }
 
@@ -1242,12 +1294,10 @@ _gtk_text_btree_insert (GtkTextIter *iter,
                                       &start,
                                       start_line,
                                       start_byte_index);
-    end = start;
-
-    /* We could almost certainly be more efficient here
-       by saving the information from the insertion loop
-       above. FIXME */
-    gtk_text_iter_forward_chars (&end, char_count_delta);
+    _gtk_text_btree_get_iter_at_line (tree,
+                                      &end,
+                                      line,
+                                      end_byte_index);
 
     DV (g_print ("invalidating due to inserting some text (%s)\n", G_STRLOC));
     _gtk_text_btree_invalidate_region (tree, &start, &end, FALSE);
@@ -1807,10 +1857,6 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
 
   tree = _gtk_text_iter_get_btree (&start);
 
-  queue_tag_redisplay (tree, tag, &start, &end);
-
-  info = gtk_text_btree_get_tag_info (tree, tag);
-
   start_line = _gtk_text_iter_get_text_line (&start);
   end_line = _gtk_text_iter_get_text_line (&end);
 
@@ -1836,13 +1882,30 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
   /* We need to traverse the toggles in order. */
   iter_stack_invert (stack);
 
+  toggled_on = gtk_text_iter_has_tag (&start, tag);
+
+  /* If the range is already entirely in the requested state, there
+   * is nothing to do. Highlighters re-apply the same tags to large
+   * regions all the time, so avoid touching the segments and,
+   * more importantly, invalidating the layout for those.
+   */
+  if (stack->count == 0 &&
+      ((add && toggled_on) || (!add && !toggled_on)))
+    {
+      iter_stack_free (stack);
+      return;
+    }
+
+  queue_tag_redisplay (tree, tag, &start, &end);
+
+  info = gtk_text_btree_get_tag_info (tree, tag);
+
   /*
    * See whether the tag is present at the start of the range.  If
    * the state doesn't already match what we want then add a toggle
    * there.
    */
 
-  toggled_on = gtk_text_iter_has_tag (&start, tag);
   if ( (add && !toggled_on) ||
        (!add && toggled_on) )
     {
@@ -2025,6 +2088,215 @@ _gtk_text_btree_tag (const GtkTextIter *start_orig,
 }
 
 
+/* Inserts a toggle for @info at @iter, without adding it to the node
+ * counts; the caller does that in bulk.
+ */
+static void
+insert_uncounted_toggle (const GtkTextIter *iter,
+                         GtkTextTagInfo    *info,
+                         gboolean           on)
+{
+  GtkTextLineSegment *seg, *prev;
+  GtkTextLine *line;
+
+  line = _gtk_text_iter_get_text_line (iter);
+  seg = _gtk_toggle_segment_new (info, on);
+
+  prev = gtk_text_line_segment_split (iter);
+  if (prev == NULL)
+    {
+      seg->next = line->segments;
+      line->segments = seg;
+    }
+  else
+    {
+      seg->next = prev->next;
+      prev->next = seg;
+    }
+
+  seg->body.toggle.inNodeCounts = TRUE;
+}
+
+/**
+ * _gtk_text_btree_tag_spans:
+ * @start: start of the region
+ * @end: end of the region
+ * @tag: the tag
+ * @offsets: pairs of character offsets, relative to @start, of the
+ *   spans @tag should cover; sorted and not overlapping
+ * @n_offsets: number of offsets, twice the number of spans
+ *
+ * Makes @tag cover exactly the given spans between @start and @end.
+ * Unlike calling _gtk_text_btree_tag() for each span, only the places
+ * where the tag actually changes get new toggles, the toggle counts
+ * are updated once per node, and a single redisplay is queued for the
+ * part of the region that changed.
+ */
+void
+_gtk_text_btree_tag_spans (const GtkTextIter *start_orig,
+                           const GtkTextIter *end_orig,
+                           GtkTextTag        *tag,
+                           const gint        *offsets,
+                           guint              n_offsets)
+{
+  GtkTextBTree *tree;
+  GtkTextTagInfo *info;
+  GtkTextIter start, end, iter;
+  GArray *toggles, *changes;
+  GPtrArray *lines;
+  GtkTextBTreeNode *node;
+  gint start_offset, end_offset;
+  gint pos, next, delta;
+  gboolean old_on, new_on;
+  guint t, s, i;
+
+  g_return_if_fail (start_orig != NULL);
+  g_return_if_fail (end_orig != NULL);
+  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (_gtk_text_iter_get_btree (start_orig) ==
+                    _gtk_text_iter_get_btree (end_orig));
+  g_return_if_fail (tag->priv->table == _gtk_text_iter_get_btree (start_orig)->table);
+  g_return_if_fail (n_offsets % 2 == 0);
+
+  start = *start_orig;
+  end = *end_orig;
+  gtk_text_iter_order (&start, &end);
+
+  tree = _gtk_text_iter_get_btree (&start);
+  start_offset = gtk_text_iter_get_offset (&start);
+  end_offset = gtk_text_iter_get_offset (&end);
+
+  /* The existing toggles inside the region, as for _gtk_text_btree_tag() */
+  toggles = g_array_new (FALSE, FALSE, sizeof (gint));
+  iter = start;
+  while (gtk_text_iter_forward_to_tag_toggle (&iter, tag) &&
+         gtk_text_iter_compare (&iter, &end) < 0)
+    {
+      pos = gtk_text_iter_get_offset (&iter);
+      g_array_append_val (toggles, pos);
+    }
+
+  /* Walk the old and the new state together, and note the pieces
+   * where they differ. Within a piece the old state is constant, so
+   * changing it takes a toggle at each end and no deletions. Pieces
+   * are stored as (start, end, on) triplets.
+   */
+  changes = g_array_new (FALSE, FALSE, sizeof (gint));
+  old_on = gtk_text_iter_has_tag (&start, tag);
+  pos = start_offset;
+  t = 0;
+  s = 0;
+
+  while (pos < end_offset)
+    {
+      /* Skip spans that end before @pos */
+      while (s < n_offsets && start_offset + offsets[s + 1] <= pos)
+        s += 2;
+
+      new_on = s < n_offsets && start_offset + offsets[s] <= pos;
+
+      next = end_offset;
+      if (t < toggles->len)
+        next = MIN (next, g_array_index (toggles, gint, t));
+      if (s < n_offsets)
+        next = MIN (next, start_offset + offsets[new_on ? s + 1 : s]);
+
+      g_assert (next > pos);
+
+      if (old_on != new_on)
+        {
+          /* Extend the previous piece if it ends here with the same change */
+          if (changes->len > 0 &&
+              g_array_index (changes, gint, changes->len - 2) == pos &&
+              g_array_index (changes, gint, changes->len - 1) == new_on)
+            {
+              g_array_index (changes, gint, changes->len - 2) = next;
+            }
+          else
+            {
+              g_array_append_val (changes, pos);
+              g_array_append_val (changes, next);
+              g_array_append_val (changes, new_on);
+            }
+        }
+
+      pos = next;
+      if (t < toggles->len && g_array_index (toggles, gint, t) == pos)
+        {
+          old_on = !old_on;
+          t++;
+        }
+    }
+
+  g_array_free (toggles, TRUE);
+
+  if (changes->len == 0)
+    {
+      g_array_free (changes, TRUE);
+      return;
+    }
+
+  info = gtk_text_btree_get_tag_info (tree, tag);
+
+  /* Insert all toggles first, then count them and let cleanup_line()
+   * cancel the ones that meet an existing toggle. The toggles come in
+   * order, so each leaf node is counted once.
+   */
+  lines = g_ptr_array_new ();
+  for (i = 0; i < changes->len; i += 3)
+    {
+      gboolean on = g_array_index (changes, gint, i + 2);
+
+      _gtk_text_btree_get_iter_at_char (tree, &iter, g_array_index (changes, gint, i));
+      insert_uncounted_toggle (&iter, info, on);
+      g_ptr_array_add (lines, _gtk_text_iter_get_text_line (&iter));
+      segments_changed (tree);
+
+      _gtk_text_btree_get_iter_at_char (tree, &iter, g_array_index (changes, gint, i + 1));
+      insert_uncounted_toggle (&iter, info, !on);
+      g_ptr_array_add (lines, _gtk_text_iter_get_text_line (&iter));
+      segments_changed (tree);
+    }
+
+  node = NULL;
+  delta = 0;
+  for (i = 0; i < lines->len; i++)
+    {
+      GtkTextLine *line = g_ptr_array_index (lines, i);
+
+      if (line->parent != node)
+        {
+          if (node != NULL)
+            _gtk_change_node_toggle_count (node, info, delta);
+          node = line->parent;
+          delta = 0;
+        }
+      delta++;
+    }
+  _gtk_change_node_toggle_count (node, info, delta);
+
+  for (i = 0; i < lines->len; i++)
+    {
+      if (i == 0 || g_ptr_array_index (lines, i) != g_ptr_array_index (lines, i - 1))
+        cleanup_line (g_ptr_array_index (lines, i));
+    }
+
+  segments_changed (tree);
+
+  _gtk_text_btree_get_iter_at_char (tree, &start, g_array_index (changes, gint, 0));
+  _gtk_text_btree_get_iter_at_char (tree, &end, g_array_index (changes, gint, changes->len - 2));
+  queue_tag_redisplay (tree, tag, &start, &end);
+
+  g_ptr_array_free (lines, TRUE);
+  g_array_free (changes, TRUE);
+
+#ifdef G_ENABLE_DEBUG
+  if (GTK_DEBUG_CHECK (TEXT))
+    _gtk_text_btree_check (tree);
+#endif
+}
+
+
 /*
  * "Getters"
  */
@@ -5062,6 +5334,58 @@ _gtk_text_btree_is_valid (GtkTextBTree *tree,
   return (nd && nd->valid);
 }
 
+/**
+ * _gtk_text_btree_get_first_invalid_line:
+ * @tree: a #GtkTextBTree
+ * @view_id: view id
+ *
+ * Finds the first line of the tree that is not valid for the given
+ * view.
+ *
+ * Returns: the line, or %NULL if the entire tree is valid.
+ **/
+GtkTextLine *
+_gtk_text_btree_get_first_invalid_line (GtkTextBTree *tree,
+                                        gpointer      view_id)
+{
+  GtkTextBTreeNode *node;
+  GtkTextLine *line;
+
+  g_return_val_if_fail (tree != NULL, NULL);
+
+  if (_gtk_text_btree_is_valid (tree, view_id))
+    return NULL;
+
+  node = tree->root_node;
+  while (node->level > 0)
+    {
+      GtkTextBTreeNode *child;
+
+      for (child = node->children.node; child != NULL; child = child->next)
+        {
+          NodeData *nd = node_data_find (child->node_data, view_id);
+
+          if (!nd || !nd->valid)
+            break;
+        }
+
+      if (child == NULL)
+        return NULL;
+
+      node = child;
+    }
+
+  for (line = node->children.line; line != NULL; line = line->next)
+    {
+      GtkTextLineData *ld = _gtk_text_line_get_data (line, view_id);
+
+      if (!ld || !ld->valid)
+        return line;
+    }
+
+  return NULL;
+}
+
 typedef struct _ValidateState ValidateState;
 
 struct _ValidateState
@@ -98,6 +98,8 @@ void         _gtk_text_btree_get_view_size     (GtkTextBTree      *tree,
                                                 gint              *height);
 gboolean     _gtk_text_btree_is_valid          (GtkTextBTree      *tree,
                                                 gpointer           view_id);
+GtkTextLine *_gtk_text_btree_get_first_invalid_line (GtkTextBTree *tree,
+                                                     gpointer      view_id);
 gboolean     _gtk_text_btree_validate          (GtkTextBTree      *tree,
                                                 gpointer           view_id,
                                                 gint               max_pixels,
@@ -114,6 +116,11 @@ void _gtk_text_btree_tag (const GtkTextIter *start,
                           const GtkTextIter *end,
                           GtkTextTag        *tag,
                           gboolean           apply);
+void _gtk_text_btree_tag_spans (const GtkTextIter *start,
+                                const GtkTextIter *end,
+                                GtkTextTag        *tag,
+                                const gint        *offsets,
+                                guint              n_offsets);
 
 /* "Getters" */
 
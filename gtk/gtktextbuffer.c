@@ -75,6 +75,9 @@ struct _GtkTextBufferPrivate
 
   guint user_action_count;
 
+  gint max_lines;
+  guint trim_idle;
+
   /* Whether the buffer has been modified since last save */
   guint modified : 1;
   guint has_selection : 1;
@@ -119,6 +122,7 @@ enum {
   PROP_CURSOR_POSITION,
   PROP_COPY_TARGET_LIST,
   PROP_PASTE_TARGET_LIST,
+  PROP_MAX_LINES,
   LAST_PROP
 };
 
@@ -281,6 +285,22 @@ gtk_text_buffer_class_init (GtkTextBufferClass *klass)
                           GTK_TYPE_TARGET_LIST,
                           GTK_PARAM_READABLE);
 
+  /**
+   * GtkTextBuffer:max-lines:
+   *
+   * The maximum number of lines to keep in the buffer, or 0 for
+   * no limit. See gtk_text_buffer_set_max_lines().
+   *
+   * Since: 3.22
+   */
+  text_buffer_props[PROP_MAX_LINES] =
+      g_param_spec_int ("max-lines",
+                        P_("Maximum lines"),
+                        P_("Maximum number of lines to keep, dropping the oldest ones"),
+                        0, G_MAXINT,
+                        0,
+                        GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, LAST_PROP, text_buffer_props);
 
   /**
@@ -705,6 +725,10 @@ gtk_text_buffer_set_property (GObject         *object,
 				g_value_get_string (value), -1);
       break;
 
+    case PROP_MAX_LINES:
+      gtk_text_buffer_set_max_lines (text_buffer, g_value_get_int (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -759,6 +783,10 @@ gtk_text_buffer_get_property (GObject         *object,
       g_value_set_boxed (value, gtk_text_buffer_get_paste_target_list (text_buffer));
       break;
 
+    case PROP_MAX_LINES:
+      g_value_set_int (value, text_buffer->priv->max_lines);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -805,6 +833,12 @@ gtk_text_buffer_finalize (GObject *object)
 
   remove_all_selection_clipboards (buffer);
 
+  if (priv->trim_idle != 0)
+    {
+      g_source_remove (priv->trim_idle);
+      priv->trim_idle = 0;
+    }
+
   if (priv->tag_table)
     {
       _gtk_text_tag_table_remove_buffer (priv->tag_table, buffer);
@@ -901,6 +935,66 @@ gtk_text_buffer_set_text (GtkTextBuffer *buffer,
  * Insertion
  */
 
+/* Drops the oldest lines of the buffer so that it has at most
+ * max_lines lines. This is an ordinary deletion, so its cost grows
+ * with the number of segments removed; since every line is removed
+ * at most once, that is bounded by the cost of inserting it.
+ */
+static void
+gtk_text_buffer_trim (GtkTextBuffer *buffer)
+{
+  GtkTextBufferPrivate *priv = buffer->priv;
+  GtkTextIter start, end;
+  gint n_lines;
+
+  if (priv->max_lines <= 0)
+    return;
+
+  n_lines = gtk_text_buffer_get_line_count (buffer);
+  if (n_lines <= priv->max_lines)
+    return;
+
+  gtk_text_buffer_get_start_iter (buffer, &start);
+  gtk_text_buffer_get_iter_at_line (buffer, &end, n_lines - priv->max_lines);
+  gtk_text_buffer_delete (buffer, &start, &end);
+}
+
+static gboolean
+gtk_text_buffer_trim_idle (gpointer data)
+{
+  GtkTextBuffer *buffer = data;
+
+  buffer->priv->trim_idle = 0;
+  gtk_text_buffer_trim (buffer);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Trimming is deferred so that it does not shift offsets under
+ * callers that are still working with the inserted text. The idle
+ * runs before redraws, so everything inserted until the main loop
+ * gets to it is trimmed with a single deletion. That is not tied to
+ * frames: a main loop iteration that only inserts text trims it.
+ * Every insertion path queues it, since any of them can be the one
+ * that grows the buffer past max-lines.
+ */
+static void
+gtk_text_buffer_queue_trim (GtkTextBuffer *buffer)
+{
+  GtkTextBufferPrivate *priv = buffer->priv;
+
+  if (priv->max_lines <= 0 || priv->trim_idle != 0)
+    return;
+
+  if (gtk_text_buffer_get_line_count (buffer) <= priv->max_lines)
+    return;
+
+  priv->trim_idle = gdk_threads_add_idle_full (G_PRIORITY_HIGH_IDLE,
+                                               gtk_text_buffer_trim_idle,
+                                               buffer, NULL);
+  g_source_set_name_by_id (priv->trim_idle, "[gtk+] gtk_text_buffer_trim_idle");
+}
+
 static void
 gtk_text_buffer_real_insert_text (GtkTextBuffer *buffer,
                                   GtkTextIter   *iter,
@@ -914,6 +1008,8 @@ gtk_text_buffer_real_insert_text (GtkTextBuffer *buffer,
 
   g_signal_emit (buffer, signals[CHANGED], 0);
   g_object_notify_by_pspec (G_OBJECT (buffer), text_buffer_props[PROP_CURSOR_POSITION]);
+
+  gtk_text_buffer_queue_trim (buffer);
 }
 
 static void
@@ -1414,6 +1510,8 @@ gtk_text_buffer_real_insert_range (GtkTextBuffer     *buffer,
   
   if (interactive)
     gtk_text_buffer_end_user_action (buffer);
+
+  gtk_text_buffer_queue_trim (buffer);
 }
 
 /**
@@ -1918,6 +2016,8 @@ gtk_text_buffer_real_insert_pixbuf (GtkTextBuffer *buffer,
   _gtk_text_btree_insert_pixbuf (iter, pixbuf);
 
   g_signal_emit (buffer, signals[CHANGED], 0);
+
+  gtk_text_buffer_queue_trim (buffer);
 }
 
 /**
@@ -1962,6 +2062,8 @@ gtk_text_buffer_real_insert_anchor (GtkTextBuffer      *buffer,
   _gtk_text_btree_insert_child_anchor (iter, anchor);
 
   g_signal_emit (buffer, signals[CHANGED], 0);
+
+  gtk_text_buffer_queue_trim (buffer);
 }
 
 /**
@@ -2747,6 +2849,62 @@ gtk_text_buffer_remove_tag_by_name (GtkTextBuffer     *buffer,
   gtk_text_buffer_emit_tag (buffer, tag, FALSE, start, end);
 }
 
+/**
+ * gtk_text_buffer_set_tag_spans:
+ * @buffer: a #GtkTextBuffer
+ * @tag: a #GtkTextTag
+ * @start: one bound of the region
+ * @end: other bound of the region
+ * @offsets: (array length=n_offsets): pairs of character offsets,
+ *   relative to the start of the region, of the spans to tag
+ * @n_offsets: the number of offsets, twice the number of spans
+ *
+ * Makes @tag cover exactly the given spans of the region between
+ * @start and @end, and nothing else in it. The spans must be sorted
+ * and must not overlap; a span from 2 to 5 covers the characters
+ * at offsets 2, 3 and 4 of the region.
+ *
+ * This is meant for syntax highlighters, which recompute the spans
+ * of each tag for a region after every edit, and most of them don’t
+ * change. It has the same effect as removing @tag from the region
+ * and applying it to each span, but only the places where @tag
+ * changes are touched, and the region is redrawn once.
+ *
+ * Unlike gtk_text_buffer_apply_tag() and gtk_text_buffer_remove_tag(),
+ * this does not emit the #GtkTextBuffer::apply-tag or
+ * #GtkTextBuffer::remove-tag signals.
+ *
+ * Since: 3.22
+ **/
+void
+gtk_text_buffer_set_tag_spans (GtkTextBuffer     *buffer,
+                               GtkTextTag        *tag,
+                               const GtkTextIter *start,
+                               const GtkTextIter *end,
+                               const gint        *offsets,
+                               gint               n_offsets)
+{
+  gint i;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (GTK_IS_TEXT_TAG (tag));
+  g_return_if_fail (start != NULL);
+  g_return_if_fail (end != NULL);
+  g_return_if_fail (gtk_text_iter_get_buffer (start) == buffer);
+  g_return_if_fail (gtk_text_iter_get_buffer (end) == buffer);
+  g_return_if_fail (tag->priv->table == buffer->priv->tag_table);
+  g_return_if_fail (offsets != NULL || n_offsets == 0);
+  g_return_if_fail (n_offsets >= 0 && n_offsets % 2 == 0);
+
+  for (i = 0; i < n_offsets; i++)
+    {
+      g_return_if_fail (offsets[i] >= 0);
+      g_return_if_fail (i == 0 || offsets[i] >= offsets[i - 1]);
+    }
+
+  _gtk_text_btree_tag_spans (start, end, tag, offsets, n_offsets);
+}
+
 static gint
 pointer_cmp (gconstpointer a,
              gconstpointer b)
@@ -3182,6 +3340,65 @@ gtk_text_buffer_get_char_count (GtkTextBuffer *buffer)
   return _gtk_text_btree_char_count (get_btree (buffer));
 }
 
+/**
+ * gtk_text_buffer_set_max_lines:
+ * @buffer: a #GtkTextBuffer
+ * @max_lines: the maximum number of lines, or 0 for no limit
+ *
+ * Limits the number of lines kept in @buffer, as counted by
+ * gtk_text_buffer_get_line_count(). When text is inserted and the
+ * buffer grows beyond @max_lines, the oldest lines are deleted
+ * from the start of the buffer. This is useful for log views that
+ * keep appending text.
+ *
+ * The deletion happens shortly after the insertion, from an idle
+ * handler that runs before the next redraw, so that insertions made
+ * in between are trimmed together. It is a normal deletion: it emits
+ * #GtkTextBuffer::delete-range, and takes time proportional to the
+ * amount of text that is removed.
+ *
+ * Since: 3.22
+ **/
+void
+gtk_text_buffer_set_max_lines (GtkTextBuffer *buffer,
+                               gint           max_lines)
+{
+  GtkTextBufferPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TEXT_BUFFER (buffer));
+  g_return_if_fail (max_lines >= 0);
+
+  priv = buffer->priv;
+
+  if (priv->max_lines == max_lines)
+    return;
+
+  priv->max_lines = max_lines;
+
+  gtk_text_buffer_trim (buffer);
+
+  g_object_notify_by_pspec (G_OBJECT (buffer), text_buffer_props[PROP_MAX_LINES]);
+}
+
+/**
+ * gtk_text_buffer_get_max_lines:
+ * @buffer: a #GtkTextBuffer
+ *
+ * Returns the maximum number of lines set with
+ * gtk_text_buffer_set_max_lines().
+ *
+ * Returns: the maximum number of lines, or 0 if there is no limit
+ *
+ * Since: 3.22
+ **/
+gint
+gtk_text_buffer_get_max_lines (GtkTextBuffer *buffer)
+{
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (buffer), 0);
+
+  return buffer->priv->max_lines;
+}
+
 /* Called when we lose the primary selection.
  */
 static void
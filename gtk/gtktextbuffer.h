@@ -175,6 +175,12 @@ gint           gtk_text_buffer_get_line_count (GtkTextBuffer   *buffer);
 GDK_AVAILABLE_IN_ALL
 gint           gtk_text_buffer_get_char_count (GtkTextBuffer   *buffer);
 
+GDK_AVAILABLE_IN_3_22
+void           gtk_text_buffer_set_max_lines  (GtkTextBuffer   *buffer,
+                                               gint             max_lines);
+GDK_AVAILABLE_IN_3_22
+gint           gtk_text_buffer_get_max_lines  (GtkTextBuffer   *buffer);
+
 
 GDK_AVAILABLE_IN_ALL
 GtkTextTagTable* gtk_text_buffer_get_tag_table (GtkTextBuffer  *buffer);
@@ -358,6 +364,13 @@ GDK_AVAILABLE_IN_ALL
 void gtk_text_buffer_remove_all_tags       (GtkTextBuffer     *buffer,
                                             const GtkTextIter *start,
                                             const GtkTextIter *end);
+GDK_AVAILABLE_IN_3_22
+void gtk_text_buffer_set_tag_spans         (GtkTextBuffer     *buffer,
+                                            GtkTextTag        *tag,
+                                            const GtkTextIter *start,
+                                            const GtkTextIter *end,
+                                            const gint        *offsets,
+                                            gint               n_offsets);
 
 
 /* You can either ignore the return value, or use it to
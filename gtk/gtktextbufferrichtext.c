@@ -513,6 +513,96 @@ gtk_text_buffer_serialize (GtkTextBuffer     *register_buffer,
   return NULL;
 }
 
+/**
+ * gtk_text_buffer_serialize_to_stream:
+ * @register_buffer: the #GtkTextBuffer @format is registered with
+ * @content_buffer: the #GtkTextBuffer to serialize
+ * @format: the rich text format to use for serializing
+ * @start: start of block of text to serialize
+ * @end: end of block of test to serialize
+ * @stream: the #GOutputStream to write to
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: return location for a #GError
+ *
+ * Like gtk_text_buffer_serialize(), but writes the serialized data
+ * to @stream.
+ *
+ * For formats registered with gtk_text_buffer_register_serialize_tagset(),
+ * the data is written as it is produced, so the whole serialized text
+ * is never held in memory at once. For other formats, the serialize
+ * function is called and its result is written to @stream.
+ *
+ * Returns: %TRUE on success, %FALSE if an error occurred
+ *
+ * Since: 3.22
+ **/
+gboolean
+gtk_text_buffer_serialize_to_stream (GtkTextBuffer      *register_buffer,
+                                     GtkTextBuffer      *content_buffer,
+                                     GdkAtom             format,
+                                     const GtkTextIter  *start,
+                                     const GtkTextIter  *end,
+                                     GOutputStream      *stream,
+                                     GCancellable       *cancellable,
+                                     GError            **error)
+{
+  GList *formats;
+  GList *list;
+
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (register_buffer), FALSE);
+  g_return_val_if_fail (GTK_IS_TEXT_BUFFER (content_buffer), FALSE);
+  g_return_val_if_fail (format != GDK_NONE, FALSE);
+  g_return_val_if_fail (start != NULL, FALSE);
+  g_return_val_if_fail (end != NULL, FALSE);
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  formats = g_object_get_qdata (G_OBJECT (register_buffer),
+                                serialize_quark ());
+
+  for (list = formats; list; list = list->next)
+    {
+      GtkRichTextFormat *fmt = list->data;
+
+      if (fmt->atom == format)
+        {
+          GtkTextBufferSerializeFunc function = fmt->function;
+          guint8 *data;
+          gsize length;
+          gboolean success;
+
+          if (function == _gtk_text_buffer_serialize_rich_text)
+            return _gtk_text_buffer_serialize_rich_text_to_stream (register_buffer,
+                                                                   content_buffer,
+                                                                   start, end,
+                                                                   stream,
+                                                                   cancellable,
+                                                                   error);
+
+          length = 0;
+          data = function (register_buffer, content_buffer,
+                           start, end, &length, fmt->user_data);
+          if (data == NULL)
+            {
+              g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                   _("Failed to serialize the text"));
+              return FALSE;
+            }
+
+          success = g_output_stream_write_all (stream, data, length, NULL,
+                                               cancellable, error);
+          g_free (data);
+
+          return success;
+        }
+    }
+
+  g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                       _("The rich text format is not registered"));
+
+  return FALSE;
+}
+
 /**
  * gtk_text_buffer_deserialize:
  * @register_buffer: the #GtkTextBuffer @format is registered with
@@ -124,6 +124,15 @@ guint8  * gtk_text_buffer_serialize                   (GtkTextBuffer
                                                        const GtkTextIter            *start,
                                                        const GtkTextIter            *end,
                                                        gsize                        *length);
+GDK_AVAILABLE_IN_3_22
+gboolean  gtk_text_buffer_serialize_to_stream         (GtkTextBuffer                *register_buffer,
+                                                       GtkTextBuffer                *content_buffer,
+                                                       GdkAtom                       format,
+                                                       const GtkTextIter            *start,
+                                                       const GtkTextIter            *end,
+                                                       GOutputStream                *stream,
+                                                       GCancellable                 *cancellable,
+                                                       GError                      **error);
 GDK_AVAILABLE_IN_ALL
 gboolean  gtk_text_buffer_deserialize                 (GtkTextBuffer                *register_buffer,
                                                        GtkTextBuffer                *content_buffer,
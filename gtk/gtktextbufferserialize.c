@@ -36,8 +36,13 @@
 
 typedef struct
 {
-  GString *tag_table_str;
-  GString *text_str;
+  GString *str;
+  /* When writing to a stream, str only holds what wasn't written yet */
+  GOutputStream *stream;
+  GCancellable *cancellable;
+  GError *error;
+  gboolean counting;            /* count the bytes instead of writing them */
+  gsize flushed;
   GHashTable *tags;
   GtkTextIter start, end;
 
@@ -292,23 +297,23 @@ serialize_tag (gpointer key,
   guint n_pspecs;
   int i;
 
-  g_string_append (context->tag_table_str, "  <tag ");
+  g_string_append (context->str, "  <tag ");
 
   /* Handle anonymous tags */
   if (tag->priv->name)
     {
       tag_name = g_markup_escape_text (tag->priv->name, -1);
-      g_string_append_printf (context->tag_table_str, "name=\"%s\"", tag_name);
+      g_string_append_printf (context->str, "name=\"%s\"", tag_name);
       g_free (tag_name);
     }
   else
     {
       tag_id = GPOINTER_TO_INT (g_hash_table_lookup (context->tag_id_tags, tag));
 
-      g_string_append_printf (context->tag_table_str, "id=\"%d\"", tag_id);
+      g_string_append_printf (context->str, "id=\"%d\"", tag_id);
     }
 
-  g_string_append_printf (context->tag_table_str, " priority=\"%d\">\n", tag->priv->priority);
+  g_string_append_printf (context->str, " priority=\"%d\">\n", tag->priv->priority);
 
   /* Serialize properties */
   pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (tag), &n_pspecs);
@@ -331,11 +336,11 @@ serialize_tag (gpointer key,
       if (tmp2)
 	{
 	  tmp = g_markup_escape_text (pspecs[i]->name, -1);
-	  g_string_append_printf (context->tag_table_str, "   <attr name=\"%s\" ", tmp);
+	  g_string_append_printf (context->str, "   <attr name=\"%s\" ", tmp);
 	  g_free (tmp);
 
 	  tmp = g_markup_escape_text (g_type_name (pspecs[i]->value_type), -1);
-	  g_string_append_printf (context->tag_table_str, "type=\"%s\" value=\"%s\" />\n", tmp, tmp2);
+	  g_string_append_printf (context->str, "type=\"%s\" value=\"%s\" />\n", tmp, tmp2);
 
 	  g_free (tmp);
 	  g_free (tmp2);
@@ -346,16 +351,56 @@ serialize_tag (gpointer key,
 
   g_free (pspecs);
 
-  g_string_append (context->tag_table_str, "  </tag>\n");
+  g_string_append (context->str, "  </tag>\n");
 }
 
 static void
 serialize_tags (SerializationContext *context)
 {
-  g_string_append (context->tag_table_str, " <text_view_markup>\n");
-  g_string_append (context->tag_table_str, " <tags>\n");
+  g_string_append (context->str, " <text_view_markup>\n");
+  g_string_append (context->str, " <tags>\n");
   g_hash_table_foreach (context->tags, serialize_tag, context);
-  g_string_append (context->tag_table_str, " </tags>\n");
+  g_string_append (context->str, " </tags>\n");
+}
+
+static void
+collect_tag (SerializationContext *context,
+             GtkTextTag           *tag)
+{
+  g_hash_table_insert (context->tags, tag, tag);
+
+  if (!tag->priv->name &&
+      !g_hash_table_contains (context->tag_id_tags, tag))
+    g_hash_table_insert (context->tag_id_tags, tag,
+                         GINT_TO_POINTER (context->tag_id++));
+}
+
+/* Finds all tags used in the range by jumping from toggle to toggle,
+ * so that the tag table can be written before the text without having
+ * to keep the serialized text in a separate buffer.
+ */
+static void
+collect_tags (SerializationContext *context)
+{
+  GtkTextIter iter;
+  GSList *tags, *l;
+
+  iter = context->start;
+  tags = gtk_text_iter_get_tags (&iter);
+
+  while (TRUE)
+    {
+      for (l = tags; l; l = l->next)
+        collect_tag (context, l->data);
+
+      g_slist_free (tags);
+
+      if (!gtk_text_iter_forward_to_tag_toggle (&iter, NULL) ||
+          gtk_text_iter_compare (&iter, &context->end) >= 0)
+        break;
+
+      tags = gtk_text_iter_get_toggled_tags (&iter, TRUE);
+    }
 }
 
 static void
@@ -412,6 +457,74 @@ serialize_section_header (GString     *str,
   g_string_append_c (str, length & 0xff);
 }
 
+static void
+serialize_section_length (GString *str,
+                          gsize    header_pos,
+                          gint     length)
+{
+  str->str[header_pos + 26] = length >> 24;
+  str->str[header_pos + 27] = (length >> 16) & 0xff;
+  str->str[header_pos + 28] = (length >> 8) & 0xff;
+  str->str[header_pos + 29] = length & 0xff;
+}
+
+/* Number of characters escaped at a time, to avoid making
+ * two extra copies of long runs of untagged text.
+ */
+#define SERIALIZE_CHUNK_CHARS 4096
+
+/* Amount of output kept before it is written to the stream */
+#define SERIALIZE_FLUSH_SIZE (64 * 1024)
+
+static void
+serialize_flush (SerializationContext *context,
+                 gsize                 min_size)
+{
+  if (context->stream == NULL ||
+      context->str->len == 0 ||
+      context->str->len < min_size)
+    return;
+
+  if (!context->counting && context->error == NULL)
+    g_output_stream_write_all (context->stream,
+                               context->str->str, context->str->len,
+                               NULL,
+                               context->cancellable, &context->error);
+
+  context->flushed += context->str->len;
+  g_string_truncate (context->str, 0);
+}
+
+static void
+serialize_slice (SerializationContext *context,
+                 const GtkTextIter    *start,
+                 const GtkTextIter    *end)
+{
+  GtkTextIter iter, chunk_end;
+  gchar *tmp_text, *escaped_text;
+
+  iter = *start;
+
+  while (gtk_text_iter_compare (&iter, end) < 0)
+    {
+      chunk_end = iter;
+      if (!gtk_text_iter_forward_chars (&chunk_end, SERIALIZE_CHUNK_CHARS) ||
+          gtk_text_iter_compare (&chunk_end, end) > 0)
+        chunk_end = *end;
+
+      tmp_text = gtk_text_iter_get_slice (&iter, &chunk_end);
+      escaped_text = g_markup_escape_text (tmp_text, -1);
+      g_free (tmp_text);
+
+      g_string_append (context->str, escaped_text);
+      g_free (escaped_text);
+
+      serialize_flush (context, SERIALIZE_FLUSH_SIZE);
+
+      iter = chunk_end;
+    }
+}
+
 static void
 serialize_text (GtkTextBuffer        *buffer,
                 SerializationContext *context)
@@ -420,7 +533,7 @@ serialize_text (GtkTextBuffer        *buffer,
   GSList *tag_list, *new_tag_list;
   GSList *active_tags;
 
-  g_string_append (context->text_str, "<text>");
+  g_string_append (context->str, "<text>");
 
   iter = context->start;
   tag_list = NULL;
@@ -430,7 +543,6 @@ serialize_text (GtkTextBuffer        *buffer,
     {
       GList *added, *removed;
       GList *tmp;
-      gchar *tmp_text, *escaped_text;
 
       new_tag_list = gtk_text_iter_get_tags (&iter);
       find_list_delta (tag_list, new_tag_list, &added, &removed);
@@ -445,7 +557,7 @@ serialize_text (GtkTextBuffer        *buffer,
            */
           if (g_slist_find (active_tags, tag))
             {
-              g_string_append (context->text_str, "</apply_tag>");
+              g_string_append (context->str, "</apply_tag>");
 
               /* Drop all tags that were opened after this one (which are
                * above this on in the stack)
@@ -454,7 +566,7 @@ serialize_text (GtkTextBuffer        *buffer,
                 {
                   added = g_list_prepend (added, active_tags->data);
                   active_tags = g_slist_remove (active_tags, active_tags->data);
-                  g_string_append_printf (context->text_str, "</apply_tag>");
+                  g_string_append_printf (context->str, "</apply_tag>");
                 }
 
               active_tags = g_slist_remove (active_tags, active_tags->data);
@@ -467,30 +579,21 @@ serialize_text (GtkTextBuffer        *buffer,
 	  GtkTextTag *tag = tmp->data;
 	  gchar *tag_name;
 
-	  /* Add it to the tag hash table */
-	  g_hash_table_insert (context->tags, tag, tag);
-
 	  if (tag->priv->name)
 	    {
 	      tag_name = g_markup_escape_text (tag->priv->name, -1);
 
-	      g_string_append_printf (context->text_str, "<apply_tag name=\"%s\">", tag_name);
+	      g_string_append_printf (context->str, "<apply_tag name=\"%s\">", tag_name);
 	      g_free (tag_name);
 	    }
 	  else
 	    {
 	      gpointer tag_id;
 
-	      /* We've got an anonymous tag, find out if it's been
-		 used before */
-	      if (!g_hash_table_lookup_extended (context->tag_id_tags, tag, NULL, &tag_id))
-		{
-		  tag_id = GINT_TO_POINTER (context->tag_id++);
-
-		  g_hash_table_insert (context->tag_id_tags, tag, tag_id);
-		}
+	      /* Anonymous tags got their id in collect_tags() */
+	      tag_id = g_hash_table_lookup (context->tag_id_tags, tag);
 
-	      g_string_append_printf (context->text_str, "<apply_tag id=\"%d\">", GPOINTER_TO_INT (tag_id));
+	      g_string_append_printf (context->str, "<apply_tag id=\"%d\">", GPOINTER_TO_INT (tag_id));
 	    }
 
 	  active_tags = g_slist_prepend (active_tags, tag);
@@ -516,18 +619,13 @@ serialize_text (GtkTextBuffer        *buffer,
 	      if (pixbuf)
 		{
 		  /* Append the text before the pixbuf */
-		  tmp_text = gtk_text_iter_get_slice (&old_iter, &iter);
-		  escaped_text = g_markup_escape_text (tmp_text, -1);
-		  g_free (tmp_text);
+		  serialize_slice (context, &old_iter, &iter);
 
 		  /* Forward so we don't get the 0xfffc char */
 		  gtk_text_iter_forward_char (&iter);
 		  old_iter = iter;
 
-		  g_string_append (context->text_str, escaped_text);
-		  g_free (escaped_text);
-
-		  g_string_append_printf (context->text_str, "<pixbuf index=\"%d\" />", context->n_pixbufs);
+		  g_string_append_printf (context->str, "<pixbuf index=\"%d\" />", context->n_pixbufs);
 
 		  context->n_pixbufs++;
 		  context->pixbufs = g_list_prepend (context->pixbufs, pixbuf);
@@ -549,29 +647,25 @@ serialize_text (GtkTextBuffer        *buffer,
 	iter = context->end;
 
       /* Append the text */
-      tmp_text = gtk_text_iter_get_slice (&old_iter, &iter);
-      escaped_text = g_markup_escape_text (tmp_text, -1);
-      g_free (tmp_text);
+      serialize_slice (context, &old_iter, &iter);
 
-      g_string_append (context->text_str, escaped_text);
-      g_free (escaped_text);
+      serialize_flush (context, SERIALIZE_FLUSH_SIZE);
     }
-  while (!gtk_text_iter_equal (&iter, &context->end));
+  while (!gtk_text_iter_equal (&iter, &context->end) && context->error == NULL);
 
   g_slist_free (tag_list);
 
   /* Close any open tags */
   for (tag_list = active_tags; tag_list; tag_list = tag_list->next)
-    g_string_append (context->text_str, "</apply_tag>");
+    g_string_append (context->str, "</apply_tag>");
 
   g_slist_free (active_tags);
-  g_string_append (context->text_str, "</text>\n</text_view_markup>\n");
+  g_string_append (context->str, "</text>\n</text_view_markup>\n");
 }
 
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 static void
-serialize_pixbufs (SerializationContext *context,
-		   GString              *text)
+serialize_pixbufs (SerializationContext *context)
 {
   GList *list;
 
@@ -585,9 +679,11 @@ serialize_pixbufs (SerializationContext *context,
       gdk_pixdata_from_pixbuf (&pixdata, pixbuf, FALSE);
       tmp = gdk_pixdata_serialize (&pixdata, &len);
 
-      serialize_section_header (text, "GTKTEXTBUFFERPIXBDATA-0001", len);
-      g_string_append_len (text, (gchar *) tmp, len);
+      serialize_section_header (context->str, "GTKTEXTBUFFERPIXBDATA-0001", len);
+      g_string_append_len (context->str, (gchar *) tmp, len);
       g_free (tmp);
+
+      serialize_flush (context, 0);
     }
 }
 G_GNUC_END_IGNORE_DEPRECATIONS
@@ -603,9 +699,11 @@ _gtk_text_buffer_serialize_rich_text (GtkTextBuffer     *register_buffer,
   SerializationContext context;
   GString *text;
 
+  text = g_string_new (NULL);
+
+  memset (&context, 0, sizeof (context));
   context.tags = g_hash_table_new (NULL, NULL);
-  context.text_str = g_string_new (NULL);
-  context.tag_table_str = g_string_new (NULL);
+  context.str = text;
   context.start = *start;
   context.end = *end;
   context.n_pixbufs = 0;
@@ -613,30 +711,88 @@ _gtk_text_buffer_serialize_rich_text (GtkTextBuffer     *register_buffer,
   context.tag_id = 0;
   context.tag_id_tags = g_hash_table_new (NULL, NULL);
 
-  /* We need to serialize the text before the tag table so we know
-     what tags are used */
+  /* The tag table comes first, so find out which tags are used
+   * before writing anything. The length of the section is filled
+   * in once the text has been written.
+   */
+  collect_tags (&context);
+
+  serialize_section_header (text, "GTKTEXTBUFFERCONTENTS-0001", 0);
+  serialize_tags (&context);
   serialize_text (content_buffer, &context);
+  serialize_section_length (text, 0, text->len - 30);
+
+  context.pixbufs = g_list_reverse (context.pixbufs);
+  serialize_pixbufs (&context);
+
+  g_hash_table_destroy (context.tags);
+  g_list_free (context.pixbufs);
+  g_hash_table_destroy (context.tag_id_tags);
+
+  *length = text->len;
+
+  return (guint8 *) g_string_free (text, FALSE);
+}
+
+/* Writes the same data as _gtk_text_buffer_serialize_rich_text() to
+ * @stream, holding at most about SERIALIZE_FLUSH_SIZE bytes of it at a
+ * time. The length of the text section comes before it, so the text
+ * is serialized twice, the first time only counting the bytes.
+ */
+gboolean
+_gtk_text_buffer_serialize_rich_text_to_stream (GtkTextBuffer     *register_buffer,
+                                                GtkTextBuffer     *content_buffer,
+                                                const GtkTextIter *start,
+                                                const GtkTextIter *end,
+                                                GOutputStream     *stream,
+                                                GCancellable      *cancellable,
+                                                GError           **error)
+{
+  SerializationContext context;
+  gsize length;
+
+  memset (&context, 0, sizeof (context));
+  context.tags = g_hash_table_new (NULL, NULL);
+  context.str = g_string_sized_new (SERIALIZE_FLUSH_SIZE);
+  context.stream = stream;
+  context.cancellable = cancellable;
+  context.start = *start;
+  context.end = *end;
+  context.tag_id_tags = g_hash_table_new (NULL, NULL);
+
+  collect_tags (&context);
+
+  context.counting = TRUE;
   serialize_tags (&context);
+  serialize_text (content_buffer, &context);
+  serialize_flush (&context, 0);
+  length = context.flushed;
 
-  text = g_string_new (NULL);
-  serialize_section_header (text, "GTKTEXTBUFFERCONTENTS-0001",
-                            context.tag_table_str->len + context.text_str->len);
+  context.counting = FALSE;
+  context.n_pixbufs = 0;
+  g_list_free (context.pixbufs);
+  context.pixbufs = NULL;
 
-  g_string_append_len (text, context.tag_table_str->str, context.tag_table_str->len);
-  g_string_append_len (text, context.text_str->str, context.text_str->len);
+  serialize_section_header (context.str, "GTKTEXTBUFFERCONTENTS-0001", length);
+  serialize_tags (&context);
+  serialize_text (content_buffer, &context);
+  serialize_flush (&context, 0);
 
   context.pixbufs = g_list_reverse (context.pixbufs);
-  serialize_pixbufs (&context, text);
+  serialize_pixbufs (&context);
 
   g_hash_table_destroy (context.tags);
   g_list_free (context.pixbufs);
-  g_string_free (context.text_str, TRUE);
-  g_string_free (context.tag_table_str, TRUE);
   g_hash_table_destroy (context.tag_id_tags);
+  g_string_free (context.str, TRUE);
 
-  *length = text->len;
+  if (context.error)
+    {
+      g_propagate_error (error, context.error);
+      return FALSE;
+    }
 
-  return (guint8 *) g_string_free (text, FALSE);
+  return TRUE;
 }
 
 typedef enum
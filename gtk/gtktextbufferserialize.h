@@ -28,6 +28,14 @@ guint8 * _gtk_text_buffer_serialize_rich_text   (GtkTextBuffer     *register_buf
                                                  gsize             *length,
                                                  gpointer           user_data);
 
+gboolean _gtk_text_buffer_serialize_rich_text_to_stream (GtkTextBuffer     *register_buffer,
+                                                         GtkTextBuffer     *content_buffer,
+                                                         const GtkTextIter *start,
+                                                         const GtkTextIter *end,
+                                                         GOutputStream     *stream,
+                                                         GCancellable      *cancellable,
+                                                         GError           **error);
+
 gboolean _gtk_text_buffer_deserialize_rich_text (GtkTextBuffer     *register_buffer,
                                                  GtkTextBuffer     *content_buffer,
                                                  GtkTextIter       *iter,
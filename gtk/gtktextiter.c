@@ -4906,6 +4906,349 @@ strbreakup (const char *string,
   return str_array;
 }
 
+/* Fast path for the common case of searching for a string that does
+ * not span lines, ignoring visibility. The text of each line is copied
+ * from its char segments into a reusable buffer and scanned with a
+ * Boyer-Moore-Horspool search, instead of building a slice and
+ * normalizing it for every line. Lines containing pixbufs or child
+ * anchors, and non-ASCII lines in a case-insensitive search, are left
+ * to the generic code so that the results are the same.
+ */
+typedef struct
+{
+  gchar *needle;
+  gsize  len;
+  gsize  skip[256];
+  guint  fold : 1;
+} FastSearch;
+
+static gboolean
+fast_search_possible (const gchar        *str,
+                      GtkTextSearchFlags  flags)
+{
+  const gchar *p;
+
+  if ((flags & GTK_TEXT_SEARCH_VISIBLE_ONLY) != 0)
+    return FALSE;
+
+  for (p = str; *p; p++)
+    {
+      if (*p == '\n')
+        return FALSE;
+
+      if ((flags & GTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0 &&
+          (guchar) *p >= 0x80)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+fast_search_init (FastSearch  *fs,
+                  const gchar *str,
+                  gboolean     fold)
+{
+  gsize i;
+
+  fs->fold = fold;
+  fs->len = strlen (str);
+  fs->needle = fold ? g_ascii_strdown (str, -1) : g_strdup (str);
+
+  for (i = 0; i < G_N_ELEMENTS (fs->skip); i++)
+    fs->skip[i] = fs->len;
+
+  for (i = 0; i + 1 < fs->len; i++)
+    {
+      guchar c = fs->needle[i];
+
+      fs->skip[c] = fs->len - 1 - i;
+      if (fold)
+        fs->skip[g_ascii_toupper (c)] = fs->len - 1 - i;
+    }
+}
+
+static void
+fast_search_clear (FastSearch *fs)
+{
+  g_free (fs->needle);
+}
+
+/* Returns the byte offset of the first match at or after @from that
+ * ends at or before @text_len, or -1.
+ */
+static gssize
+fast_search_find (const FastSearch *fs,
+                  const gchar      *text,
+                  gsize             text_len,
+                  gsize             from)
+{
+  const guchar *t = (const guchar *) text;
+  gsize pos;
+
+  for (pos = from; pos + fs->len <= text_len; pos += fs->skip[t[pos + fs->len - 1]])
+    {
+      gsize i = fs->len;
+
+      if (fs->fold)
+        {
+          while (i > 0 && g_ascii_tolower (t[pos + i - 1]) == (guchar) fs->needle[i - 1])
+            i--;
+        }
+      else
+        {
+          while (i > 0 && t[pos + i - 1] == (guchar) fs->needle[i - 1])
+            i--;
+        }
+
+      if (i == 0)
+        return pos;
+    }
+
+  return -1;
+}
+
+/* Copies the text of @line into @text. Returns %FALSE if the line
+ * has to be searched by the generic code.
+ */
+static gboolean
+fast_search_get_line_text (const FastSearch *fs,
+                           GtkTextLine      *line,
+                           GString          *text)
+{
+  GtkTextLineSegment *seg;
+  gsize i;
+
+  g_string_truncate (text, 0);
+
+  for (seg = line->segments; seg != NULL; seg = seg->next)
+    {
+      if (seg->type == &gtk_text_char_type)
+        g_string_append_len (text, seg->body.chars, seg->byte_count);
+      else if (seg->char_count > 0)
+        return FALSE;
+    }
+
+  if (fs->fold)
+    {
+      for (i = 0; i < text->len; i++)
+        {
+          if ((guchar) text->str[i] >= 0x80)
+            return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+static gboolean
+fast_forward_search (const GtkTextIter *iter,
+                     const gchar       *str,
+                     GtkTextSearchFlags flags,
+                     GtkTextIter       *match_start,
+                     GtkTextIter       *match_end,
+                     const GtkTextIter *limit)
+{
+  GtkTextBTree *tree;
+  GtkTextLine *line;
+  GtkTextLine *limit_line;
+  gint limit_index;
+  gint from;
+  FastSearch fs;
+  const gchar *lines[2];
+  GString *text;
+  gboolean slice;
+  gboolean case_insensitive;
+  gboolean retval = FALSE;
+
+  slice = (flags & GTK_TEXT_SEARCH_TEXT_ONLY) == 0;
+  case_insensitive = (flags & GTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0;
+
+  fast_search_init (&fs, str, case_insensitive);
+  lines[0] = fs.needle;
+  lines[1] = NULL;
+
+  tree = _gtk_text_iter_get_btree (iter);
+  limit_line = limit ? _gtk_text_iter_get_text_line (limit) : NULL;
+  limit_index = limit ? gtk_text_iter_get_line_index (limit) : 0;
+  text = g_string_new (NULL);
+
+  for (line = _gtk_text_iter_get_text_line (iter), from = gtk_text_iter_get_line_index (iter);
+       line != NULL;
+       line = _gtk_text_line_next_excluding_last (line), from = 0)
+    {
+      GtkTextIter start, end;
+      gboolean found;
+
+      /* The line starts at the limit */
+      if (line == limit_line && limit_index == 0)
+        break;
+
+      if (fast_search_get_line_text (&fs, line, text))
+        {
+          gssize pos;
+
+          pos = fast_search_find (&fs, text->str, text->len, from);
+          found = pos >= 0;
+          if (found)
+            {
+              _gtk_text_btree_get_iter_at_line (tree, &start, line, pos);
+              _gtk_text_btree_get_iter_at_line (tree, &end, line, pos + fs.len);
+            }
+        }
+      else
+        {
+          GtkTextIter search;
+
+          _gtk_text_btree_get_iter_at_line (tree, &search, line, from);
+          found = lines_match (&search, lines, FALSE, slice, case_insensitive,
+                               &start, &end);
+        }
+
+      if (found)
+        {
+          if (limit == NULL ||
+              gtk_text_iter_compare (&end, limit) <= 0)
+            {
+              retval = TRUE;
+
+              if (match_start)
+                *match_start = start;
+
+              if (match_end)
+                *match_end = end;
+            }
+
+          break;
+        }
+
+      if (line == limit_line)
+        break;
+    }
+
+  g_string_free (text, TRUE);
+  fast_search_clear (&fs);
+
+  return retval;
+}
+
+static gboolean
+fast_backward_search (const GtkTextIter *iter,
+                      const gchar       *str,
+                      GtkTextSearchFlags flags,
+                      GtkTextIter       *match_start,
+                      GtkTextIter       *match_end,
+                      const GtkTextIter *limit)
+{
+  GtkTextBTree *tree;
+  GtkTextLine *line;
+  GtkTextLine *limit_line;
+  gint end_index;
+  FastSearch fs;
+  GString *text;
+  gboolean slice;
+  gboolean case_insensitive;
+  gboolean retval = FALSE;
+
+  slice = (flags & GTK_TEXT_SEARCH_TEXT_ONLY) == 0;
+  case_insensitive = (flags & GTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0;
+
+  fast_search_init (&fs, str, case_insensitive);
+
+  tree = _gtk_text_iter_get_btree (iter);
+  limit_line = limit ? _gtk_text_iter_get_text_line (limit) : NULL;
+  text = g_string_new (NULL);
+
+  /* An end_index of -1 means the whole line, including its newline */
+  for (line = _gtk_text_iter_get_text_line (iter), end_index = gtk_text_iter_get_line_index (iter);
+       line != NULL;
+       line = _gtk_text_line_previous (line), end_index = -1)
+    {
+      GtkTextIter start, end;
+      gboolean found;
+
+      if (fast_search_get_line_text (&fs, line, text))
+        {
+          gsize len = end_index < 0 ? text->len : (gsize) end_index;
+          gssize pos, last = -1;
+
+          for (pos = fast_search_find (&fs, text->str, len, 0);
+               pos >= 0;
+               pos = fast_search_find (&fs, text->str, len, pos + 1))
+            last = pos;
+
+          found = last >= 0;
+          if (found)
+            {
+              _gtk_text_btree_get_iter_at_line (tree, &start, line, last);
+              _gtk_text_btree_get_iter_at_line (tree, &end, line, last + fs.len);
+            }
+        }
+      else
+        {
+          GtkTextIter line_start, line_end;
+          gchar *line_text;
+          const gchar *match;
+
+          _gtk_text_btree_get_iter_at_line (tree, &line_start, line, 0);
+          line_end = line_start;
+          if (end_index < 0)
+            gtk_text_iter_forward_line (&line_end);
+          else
+            gtk_text_iter_set_line_index (&line_end, end_index);
+
+          if (slice)
+            line_text = gtk_text_iter_get_slice (&line_start, &line_end);
+          else
+            line_text = gtk_text_iter_get_text (&line_start, &line_end);
+
+          if (!case_insensitive)
+            match = g_strrstr (line_text, fs.needle);
+          else
+            match = utf8_strrcasestr (line_text, fs.needle);
+
+          found = match != NULL;
+          if (found)
+            {
+              start = line_start;
+              forward_chars_with_skipping (&start,
+                                           g_utf8_strlen (line_text, match - line_text),
+                                           FALSE, !slice, FALSE);
+              end = start;
+              forward_chars_with_skipping (&end, g_utf8_strlen (fs.needle, -1),
+                                           FALSE, !slice, case_insensitive);
+            }
+
+          g_free (line_text);
+        }
+
+      if (found)
+        {
+          if (limit == NULL ||
+              gtk_text_iter_compare (limit, &start) <= 0)
+            {
+              retval = TRUE;
+
+              if (match_start)
+                *match_start = start;
+
+              if (match_end)
+                *match_end = end;
+            }
+
+          break;
+        }
+
+      if (line == limit_line)
+        break;
+    }
+
+  g_string_free (text, TRUE);
+  fast_search_clear (&fs);
+
+  return retval;
+}
+
 /**
  * gtk_text_iter_forward_search:
  * @iter: start of search
@@ -4971,6 +5314,9 @@ gtk_text_iter_forward_search (const GtkTextIter *iter,
         return FALSE;
     }
 
+  if (fast_search_possible (str, flags))
+    return fast_forward_search (iter, str, flags, match_start, match_end, limit);
+
   visible_only = (flags & GTK_TEXT_SEARCH_VISIBLE_ONLY) != 0;
   slice = (flags & GTK_TEXT_SEARCH_TEXT_ONLY) == 0;
   case_insensitive = (flags & GTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0;
@@ -5295,6 +5641,9 @@ gtk_text_iter_backward_search (const GtkTextIter *iter,
         return FALSE;
     }
 
+  if (fast_search_possible (str, flags))
+    return fast_backward_search (iter, str, flags, match_start, match_end, limit);
+
   visible_only = (flags & GTK_TEXT_SEARCH_VISIBLE_ONLY) != 0;
   slice = (flags & GTK_TEXT_SEARCH_TEXT_ONLY) == 0;
   case_insensitive = (flags & GTK_TEXT_SEARCH_CASE_INSENSITIVE) != 0;
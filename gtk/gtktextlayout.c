@@ -92,6 +92,67 @@
 #define GTK_TEXT_LAYOUT_GET_PRIVATE(o)  ((GtkTextLayoutPrivate *) gtk_text_layout_get_instance_private ((o)))
 
 typedef struct _GtkTextLayoutPrivate GtkTextLayoutPrivate;
+typedef struct _MeasureContext MeasureContext;
+typedef struct _MeasureJob MeasureJob;
+typedef struct _LineMeasure LineMeasure;
+
+/* The settings of a PangoContext, to recreate it on the
+ * measuring thread.
+ */
+struct _MeasureContext
+{
+  PangoFontDescription *font_desc;
+  PangoLanguage *language;
+  PangoDirection base_dir;
+  PangoGravity base_gravity;
+  PangoGravityHint gravity_hint;
+  PangoMatrix *matrix;
+  cairo_font_options_t *font_options;
+  gdouble resolution;
+};
+
+/* A batch of offscreen paragraphs to measure on the measuring
+ * thread. The thread only touches the contexts and the text and
+ * attributes of the lines, which are copies owned by the job.
+ */
+struct _MeasureJob
+{
+  GtkTextLayout *layout;
+  GPtrArray *lines;
+  gint n_pending;
+
+  MeasureContext contexts[2];
+};
+
+struct _LineMeasure
+{
+  /* Main thread only; line is %NULL once the line has been
+   * invalidated or measured synchronously.
+   */
+  MeasureJob *job;
+  GtkTextLine *line;
+
+  gchar *text;
+  PangoAttrList *attrs;
+  PangoTabArray *tabs;
+  PangoAlignment alignment;
+  PangoWrapMode wrap;
+  gint width;
+  gint indent;
+  gint spacing;
+  guint justify : 1;
+  guint rtl : 1;
+
+  /* Margins, padding and paragraph spacing around the text */
+  gint extra_width;
+  gint extra_height;
+
+  /* Set by the measuring thread */
+  gint result_width;
+  gint result_height;
+  gint top_ink;
+  gint bottom_ink;
+};
 
 struct _GtkTextLayoutPrivate
 {
@@ -99,8 +160,26 @@ struct _GtkTextLayoutPrivate
      direction only influences the direction of the cursor line.
   */
   GtkTextLine *cursor_line;
+
+  /* The most recently used line displays, so that redrawing the
+   * visible lines or moving the cursor does not recreate them.
+   * Maps GtkTextLine to its link in display_lru.
+   */
+  GHashTable *display_cache;
+  GQueue      display_lru;
+
+  /* Paragraphs queued for the measuring thread, mapping
+   * GtkTextLine to its LineMeasure, and the current batch.
+   */
+  GHashTable  *measuring;
+  MeasureJob  *measure_job;
+
+  /* The result that gtk_text_layout_real_wrap() commits */
+  LineMeasure *measured;
 };
 
+#define DISPLAY_CACHE_SIZE 128
+
 static GtkTextLineData *gtk_text_layout_real_wrap (GtkTextLayout *layout,
                                                    GtkTextLine *line,
                                                    /* may be NULL */
@@ -119,6 +198,9 @@ static void gtk_text_layout_invalidate_cache       (GtkTextLayout     *layout,
 						    gboolean           cursors_only);
 static void gtk_text_layout_invalidate_cursor_line (GtkTextLayout     *layout,
 						    gboolean           cursors_only);
+static void display_cache_remove                   (GtkTextLayout     *layout,
+						    GList             *link);
+static void display_cache_clear                    (GtkTextLayout     *layout);
 static void gtk_text_layout_real_free_line_data    (GtkTextLayout     *layout,
 						    GtkTextLine       *line,
 						    GtkTextLineData   *line_data);
@@ -126,6 +208,14 @@ static void gtk_text_layout_emit_changed           (GtkTextLayout     *layout,
 						    gint               y,
 						    gint               old_height,
 						    gint               new_height);
+static void line_measure_cancel                    (GtkTextLayout     *layout,
+						    GtkTextLine       *line);
+static void line_measure_cancel_all                (GtkTextLayout     *layout);
+static GtkTextLineDisplay *gtk_text_layout_create_line_display (GtkTextLayout *layout,
+                                                                GtkTextLine   *line,
+                                                                gboolean       size_only,
+                                                                gboolean      *invisible,
+                                                                gboolean      *saw_widget);
 
 static void gtk_text_layout_invalidate_all (GtkTextLayout *layout);
 
@@ -195,12 +285,7 @@ gtk_text_layout_dispose (GObject *object)
   g_clear_object (&layout->ltr_context);
   g_clear_object (&layout->rtl_context);
 
-  if (layout->one_display_cache)
-    {
-      GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-      layout->one_display_cache = NULL;
-      gtk_text_layout_free_line_display (layout, tmp_display);
-    }
+  display_cache_clear (layout);
 
   if (layout->preedit_attrs != NULL)
     {
@@ -220,6 +305,9 @@ gtk_text_layout_finalize (GObject *object)
 
   g_free (layout->preedit_string);
 
+  g_hash_table_unref (GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->display_cache);
+  g_hash_table_unref (GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->measuring);
+
   G_OBJECT_CLASS (gtk_text_layout_parent_class)->finalize (object);
 }
 
@@ -278,7 +366,61 @@ gtk_text_layout_class_init (GtkTextLayoutClass *klass)
 static void
 gtk_text_layout_init (GtkTextLayout *text_layout)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (text_layout);
+
   text_layout->cursor_visible = TRUE;
+
+  priv->display_cache = g_hash_table_new (NULL, NULL);
+  g_queue_init (&priv->display_lru);
+
+  priv->measuring = g_hash_table_new (NULL, NULL);
+}
+
+static void
+display_cache_remove (GtkTextLayout *layout,
+                      GList         *link)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineDisplay *display = link->data;
+
+  g_queue_unlink (&priv->display_lru, link);
+  g_hash_table_remove (priv->display_cache, display->line);
+  g_list_free_1 (link);
+
+  gtk_text_layout_free_line_display (layout, display);
+}
+
+/* Only lines that have line data for this layout are cached, as
+ * freeing the line data is how we learn about deleted lines.
+ */
+static void
+display_cache_insert (GtkTextLayout      *layout,
+                      GtkTextLineDisplay *display)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  if (_gtk_text_line_get_data (display->line, layout) == NULL)
+    return;
+
+  link = g_hash_table_lookup (priv->display_cache, display->line);
+  if (link)
+    display_cache_remove (layout, link);
+
+  g_queue_push_head (&priv->display_lru, display);
+  g_hash_table_insert (priv->display_cache, display->line, priv->display_lru.head);
+
+  while (priv->display_lru.length > DISPLAY_CACHE_SIZE)
+    display_cache_remove (layout, priv->display_lru.tail);
+}
+
+static void
+display_cache_clear (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  while (priv->display_lru.head)
+    display_cache_remove (layout, priv->display_lru.head);
 }
 
 GtkTextLayout*
@@ -312,6 +454,7 @@ gtk_text_layout_set_buffer (GtkTextLayout *layout,
     return;
 
   free_style_cache (layout);
+  line_measure_cancel_all (layout);
 
   if (layout->buffer)
     {
@@ -637,15 +780,21 @@ text_layout_changed (GtkTextLayout *layout,
                      gint           new_height,
                      gboolean       cursors_only)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *l, *next;
+
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cached lines if so.
    */
-  if (layout->one_display_cache)
+  for (l = priv->display_lru.head; l; l = next)
     {
-      GtkTextLine *line = layout->one_display_cache->line;
+      GtkTextLineDisplay *display = l->data;
+      GtkTextLine *line = display->line;
       gint cache_y = _gtk_text_btree_find_line_top (_gtk_text_buffer_get_btree (layout->buffer),
 						    line, layout);
-      gint cache_height = layout->one_display_cache->height;
+      gint cache_height = display->height;
+
+      next = l->next;
 
       if (cache_y + cache_height > y && cache_y < y + old_height)
 	gtk_text_layout_invalidate_cache (layout, line, cursors_only);
@@ -820,9 +969,13 @@ gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
                                   GtkTextLine   *line,
 				  gboolean       cursors_only)
 {
-  if (layout->one_display_cache && line == layout->one_display_cache->line)
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  link = g_hash_table_lookup (priv->display_cache, line);
+  if (link)
     {
-      GtkTextLineDisplay *display = layout->one_display_cache;
+      GtkTextLineDisplay *display = link->data;
 
       if (cursors_only)
 	{
@@ -833,11 +986,11 @@ gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
 	  display->has_block_cursor = FALSE;
 	}
       else
-	{
-	  layout->one_display_cache = NULL;
-	  gtk_text_layout_free_line_display (layout, display);
-	}
+	display_cache_remove (layout, link);
     }
+
+  if (!cursors_only)
+    line_measure_cancel (layout, line);
 }
 
 /* Now invalidate the paragraph containing the cursor
@@ -928,32 +1081,29 @@ gtk_text_layout_real_invalidate_cursors (GtkTextLayout     *layout,
 					 const GtkTextIter *start,
 					 const GtkTextIter *end)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  gint start_line, end_line;
+  GList *l;
+
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cached lines if so.
    */
-  if (layout->one_display_cache)
+  start_line = gtk_text_iter_get_line (start);
+  end_line = gtk_text_iter_get_line (end);
+  if (start_line > end_line)
     {
-      GtkTextIter line_start, line_end;
-      GtkTextLine *line = layout->one_display_cache->line;
-
-      gtk_text_layout_get_iter_at_line (layout, &line_start, line, 0);
-
-      line_end = line_start;
-      if (!gtk_text_iter_ends_line (&line_end))
-	gtk_text_iter_forward_to_line_end (&line_end);
+      gint tmp = start_line;
+      start_line = end_line;
+      end_line = tmp;
+    }
 
-      if (gtk_text_iter_compare (start, end) > 0)
-	{
-	  const GtkTextIter *tmp = start;
-	  start = end;
-	  end = tmp;
-	}
+  for (l = priv->display_lru.head; l; l = l->next)
+    {
+      GtkTextLineDisplay *display = l->data;
+      gint line = _gtk_text_line_get_number (display->line);
 
-      if (gtk_text_iter_compare (&line_start, end) <= 0 &&
-	  gtk_text_iter_compare (start, &line_end) <= 0)
-	{
-	  gtk_text_layout_invalidate_cache (layout, line, TRUE);
-	}
+      if (line >= start_line && line <= end_line)
+	gtk_text_layout_invalidate_cache (layout, display->line, TRUE);
     }
 
   gtk_text_layout_invalidated (layout);
@@ -1161,12 +1311,444 @@ gtk_text_layout_validate (GtkTextLayout *layout,
     }
 }
 
+/*
+ * Measuring offscreen paragraphs on a separate thread.
+ *
+ * Shaping is what makes validating a big buffer slow, and it only
+ * needs the text, the Pango attributes and the paragraph settings of
+ * a line. _gtk_text_layout_measure_async() copies those for a batch
+ * of invalid lines on the main thread, and a worker thread lays them
+ * out with its own font map. The resulting sizes are committed into
+ * the btree back on the main thread, through the wrap vfunc, unless
+ * the line was invalidated or validated in the meantime.
+ */
+
+/* Upper bound for the text copied into one batch */
+#define MEASURE_JOB_MAX_BYTES (256 * 1024)
+
+static GThreadPool *measure_pool = NULL;
+
+static void
+measure_context_init (MeasureContext *mc,
+                      PangoContext   *context)
+{
+  const PangoMatrix *matrix;
+  const cairo_font_options_t *font_options;
+
+  mc->font_desc = pango_font_description_copy (pango_context_get_font_description (context));
+  mc->language = pango_context_get_language (context);
+  mc->base_dir = pango_context_get_base_dir (context);
+  mc->base_gravity = pango_context_get_base_gravity (context);
+  mc->gravity_hint = pango_context_get_gravity_hint (context);
+
+  matrix = pango_context_get_matrix (context);
+  mc->matrix = matrix ? pango_matrix_copy (matrix) : NULL;
+
+  font_options = pango_cairo_context_get_font_options (context);
+  mc->font_options = font_options ? cairo_font_options_copy (font_options) : NULL;
+  mc->resolution = pango_cairo_context_get_resolution (context);
+}
+
+static void
+measure_context_clear (MeasureContext *mc)
+{
+  if (mc->font_desc)
+    pango_font_description_free (mc->font_desc);
+  if (mc->matrix)
+    pango_matrix_free (mc->matrix);
+  if (mc->font_options)
+    cairo_font_options_destroy (mc->font_options);
+}
+
+static PangoContext *
+measure_context_create (MeasureContext *mc,
+                        PangoFontMap   *font_map)
+{
+  PangoContext *context;
+
+  context = pango_font_map_create_context (font_map);
+  pango_context_set_font_description (context, mc->font_desc);
+  pango_context_set_language (context, mc->language);
+  pango_context_set_base_dir (context, mc->base_dir);
+  pango_context_set_base_gravity (context, mc->base_gravity);
+  pango_context_set_gravity_hint (context, mc->gravity_hint);
+  pango_context_set_matrix (context, mc->matrix);
+  pango_cairo_context_set_font_options (context, mc->font_options);
+  pango_cairo_context_set_resolution (context, mc->resolution);
+
+  return context;
+}
+
+static void
+line_measure_free (LineMeasure *measure)
+{
+  g_free (measure->text);
+  if (measure->attrs)
+    pango_attr_list_unref (measure->attrs);
+  if (measure->tabs)
+    pango_tab_array_free (measure->tabs);
+
+  g_slice_free (LineMeasure, measure);
+}
+
+static void
+measure_job_free (MeasureJob *job)
+{
+  g_ptr_array_unref (job->lines);
+  measure_context_clear (&job->contexts[0]);
+  measure_context_clear (&job->contexts[1]);
+  g_object_unref (job->layout);
+
+  g_slice_free (MeasureJob, job);
+}
+
+static void
+line_measure_cancel (GtkTextLayout *layout,
+                     GtkTextLine   *line)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  LineMeasure *measure;
+
+  measure = g_hash_table_lookup (priv->measuring, line);
+  if (measure == NULL)
+    return;
+
+  g_hash_table_remove (priv->measuring, line);
+  measure->line = NULL;
+
+  /* Nothing is left to commit from this batch, let the next one
+   * start without waiting for it
+   */
+  measure->job->n_pending -= 1;
+  if (measure->job->n_pending == 0 && measure->job == priv->measure_job)
+    priv->measure_job = NULL;
+}
+
+static void
+line_measure_cancel_all (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, priv->measuring);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      LineMeasure *measure = value;
+
+      measure->line = NULL;
+      measure->job->n_pending -= 1;
+    }
+
+  g_hash_table_remove_all (priv->measuring);
+  priv->measure_job = NULL;
+}
+
+/* Copies what measuring @line needs, or returns %NULL if the line
+ * can only be measured on the main thread.
+ */
+static LineMeasure *
+line_measure_new (GtkTextLayout *layout,
+                  GtkTextLine   *line)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineDisplay *display;
+  LineMeasure *measure;
+  gboolean invisible;
+  gboolean saw_widget;
+
+  /* The cursor line follows the keyboard direction and may carry
+   * the input method's preedit attributes.
+   */
+  if (line == priv->cursor_line)
+    return NULL;
+
+  display = gtk_text_layout_create_line_display (layout, line, TRUE,
+                                                 &invisible, &saw_widget);
+  if (invisible || saw_widget)
+    {
+      gtk_text_layout_free_line_display (layout, display);
+      return NULL;
+    }
+
+  measure = g_slice_new0 (LineMeasure);
+  measure->line = line;
+  measure->text = g_strdup (pango_layout_get_text (display->layout));
+  measure->attrs = pango_attr_list_copy (pango_layout_get_attributes (display->layout));
+  measure->tabs = pango_layout_get_tabs (display->layout);
+  measure->alignment = pango_layout_get_alignment (display->layout);
+  measure->wrap = pango_layout_get_wrap (display->layout);
+  measure->width = pango_layout_get_width (display->layout);
+  measure->indent = pango_layout_get_indent (display->layout);
+  measure->spacing = pango_layout_get_spacing (display->layout);
+  measure->justify = pango_layout_get_justify (display->layout);
+  measure->rtl = display->direction == GTK_TEXT_DIR_RTL;
+  measure->extra_width = display->left_margin + display->right_margin +
+                         layout->left_padding + layout->right_padding;
+  measure->extra_height = display->height;
+
+  gtk_text_layout_free_line_display (layout, display);
+
+  return measure;
+}
+
+static void
+measure_job_emit_changed (GtkTextLayout *layout,
+                          GtkTextLine   *first_line,
+                          gint           old_height,
+                          gint           new_height)
+{
+  gint y;
+
+  update_layout_size (layout);
+
+  y = _gtk_text_btree_find_line_top (_gtk_text_buffer_get_btree (layout->buffer),
+                                     first_line, layout);
+  gtk_text_layout_emit_changed (layout, y, old_height, new_height);
+}
+
+static gboolean
+measure_job_commit (MeasureJob *job)
+{
+  GtkTextLayout *layout = job->layout;
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLine *first_line = NULL;
+  GtkTextLine *last_line = NULL;
+  gint old_height = 0;
+  gint new_height = 0;
+  guint i;
+
+  if (priv->measure_job == job)
+    priv->measure_job = NULL;
+
+  for (i = 0; i < job->lines->len; i++)
+    {
+      LineMeasure *measure = g_ptr_array_index (job->lines, i);
+      GtkTextLine *line = measure->line;
+      GtkTextLineData *line_data;
+      gint line_old_height;
+
+      if (line == NULL)
+        continue;
+
+      /* Report contiguous runs of lines as one change */
+      if (last_line != NULL && _gtk_text_line_next (last_line) != line)
+        {
+          measure_job_emit_changed (layout, first_line, old_height, new_height);
+          first_line = NULL;
+          last_line = NULL;
+
+          /* Handlers may have reset the buffer or changed the line */
+          if (layout->buffer == NULL)
+            break;
+
+          line = measure->line;
+          if (line == NULL)
+            continue;
+        }
+
+      line_data = _gtk_text_line_get_data (line, layout);
+      line_old_height = line_data ? line_data->height : 0;
+
+      priv->measured = measure;
+      _gtk_text_btree_validate_line (_gtk_text_buffer_get_btree (layout->buffer),
+                                     line, layout);
+      priv->measured = NULL;
+
+      g_hash_table_remove (priv->measuring, line);
+      measure->line = NULL;
+      job->n_pending -= 1;
+
+      line_data = _gtk_text_line_get_data (line, layout);
+
+      if (first_line == NULL)
+        {
+          first_line = line;
+          old_height = 0;
+          new_height = 0;
+        }
+      last_line = line;
+      old_height += line_old_height;
+      new_height += line_data->height;
+    }
+
+  if (first_line != NULL && layout->buffer != NULL)
+    measure_job_emit_changed (layout, first_line, old_height, new_height);
+
+  return FALSE;
+}
+
+/* Runs on the measuring thread */
+static void
+measure_job_run (gpointer data,
+                 gpointer user_data)
+{
+  MeasureJob *job = data;
+  PangoFontMap *font_map;
+  PangoContext *contexts[2];
+  guint i;
+
+  /* The default font map is per thread, so this one
+   * is only ever used here.
+   */
+  font_map = pango_cairo_font_map_get_default ();
+  contexts[0] = measure_context_create (&job->contexts[0], font_map);
+  contexts[1] = measure_context_create (&job->contexts[1], font_map);
+
+  for (i = 0; i < job->lines->len; i++)
+    {
+      LineMeasure *measure = g_ptr_array_index (job->lines, i);
+      PangoLayout *layout;
+      PangoRectangle extents, ink_rect, logical_rect;
+
+      layout = pango_layout_new (contexts[measure->rtl]);
+      pango_layout_set_text (layout, measure->text, -1);
+      pango_layout_set_attributes (layout, measure->attrs);
+      pango_layout_set_alignment (layout, measure->alignment);
+      pango_layout_set_justify (layout, measure->justify);
+      pango_layout_set_spacing (layout, measure->spacing);
+      pango_layout_set_tabs (layout, measure->tabs);
+      pango_layout_set_indent (layout, measure->indent);
+      pango_layout_set_width (layout, measure->width);
+      pango_layout_set_wrap (layout, measure->wrap);
+
+      /* Same as gtk_text_layout_measure_line_display() and
+       * gtk_text_layout_real_wrap()
+       */
+      pango_layout_get_extents (layout, NULL, &extents);
+      pango_layout_get_pixel_extents (layout, &ink_rect, &logical_rect);
+
+      measure->result_width = PIXEL_BOUND (extents.width) + measure->extra_width;
+      measure->result_height = measure->extra_height + PANGO_PIXELS (extents.height);
+      measure->top_ink = MAX (0, logical_rect.x - ink_rect.x);
+      measure->bottom_ink = MAX (0, logical_rect.x + logical_rect.width - ink_rect.x - ink_rect.width);
+
+      g_object_unref (layout);
+    }
+
+  g_object_unref (contexts[0]);
+  g_object_unref (contexts[1]);
+
+  gdk_threads_add_idle_full (GDK_PRIORITY_REDRAW + 5,
+                             (GSourceFunc) measure_job_commit, job,
+                             (GDestroyNotify) measure_job_free);
+}
+
+/**
+ * _gtk_text_layout_measure_async:
+ * @layout: a #GtkTextLayout
+ * @max_lines: the maximum number of paragraphs to queue
+ *
+ * Queues the next invalid paragraphs of @layout to be measured on
+ * the measuring thread. When the results are committed, the ::changed
+ * signal is emitted for them. Only one batch is measured at a time.
+ *
+ * Paragraphs with child widgets, totally invisible paragraphs and the
+ * cursor paragraph are left to gtk_text_layout_validate().
+ *
+ * Returns: %TRUE if paragraphs are being measured, %FALSE if the next
+ *   invalid paragraph has to be validated synchronously.
+ */
+gboolean
+_gtk_text_layout_measure_async (GtkTextLayout *layout,
+                                gint           max_lines)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  PangoFontMap *font_map;
+  MeasureJob *job;
+  GtkTextLine *line;
+  gint n_bytes;
+
+  g_return_val_if_fail (GTK_IS_TEXT_LAYOUT (layout), FALSE);
+
+  if (priv->measure_job != NULL)
+    return TRUE;
+
+  if (layout->buffer == NULL ||
+      layout->ltr_context == NULL ||
+      layout->rtl_context == NULL)
+    return FALSE;
+
+  /* The measuring thread only gets the same results from its own
+   * font map if the contexts use the default one.
+   */
+  font_map = pango_cairo_font_map_get_default ();
+  if (pango_context_get_font_map (layout->ltr_context) != font_map ||
+      pango_context_get_font_map (layout->rtl_context) != font_map)
+    return FALSE;
+
+  if (measure_pool == NULL)
+    {
+      measure_pool = g_thread_pool_new (measure_job_run, NULL, 1, TRUE, NULL);
+      if (measure_pool == NULL)
+        return FALSE;
+    }
+
+  job = g_slice_new0 (MeasureJob);
+  job->layout = g_object_ref (layout);
+  job->lines = g_ptr_array_new_with_free_func ((GDestroyNotify) line_measure_free);
+
+  n_bytes = 0;
+  line = _gtk_text_btree_get_first_invalid_line (_gtk_text_buffer_get_btree (layout->buffer),
+                                                 layout);
+  while (line != NULL &&
+         job->lines->len < (guint) max_lines &&
+         n_bytes < MEASURE_JOB_MAX_BYTES)
+    {
+      GtkTextLineData *line_data = _gtk_text_line_get_data (line, layout);
+      LineMeasure *measure;
+
+      if (line_data && line_data->valid)
+        break;
+
+      /* Lines from a batch that is being committed */
+      if (g_hash_table_contains (priv->measuring, line))
+        break;
+
+      measure = line_measure_new (layout, line);
+      if (measure == NULL)
+        break;
+
+      /* Line data is freed along with the line, which
+       * cancels the measuring
+       */
+      if (line_data == NULL)
+        {
+          line_data = _gtk_text_line_data_new (layout, line);
+          _gtk_text_line_add_data (line, line_data);
+        }
+
+      measure->job = job;
+      g_ptr_array_add (job->lines, measure);
+      g_hash_table_insert (priv->measuring, line, measure);
+      n_bytes += strlen (measure->text);
+
+      line = _gtk_text_line_next (line);
+    }
+
+  if (job->lines->len == 0)
+    {
+      measure_job_free (job);
+      return FALSE;
+    }
+
+  measure_context_init (&job->contexts[0], layout->ltr_context);
+  measure_context_init (&job->contexts[1], layout->rtl_context);
+  job->n_pending = job->lines->len;
+  priv->measure_job = job;
+
+  g_thread_pool_push (measure_pool, job, NULL);
+
+  return TRUE;
+}
+
 static GtkTextLineData*
 gtk_text_layout_real_wrap (GtkTextLayout   *layout,
                            GtkTextLine     *line,
                            /* may be NULL */
                            GtkTextLineData *line_data)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextLineDisplay *display;
   PangoRectangle ink_rect, logical_rect;
 
@@ -1179,6 +1761,22 @@ gtk_text_layout_real_wrap (GtkTextLayout   *layout,
       _gtk_text_line_add_data (line, line_data);
     }
 
+  if (priv->measured != NULL && priv->measured->line == line)
+    {
+      line_data->width = priv->measured->result_width;
+      line_data->height = priv->measured->result_height;
+      line_data->top_ink = priv->measured->top_ink;
+      line_data->bottom_ink = priv->measured->bottom_ink;
+      line_data->valid = TRUE;
+
+      return line_data;
+    }
+
+  /* Measured here, so a result from the measuring thread
+   * is not needed anymore
+   */
+  line_measure_cancel (layout, line);
+
   display = gtk_text_layout_get_line_display (layout, line, TRUE);
   line_data->width = display->width;
   line_data->height = display->height;
@@ -2243,10 +2841,17 @@ tags_array_toggle_tag (GPtrArray  *array,
   return array;
 }
 
-GtkTextLineDisplay *
-gtk_text_layout_get_line_display (GtkTextLayout *layout,
-                                  GtkTextLine   *line,
-                                  gboolean       size_only)
+/* Builds the text, attributes and paragraph values of a line display,
+ * without measuring it. Completely invisible lines are left empty and
+ * flagged with @invisible; @saw_widget is set if the line has child
+ * widgets.
+ */
+static GtkTextLineDisplay *
+gtk_text_layout_create_line_display (GtkTextLayout *layout,
+                                     GtkTextLine   *line,
+                                     gboolean       size_only,
+                                     gboolean      *invisible,
+                                     gboolean      *saw_widget)
 {
   GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextLineDisplay *display;
@@ -2254,41 +2859,17 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   GtkTextIter iter;
   GtkTextAttributes *style;
   gchar *text;
-  gint text_pixel_width;
   PangoAttrList *attrs;
   gint text_allocated, layout_byte_offset, buffer_byte_offset;
-  PangoRectangle extents;
   gboolean para_values_set = FALSE;
   GSList *cursor_byte_offsets = NULL;
   GSList *cursor_segs = NULL;
   GSList *tmp_list1, *tmp_list2;
-  gboolean saw_widget = FALSE;
   PangoDirection base_dir;
   GPtrArray *tags;
   gboolean initial_toggle_segments;
-  gint h_margin;
-  gint h_padding;
-  
-  g_return_val_if_fail (line != NULL, NULL);
 
-  if (layout->one_display_cache)
-    {
-      if (line == layout->one_display_cache->line &&
-          (size_only || !layout->one_display_cache->size_only))
-	{
-	  if (!size_only)
-            update_text_display_cursors (layout, line, layout->one_display_cache);
-	  return layout->one_display_cache;
-	}
-      else
-        {
-          GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-          layout->one_display_cache = NULL;
-          gtk_text_layout_free_line_display (layout, tmp_display);
-        }
-    }
-
-  DV (g_print ("creating one line display cache (%s)\n", G_STRLOC));
+  DV (g_print ("creating line display (%s)\n", G_STRLOC));
 
   display = g_slice_new0 (GtkTextLineDisplay);
 
@@ -2296,6 +2877,9 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   display->line = line;
   display->insert_index = -1;
 
+  *invisible = FALSE;
+  *saw_widget = FALSE;
+
   /* Special-case optimization for completely
    * invisible lines; makes it faster to deal
    * with sequences of invisible lines.
@@ -2307,6 +2891,7 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
       else
 	display->layout = pango_layout_new (layout->ltr_context);
       
+      *invisible = TRUE;
       return display;
     }
 
@@ -2436,7 +3021,7 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
                 }
               else if (seg->type == &gtk_text_child_type)
                 {
-                  saw_widget = TRUE;
+                  *saw_widget = TRUE;
                   
                   add_generic_attrs (layout, &style->appearance,
                                      seg->byte_count,
@@ -2573,6 +3158,27 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   g_slist_free (cursor_byte_offsets);
   g_slist_free (cursor_segs);
 
+  /* Free this if we aren't in a loop */
+  if (layout->wrap_loop_count == 0)
+    invalidate_cached_style (layout);
+
+  g_free (text);
+  pango_attr_list_unref (attrs);
+  if (tags != NULL)
+    g_ptr_array_free (tags, TRUE);
+
+  return display;
+}
+
+static void
+gtk_text_layout_measure_line_display (GtkTextLayout      *layout,
+                                      GtkTextLineDisplay *display)
+{
+  PangoRectangle extents;
+  gint text_pixel_width;
+  gint h_margin;
+  gint h_padding;
+
   pango_layout_get_extents (display->layout, NULL, &extents);
 
   text_pixel_width = PIXEL_BOUND (extents.width);
@@ -2603,17 +3209,47 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
 	  break;
 	}
     }
+}
+
+GtkTextLineDisplay *
+gtk_text_layout_get_line_display (GtkTextLayout *layout,
+                                  GtkTextLine   *line,
+                                  gboolean       size_only)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineDisplay *display;
+  gboolean invisible;
+  gboolean saw_widget;
+  GList *link;
   
-  /* Free this if we aren't in a loop */
-  if (layout->wrap_loop_count == 0)
-    invalidate_cached_style (layout);
+  g_return_val_if_fail (line != NULL, NULL);
 
-  g_free (text);
-  pango_attr_list_unref (attrs);
-  if (tags != NULL)
-    g_ptr_array_free (tags, TRUE);
+  link = g_hash_table_lookup (priv->display_cache, line);
+  if (link)
+    {
+      display = link->data;
 
-  layout->one_display_cache = display;
+      if (size_only || !display->size_only)
+	{
+	  g_queue_unlink (&priv->display_lru, link);
+	  g_queue_push_head_link (&priv->display_lru, link);
+
+	  if (!size_only)
+            update_text_display_cursors (layout, line, display);
+	  return display;
+	}
+      else
+        display_cache_remove (layout, link);
+    }
+
+  display = gtk_text_layout_create_line_display (layout, line, size_only,
+                                                 &invisible, &saw_widget);
+  if (invisible)
+    return display;
+
+  gtk_text_layout_measure_line_display (layout, display);
+
+  display_cache_insert (layout, display);
 
   if (saw_widget)
     allocate_child_widgets (layout, display);
@@ -2625,7 +3261,11 @@ void
 gtk_text_layout_free_line_display (GtkTextLayout      *layout,
                                    GtkTextLineDisplay *display)
 {
-  if (display != layout->one_display_cache)
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  link = g_hash_table_lookup (priv->display_cache, display->line);
+  if (link == NULL || link->data != display)
     {
       if (display->layout)
         g_object_unref (display->layout);
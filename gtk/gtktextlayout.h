@@ -147,8 +147,8 @@ struct _GtkTextLayout
    * over long runs with the same style. */
   GtkTextAttributes *one_style_cache;
 
-  /* A cache of one line display. Getting the same line
-   * many times in a row is the most common case.
+  /* Unused; line displays are cached in the private
+   * data of the layout now.
    */
   GtkTextLineDisplay *one_display_cache;
 
@@ -378,6 +378,8 @@ void     gtk_text_layout_validate_yrange (GtkTextLayout *layout,
 GDK_AVAILABLE_IN_ALL
 void     gtk_text_layout_validate        (GtkTextLayout *layout,
                                           gint           max_pixels);
+gboolean _gtk_text_layout_measure_async  (GtkTextLayout *layout,
+                                          gint           max_lines);
 
 /* This function should return the passed-in line data,
  * OR remove the existing line data from the line, and
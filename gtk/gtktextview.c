@@ -146,6 +146,14 @@
 
 #define SPACE_FOR_CURSOR 1
 
+/* Offscreen lines are validated in small chunks until the time slice
+ * for one idle is used up, so that huge buffers do not starve input
+ * and redraws while they are being measured.
+ */
+#define GTK_TEXT_VIEW_TIME_MS_PER_IDLE 10
+#define GTK_TEXT_VIEW_PIXELS_PER_CHUNK 200
+#define GTK_TEXT_VIEW_LINES_PER_MEASURE 200
+
 #define GTK_TEXT_VIEW_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GTK_TYPE_TEXT_VIEW, GtkTextViewPrivate))
 
 typedef struct _GtkTextWindow GtkTextWindow;
@@ -4478,10 +4486,29 @@ incremental_validate_callback (gpointer data)
 {
   GtkTextView *text_view = data;
   gboolean result = TRUE;
+  gint64 deadline;
 
   DV(g_print(G_STRLOC"\n"));
-  
-  gtk_text_layout_validate (text_view->priv->layout, 2000);
+
+  /* Offscreen paragraphs are measured on a separate thread where
+   * possible. The idle is queued again from changed_handler() once
+   * their sizes are committed.
+   */
+  if (_gtk_text_layout_measure_async (text_view->priv->layout,
+                                      GTK_TEXT_VIEW_LINES_PER_MEASURE))
+    {
+      gtk_text_view_update_adjustments (text_view);
+      text_view->priv->incremental_validate_idle = 0;
+      return FALSE;
+    }
+
+  deadline = gtk_widget_get_idle_deadline (GTK_WIDGET (text_view),
+                                           GTK_TEXT_VIEW_TIME_MS_PER_IDLE * 1000);
+
+  do
+    gtk_text_layout_validate (text_view->priv->layout, GTK_TEXT_VIEW_PIXELS_PER_CHUNK);
+  while (!gtk_text_layout_is_valid (text_view->priv->layout) &&
+         g_get_monotonic_time () < deadline);
 
   gtk_text_view_update_adjustments (text_view);
   
@@ -4660,6 +4687,16 @@ changed_handler (GtkTextLayout     *layout,
 	gtk_widget_queue_resize_no_redraw (widget);
       }
   }
+
+  /* Paragraphs measured on the measuring thread are committed while
+   * the incremental validation idle waits for them; queue it again to
+   * update the adjustments and continue with the next paragraphs.
+   */
+  if (!priv->incremental_validate_idle)
+    {
+      priv->incremental_validate_idle = gdk_threads_add_idle_full (GTK_TEXT_VIEW_PRIORITY_VALIDATE, incremental_validate_callback, text_view, NULL);
+      g_source_set_name_by_id (priv->incremental_validate_idle, "[gtk+] incremental_validate_callback");
+    }
 }
 
 static void
@@ -142,6 +142,10 @@ void              _gtk_tree_view_column_push_padding          (GtkTreeViewColumn
 gint              _gtk_tree_view_column_get_requested_width   (GtkTreeViewColumn  *column);
 gint              _gtk_tree_view_column_get_drag_x            (GtkTreeViewColumn  *column);
 GtkCellAreaContext *_gtk_tree_view_column_get_context         (GtkTreeViewColumn  *column);
+gint              _gtk_tree_view_column_get_sample_size       (GtkTreeViewColumn  *column);
+gboolean          _gtk_tree_view_column_cell_get_height       (GtkTreeViewColumn  *column,
+                                                               gint               *height);
+gboolean          _gtk_tree_view_column_cell_sample_width     (GtkTreeViewColumn  *column);
 
 
 G_END_DECLS
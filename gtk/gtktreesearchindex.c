@@ -0,0 +1,553 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2016 the GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gtktreesearchindexprivate.h"
+
+/* The search index holds the normalized, casefolded text of every
+ * row that the interactive search of a tree view can visit, in the
+ * order the search visits them. A second table keeps the rows sorted
+ * by their key, so that all rows starting with a given prefix form a
+ * contiguous range that can be found with a binary search.
+ *
+ * The rows matching the last looked up key are kept around as the
+ * candidate set. When the user types another character, the new key
+ * extends the old one and we only need to filter the candidates.
+ *
+ * Rows that are inserted, changed, deleted, expanded or collapsed are
+ * spliced into the rows table, and the sorted table is rebuilt the
+ * next time a key is looked up, so a burst of changes only pays for
+ * one sort. Each splice still moves the rows after it, so after
+ * SEARCH_INDEX_MAX_UPDATES of them the tree view drops the index
+ * and builds a new one when it is needed again. Reordering the model
+ * always requires building a new index.
+ */
+
+/* Updates after which building a new index from the model is
+ * cheaper than splicing more rows into this one
+ */
+#define SEARCH_INDEX_MAX_UPDATES 32
+
+typedef struct _SearchRow SearchRow;
+
+struct _SearchRow
+{
+  gchar *key;
+  GtkTreePath *path;
+};
+
+struct _GtkTreeSearchIndex
+{
+  GArray *rows;         /* SearchRow, in display order */
+  GArray *sorted;       /* guint row indices, sorted by key */
+  guint sorted_valid : 1;
+  guint n_updates;
+
+  gchar *last_key;
+  GArray *candidates;   /* guint row indices matching last_key, ascending */
+};
+
+static gchar *
+search_index_fold (const gchar *text)
+{
+  gchar *normalized;
+  gchar *folded;
+
+  normalized = g_utf8_normalize (text, -1, G_NORMALIZE_ALL);
+  if (normalized == NULL)
+    return NULL;
+
+  folded = g_utf8_casefold (normalized, -1);
+  g_free (normalized);
+
+  return folded;
+}
+
+static void
+search_row_clear (gpointer data)
+{
+  SearchRow *row = data;
+
+  g_free (row->key);
+  gtk_tree_path_free (row->path);
+}
+
+GtkTreeSearchIndex *
+_gtk_tree_search_index_new (void)
+{
+  GtkTreeSearchIndex *index;
+
+  index = g_slice_new0 (GtkTreeSearchIndex);
+  index->rows = g_array_new (FALSE, FALSE, sizeof (SearchRow));
+  g_array_set_clear_func (index->rows, search_row_clear);
+  index->sorted = g_array_new (FALSE, FALSE, sizeof (guint));
+  index->candidates = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  return index;
+}
+
+void
+_gtk_tree_search_index_free (GtkTreeSearchIndex *index)
+{
+  g_return_if_fail (index != NULL);
+
+  g_array_unref (index->rows);
+  g_array_unref (index->sorted);
+  g_array_unref (index->candidates);
+  g_free (index->last_key);
+
+  g_slice_free (GtkTreeSearchIndex, index);
+}
+
+/* Rows must be added in the order in which the interactive search
+ * visits them; the index takes ownership of @path.
+ */
+void
+_gtk_tree_search_index_add (GtkTreeSearchIndex *index,
+                            const gchar        *text,
+                            GtkTreePath        *path)
+{
+  SearchRow row;
+
+  g_return_if_fail (index != NULL);
+  g_return_if_fail (text != NULL);
+  g_return_if_fail (path != NULL);
+
+  row.key = search_index_fold (text);
+  if (row.key == NULL)
+    {
+      gtk_tree_path_free (path);
+      return;
+    }
+
+  row.path = path;
+  g_array_append_val (index->rows, row);
+}
+
+static gint
+compare_rows (gconstpointer a,
+              gconstpointer b,
+              gpointer      user_data)
+{
+  GArray *rows = user_data;
+  const SearchRow *row_a = &g_array_index (rows, SearchRow, *(const guint *) a);
+  const SearchRow *row_b = &g_array_index (rows, SearchRow, *(const guint *) b);
+  gint result;
+
+  result = strcmp (row_a->key, row_b->key);
+  if (result != 0)
+    return result;
+
+  return (*(const guint *) a < *(const guint *) b) ? -1 : 1;
+}
+
+static void
+search_index_sort (GtkTreeSearchIndex *index)
+{
+  guint i;
+
+  g_array_set_size (index->sorted, index->rows->len);
+  for (i = 0; i < index->rows->len; i++)
+    g_array_index (index->sorted, guint, i) = i;
+
+  g_array_sort_with_data (index->sorted, compare_rows, index->rows);
+  index->sorted_valid = TRUE;
+}
+
+void
+_gtk_tree_search_index_finish (GtkTreeSearchIndex *index)
+{
+  g_return_if_fail (index != NULL);
+
+  search_index_sort (index);
+  index->n_updates = 0;
+}
+
+/* Returns the position of the first row that does not come before
+ * @path in display order.
+ */
+static guint
+search_index_find (GtkTreeSearchIndex *index,
+                   GtkTreePath        *path)
+{
+  guint lo, hi;
+
+  lo = 0;
+  hi = index->rows->len;
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (gtk_tree_path_compare (g_array_index (index->rows, SearchRow, mid).path, path) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+/* Returns the position of the first row from @pos on that is not a
+ * descendant of @path.
+ */
+static guint
+search_index_skip_descendants (GtkTreeSearchIndex *index,
+                               guint               pos,
+                               GtkTreePath        *path)
+{
+  while (pos < index->rows->len &&
+         gtk_tree_path_is_ancestor (path, g_array_index (index->rows, SearchRow, pos).path))
+    pos++;
+
+  return pos;
+}
+
+/* Moves the rows from @pos on that are siblings of @path, or their
+ * descendants, by @delta positions.
+ */
+static void
+search_index_shift_siblings (GtkTreeSearchIndex *index,
+                             guint               pos,
+                             GtkTreePath        *path,
+                             gint                delta)
+{
+  gint depth = gtk_tree_path_get_depth (path);
+  gint *indices = gtk_tree_path_get_indices (path);
+
+  for (; pos < index->rows->len; pos++)
+    {
+      GtkTreePath *row_path = g_array_index (index->rows, SearchRow, pos).path;
+      gint *row_indices = gtk_tree_path_get_indices (row_path);
+
+      if (gtk_tree_path_get_depth (row_path) < depth ||
+          memcmp (row_indices, indices, (depth - 1) * sizeof (gint)) != 0)
+        break;
+
+      row_indices[depth - 1] += delta;
+    }
+
+  index->n_updates++;
+}
+
+static void
+search_index_reset_candidates (GtkTreeSearchIndex *index)
+{
+  g_array_set_size (index->candidates, 0);
+  g_clear_pointer (&index->last_key, g_free);
+}
+
+/* The sorted table refers to rows by position, which the
+ * caller is about to change
+ */
+static void
+search_index_updated (GtkTreeSearchIndex *index)
+{
+  index->sorted_valid = FALSE;
+  index->n_updates++;
+
+  search_index_reset_candidates (index);
+}
+
+static void
+search_index_remove_range (GtkTreeSearchIndex *index,
+                           guint               first,
+                           guint               last)
+{
+  if (last == first)
+    return;
+
+  g_array_remove_range (index->rows, first, last - first);
+  search_index_updated (index);
+}
+
+/* Inserts @n_rows rows at @pos, taking ownership of their contents */
+static void
+search_index_insert_range (GtkTreeSearchIndex *index,
+                           guint               pos,
+                           const SearchRow    *rows,
+                           guint               n_rows)
+{
+  if (n_rows == 0)
+    return;
+
+  g_array_insert_vals (index->rows, pos, rows, n_rows);
+  search_index_updated (index);
+}
+
+/* Sets the text of the row at @path, adding it if it isn't in the
+ * index yet. A %NULL @text removes the row. @path is copied.
+ */
+void
+_gtk_tree_search_index_set_row (GtkTreeSearchIndex *index,
+                                GtkTreePath        *path,
+                                const gchar        *text)
+{
+  SearchRow row;
+  guint pos;
+
+  g_return_if_fail (index != NULL);
+  g_return_if_fail (path != NULL);
+
+  pos = search_index_find (index, path);
+  if (pos < index->rows->len &&
+      gtk_tree_path_compare (g_array_index (index->rows, SearchRow, pos).path, path) == 0)
+    search_index_remove_range (index, pos, pos + 1);
+
+  if (text == NULL)
+    return;
+
+  row.key = search_index_fold (text);
+  if (row.key == NULL)
+    return;
+
+  row.path = gtk_tree_path_copy (path);
+  search_index_insert_range (index, pos, &row, 1);
+}
+
+/* Renumbers the rows after @path, which was just inserted into the
+ * model. The row itself is added with _gtk_tree_search_index_set_row().
+ */
+void
+_gtk_tree_search_index_row_inserted (GtkTreeSearchIndex *index,
+                                     GtkTreePath        *path)
+{
+  g_return_if_fail (index != NULL);
+  g_return_if_fail (path != NULL);
+
+  search_index_shift_siblings (index, search_index_find (index, path), path, 1);
+}
+
+/* Removes the row at @path and its descendants, and renumbers the
+ * rows after them.
+ */
+void
+_gtk_tree_search_index_row_deleted (GtkTreeSearchIndex *index,
+                                    GtkTreePath        *path)
+{
+  guint first, last;
+
+  g_return_if_fail (index != NULL);
+  g_return_if_fail (path != NULL);
+
+  first = search_index_find (index, path);
+  last = first;
+  if (last < index->rows->len &&
+      gtk_tree_path_compare (g_array_index (index->rows, SearchRow, last).path, path) == 0)
+    last++;
+  last = search_index_skip_descendants (index, last, path);
+
+  search_index_remove_range (index, first, last);
+  search_index_shift_siblings (index, first, path, -1);
+}
+
+/* Removes the descendants of the row at @path, which was collapsed */
+void
+_gtk_tree_search_index_remove_children (GtkTreeSearchIndex *index,
+                                        GtkTreePath        *path)
+{
+  guint first;
+
+  g_return_if_fail (index != NULL);
+  g_return_if_fail (path != NULL);
+
+  first = search_index_find (index, path);
+  if (first < index->rows->len &&
+      gtk_tree_path_compare (g_array_index (index->rows, SearchRow, first).path, path) == 0)
+    first++;
+
+  search_index_remove_range (index, first,
+                             search_index_skip_descendants (index, first, path));
+}
+
+/* Moves the rows of @rows into @index and frees @rows. They must have
+ * been added to @rows in display order, follow each other in it, and
+ * not be in @index yet, like the children of a row that was expanded.
+ */
+void
+_gtk_tree_search_index_insert_rows (GtkTreeSearchIndex *index,
+                                    GtkTreeSearchIndex *rows)
+{
+  g_return_if_fail (index != NULL);
+  g_return_if_fail (rows != NULL);
+
+  if (rows->rows->len > 0)
+    {
+      search_index_insert_range (index,
+                                 search_index_find (index, g_array_index (rows->rows, SearchRow, 0).path),
+                                 (const SearchRow *) rows->rows->data,
+                                 rows->rows->len);
+
+      /* The contents of the rows belong to @index now */
+      g_array_set_clear_func (rows->rows, NULL);
+    }
+
+  _gtk_tree_search_index_free (rows);
+}
+
+guint
+_gtk_tree_search_index_get_n_rows (GtkTreeSearchIndex *index)
+{
+  g_return_val_if_fail (index != NULL, 0);
+
+  return index->rows->len;
+}
+
+/* Returns %TRUE if the index has been updated so often since it was
+ * built that the caller should drop it, and build a new one the next
+ * time it is needed.
+ */
+gboolean
+_gtk_tree_search_index_is_stale (GtkTreeSearchIndex *index)
+{
+  g_return_val_if_fail (index != NULL, FALSE);
+
+  return index->n_updates > SEARCH_INDEX_MAX_UPDATES;
+}
+
+static gint
+compare_guint (gconstpointer a,
+               gconstpointer b)
+{
+  guint ua = *(const guint *) a;
+  guint ub = *(const guint *) b;
+
+  return (ua > ub) - (ua < ub);
+}
+
+static void
+search_index_narrow (GtkTreeSearchIndex *index,
+                     const gchar        *key)
+{
+  guint i, j;
+
+  for (i = 0, j = 0; i < index->candidates->len; i++)
+    {
+      guint n = g_array_index (index->candidates, guint, i);
+      SearchRow *row = &g_array_index (index->rows, SearchRow, n);
+
+      if (g_str_has_prefix (row->key, key))
+        g_array_index (index->candidates, guint, j++) = n;
+    }
+
+  g_array_set_size (index->candidates, j);
+}
+
+static void
+search_index_collect (GtkTreeSearchIndex *index,
+                      const gchar        *key)
+{
+  guint lo, hi, i;
+
+  g_array_set_size (index->candidates, 0);
+
+  /* lower bound of @key in the sorted table */
+  lo = 0;
+  hi = index->sorted->len;
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+      guint n = g_array_index (index->sorted, guint, mid);
+
+      if (strcmp (g_array_index (index->rows, SearchRow, n).key, key) < 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  for (i = lo; i < index->sorted->len; i++)
+    {
+      guint n = g_array_index (index->sorted, guint, i);
+
+      if (!g_str_has_prefix (g_array_index (index->rows, SearchRow, n).key, key))
+        break;
+
+      g_array_append_val (index->candidates, n);
+    }
+
+  g_array_sort (index->candidates, compare_guint);
+}
+
+static void
+search_index_update_candidates (GtkTreeSearchIndex *index,
+                                const gchar        *key)
+{
+  gchar *folded;
+
+  folded = search_index_fold (key);
+  if (folded == NULL)
+    {
+      g_array_set_size (index->candidates, 0);
+      g_clear_pointer (&index->last_key, g_free);
+      return;
+    }
+
+  if (!index->sorted_valid)
+    search_index_sort (index);
+
+  if (index->last_key && strcmp (folded, index->last_key) == 0)
+    {
+      g_free (folded);
+      return;
+    }
+
+  if (index->last_key && g_str_has_prefix (folded, index->last_key))
+    search_index_narrow (index, folded);
+  else
+    search_index_collect (index, folded);
+
+  g_free (index->last_key);
+  index->last_key = folded;
+}
+
+/* Returns the number of rows whose key starts with @key. */
+guint
+_gtk_tree_search_index_count (GtkTreeSearchIndex *index,
+                              const gchar        *key)
+{
+  g_return_val_if_fail (index != NULL, 0);
+  g_return_val_if_fail (key != NULL, 0);
+
+  search_index_update_candidates (index, key);
+
+  return index->candidates->len;
+}
+
+/* Returns the @n-th (counting from 1, in display order) row whose
+ * key starts with @key, or %NULL. The path is owned by the index.
+ */
+GtkTreePath *
+_gtk_tree_search_index_lookup (GtkTreeSearchIndex *index,
+                               const gchar        *key,
+                               guint               n)
+{
+  guint row;
+
+  g_return_val_if_fail (index != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  search_index_update_candidates (index, key);
+
+  if (n < 1 || n > index->candidates->len)
+    return NULL;
+
+  row = g_array_index (index->candidates, guint, n - 1);
+
+  return g_array_index (index->rows, SearchRow, row).path;
+}
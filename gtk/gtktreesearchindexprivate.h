@@ -0,0 +1,54 @@
+/* GTK - The GIMP Toolkit
+ * Copyright (C) 2016 the GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_TREE_SEARCH_INDEX_PRIVATE_H__
+#define __GTK_TREE_SEARCH_INDEX_PRIVATE_H__
+
+#include <gtk/gtktreemodel.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkTreeSearchIndex GtkTreeSearchIndex;
+
+GtkTreeSearchIndex *_gtk_tree_search_index_new         (void);
+void                _gtk_tree_search_index_free        (GtkTreeSearchIndex *index);
+void                _gtk_tree_search_index_add         (GtkTreeSearchIndex *index,
+                                                        const gchar        *text,
+                                                        GtkTreePath        *path);
+void                _gtk_tree_search_index_finish      (GtkTreeSearchIndex *index);
+void                _gtk_tree_search_index_set_row     (GtkTreeSearchIndex *index,
+                                                        GtkTreePath        *path,
+                                                        const gchar        *text);
+void                _gtk_tree_search_index_row_inserted (GtkTreeSearchIndex *index,
+                                                        GtkTreePath        *path);
+void                _gtk_tree_search_index_row_deleted (GtkTreeSearchIndex *index,
+                                                        GtkTreePath        *path);
+void                _gtk_tree_search_index_remove_children (GtkTreeSearchIndex *index,
+                                                        GtkTreePath        *path);
+void                _gtk_tree_search_index_insert_rows (GtkTreeSearchIndex *index,
+                                                        GtkTreeSearchIndex *rows);
+guint               _gtk_tree_search_index_get_n_rows  (GtkTreeSearchIndex *index);
+gboolean            _gtk_tree_search_index_is_stale    (GtkTreeSearchIndex *index);
+guint               _gtk_tree_search_index_count       (GtkTreeSearchIndex *index,
+                                                        const gchar        *key);
+GtkTreePath *       _gtk_tree_search_index_lookup      (GtkTreeSearchIndex *index,
+                                                        const gchar        *key,
+                                                        guint               n);
+
+G_END_DECLS
+
+#endif /* __GTK_TREE_SEARCH_INDEX_PRIVATE_H__ */
@@ -55,6 +55,7 @@
 #include "gtksettingsprivate.h"
 #include "gtkwidgetpath.h"
 #include "gtkpixelcacheprivate.h"
+#include "gtktreesearchindexprivate.h"
 #include "a11y/gtktreeviewaccessibleprivate.h"
 
 
@@ -438,6 +439,7 @@ struct _GtkTreeViewPrivate
   GtkWidget *search_entry;
   gulong search_entry_changed_id;
   guint typeselect_flush_timeout;
+  GtkTreeSearchIndex *search_index;
 
   /* Grid and tree lines */
   GtkTreeViewGridLines grid_lines;
@@ -490,6 +492,10 @@ struct _GtkTreeViewPrivate
   guint enable_search : 1;
   guint disable_popdown : 1;
   guint search_custom_entry_set : 1;
+  guint search_indexed : 1;
+
+  /* rows left out of an autosize sample and not measured since */
+  guint n_width_unmeasured;
   
   guint hover_selection : 1;
   guint hover_expand : 1;
@@ -565,6 +571,7 @@ enum {
   PROP_ENABLE_TREE_LINES,
   PROP_TOOLTIP_COLUMN,
   PROP_ACTIVATE_ON_SINGLE_CLICK,
+  PROP_SEARCH_INDEXED,
   LAST_PROP,
   /* overridden */
   PROP_HADJUSTMENT = LAST_PROP,
@@ -705,6 +712,7 @@ static gboolean validate_row             (GtkTreeView *tree_view,
 					  GtkTreeIter *iter,
 					  GtkTreePath *path);
 static void     validate_visible_area    (GtkTreeView *tree_view);
+static gboolean measure_visible_rows     (GtkTreeView *tree_view);
 static gboolean do_validate_rows         (GtkTreeView *tree_view,
 					  gboolean     queue_resize);
 static gboolean validate_rows            (GtkTreeView *tree_view);
@@ -854,6 +862,21 @@ static gboolean gtk_tree_view_search_iter               (GtkTreeModel     *model
 							 const gchar      *text,
 							 gint             *count,
 							 gint              n);
+static gboolean gtk_tree_view_search_nth                (GtkTreeView      *tree_view,
+							 GtkTreeModel     *model,
+							 GtkTreeSelection *selection,
+							 GtkTreeIter      *iter,
+							 const gchar      *text,
+							 gint              n);
+static void     gtk_tree_view_search_index_invalidate   (GtkTreeView      *tree_view);
+static void     gtk_tree_view_search_index_check_stale  (GtkTreeView      *tree_view);
+static void     gtk_tree_view_search_index_update_row   (GtkTreeView      *tree_view,
+                                                         GtkTreePath      *path,
+                                                         GtkTreeIter      *iter);
+static void     gtk_tree_view_search_index_add_children (GtkTreeView      *tree_view,
+                                                         GtkTreePath      *path,
+                                                         GtkTreeIter      *iter,
+                                                         GtkRBTree        *tree);
 static void     gtk_tree_view_search_init               (GtkWidget        *entry,
 							 GtkTreeView      *tree_view);
 static void     gtk_tree_view_put                       (GtkTreeView      *tree_view,
@@ -1224,6 +1247,21 @@ gtk_tree_view_class_init (GtkTreeViewClass *class)
                             FALSE,
                             GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkTreeView:search-indexed:
+   *
+   * Whether the interactive search uses an index of the search column.
+   * See gtk_tree_view_set_search_indexed().
+   *
+   * Since: 3.22
+   */
+  tree_view_props[PROP_SEARCH_INDEXED] =
+      g_param_spec_boolean ("search-indexed",
+                            P_("Search Indexed"),
+                            P_("Whether interactive search uses an index of the search column"),
+                            FALSE,
+                            GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (o_class, LAST_PROP, tree_view_props);
 
   /* Style properties */
@@ -1994,6 +2032,9 @@ G_GNUC_END_IGNORE_DEPRECATIONS
     case PROP_ACTIVATE_ON_SINGLE_CLICK:
       gtk_tree_view_set_activate_on_single_click (tree_view, g_value_get_boolean (value));
       break;
+    case PROP_SEARCH_INDEXED:
+      gtk_tree_view_set_search_indexed (tree_view, g_value_get_boolean (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2078,6 +2119,9 @@ gtk_tree_view_get_property (GObject    *object,
     case PROP_ACTIVATE_ON_SINGLE_CLICK:
       g_value_set_boolean (value, tree_view->priv->activate_on_single_click);
       break;
+    case PROP_SEARCH_INDEXED:
+      g_value_set_boolean (value, tree_view->priv->search_indexed);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -2130,8 +2174,10 @@ static void
 gtk_tree_view_free_rbtree (GtkTreeView *tree_view)
 {
   _gtk_rbtree_free (tree_view->priv->tree);
+  gtk_tree_view_search_index_invalidate (tree_view);
 
   tree_view->priv->tree = NULL;
+  tree_view->priv->n_width_unmeasured = 0;
   tree_view->priv->button_pressed_node = NULL;
   tree_view->priv->button_pressed_tree = NULL;
   tree_view->priv->prelight_tree = NULL;
@@ -2219,6 +2265,8 @@ gtk_tree_view_destroy (GtkWidget *widget)
   gtk_tree_row_reference_free (tree_view->priv->anchor);
   tree_view->priv->anchor = NULL;
 
+  gtk_tree_view_search_index_invalidate (tree_view);
+
   /* destroy interactive search dialog */
   if (tree_view->priv->search_window)
     {
@@ -6309,6 +6357,97 @@ get_separator_height (GtkTreeView *tree_view)
   return min_size;
 }
 
+/* Autosized columns with an autosize sample only let the visible rows
+ * and every n-th row of the model contribute to their width, with n
+ * chosen so that about sample_size rows do. This is a fixed stride over
+ * the row indexes, not a random sample, so a model whose wide rows
+ * recur with the same period can be sized by its narrow ones until
+ * those rows are shown.
+ */
+static gboolean
+gtk_tree_view_is_sample_row (GtkTreeView *tree_view,
+                             GtkRBTree   *tree,
+                             GtkRBNode   *node,
+                             gint         sample_size)
+{
+  gdouble value, page_size;
+  gint offset;
+  guint stride;
+
+  value = gtk_adjustment_get_value (tree_view->priv->vadjustment);
+  page_size = gtk_adjustment_get_page_size (tree_view->priv->vadjustment);
+  offset = _gtk_rbtree_node_find_offset (tree, node);
+
+  if (offset + GTK_RBNODE_GET_HEIGHT (node) >= value &&
+      offset <= value + page_size)
+    return TRUE;
+
+  if (sample_size == 0)
+    return FALSE;
+
+  stride = MAX (1, tree_view->priv->tree->root->total_count / sample_size);
+
+  return _gtk_rbtree_node_get_index (tree, node) % stride == 0;
+}
+
+static void
+gtk_tree_view_set_width_unmeasured (GtkTreeView *tree_view,
+                                    GtkRBNode   *node,
+                                    gboolean     unmeasured)
+{
+  if ((GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_WIDTH_UNMEASURED) != 0) == unmeasured)
+    return;
+
+  if (unmeasured)
+    {
+      GTK_RBNODE_SET_FLAG (node, GTK_RBNODE_WIDTH_UNMEASURED);
+      tree_view->priv->n_width_unmeasured++;
+    }
+  else
+    {
+      GTK_RBNODE_UNSET_FLAG (node, GTK_RBNODE_WIDTH_UNMEASURED);
+      tree_view->priv->n_width_unmeasured--;
+    }
+}
+
+static void
+count_width_unmeasured_helper (GtkRBTree *tree,
+                               GtkRBNode *node,
+                               gpointer   data)
+{
+  if (node->children)
+    _gtk_rbtree_traverse (node->children, node->children->root, G_POST_ORDER, count_width_unmeasured_helper, data);
+  if (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_WIDTH_UNMEASURED))
+    (*((guint *)data))++;
+}
+
+/* Takes the rows of @tree, or @node and its children if it is not
+ * %NULL, out of the count before they are removed.
+ */
+static void
+gtk_tree_view_forget_width_unmeasured (GtkTreeView *tree_view,
+                                       GtkRBTree   *tree,
+                                       GtkRBNode   *node)
+{
+  guint count = 0;
+
+  if (tree_view->priv->n_width_unmeasured == 0)
+    return;
+
+  if (node == NULL)
+    _gtk_rbtree_traverse (tree, tree->root, G_POST_ORDER, count_width_unmeasured_helper, &count);
+  else
+    {
+      if (node->children)
+        _gtk_rbtree_traverse (node->children, node->children->root, G_POST_ORDER, count_width_unmeasured_helper, &count);
+      if (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_WIDTH_UNMEASURED))
+        count++;
+    }
+
+  g_assert (count <= tree_view->priv->n_width_unmeasured);
+  tree_view->priv->n_width_unmeasured -= count;
+}
+
 /* Returns TRUE if it updated the size
  */
 static gboolean
@@ -6330,6 +6469,7 @@ validate_row (GtkTreeView *tree_view,
   gboolean draw_vgrid_lines, draw_hgrid_lines;
   gint grid_line_width;
   gint expander_size;
+  gboolean width_unmeasured = FALSE;
 
   /* double check the row needs validating */
   if (! GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_INVALID) &&
@@ -6374,6 +6514,7 @@ validate_row (GtkTreeView *tree_view,
       gint original_width;
       gint new_width;
       gint row_height;
+      gint sample_size;
 
       column = list->data;
 
@@ -6389,9 +6530,18 @@ validate_row (GtkTreeView *tree_view,
       gtk_tree_view_column_cell_set_cell_data (column, tree_view->priv->model, iter,
 					       GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_IS_PARENT),
 					       node->children?TRUE:FALSE);
-      gtk_tree_view_column_cell_get_size (column,
-					  NULL, NULL, NULL,
-					  NULL, &row_height);
+
+      sample_size = _gtk_tree_view_column_get_sample_size (column);
+      if (sample_size >= 0 &&
+          !gtk_tree_view_is_sample_row (tree_view, tree, node, sample_size))
+        {
+          if (_gtk_tree_view_column_cell_get_height (column, &row_height))
+            width_unmeasured = TRUE;
+        }
+      else
+        gtk_tree_view_column_cell_get_size (column,
+                                            NULL, NULL, NULL,
+                                            NULL, &row_height);
 
       if (is_separator)
         {
@@ -6440,6 +6590,13 @@ validate_row (GtkTreeView *tree_view,
       retval = TRUE;
       _gtk_rbtree_node_set_height (tree, node, height);
     }
+
+  /* the widths get measured when the row is shown */
+  if (width_unmeasured)
+    gtk_tree_view_set_width_unmeasured (tree_view, node, TRUE);
+  else if (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_INVALID))
+    gtk_tree_view_set_width_unmeasured (tree_view, node, FALSE);
+
   _gtk_rbtree_node_mark_valid (tree, node);
   tree_view->priv->post_validation_flag = TRUE;
 
@@ -6467,7 +6624,11 @@ validate_visible_area (GtkTreeView *tree_view)
 
   if (! GTK_RBNODE_FLAG_SET (tree_view->priv->tree->root, GTK_RBNODE_DESCENDANTS_INVALID) &&
       tree_view->priv->scroll_to_path == NULL)
-    return;
+    {
+      if (measure_visible_rows (tree_view))
+        gtk_widget_queue_resize (GTK_WIDGET (tree_view));
+      return;
+    }
 
   gtk_widget_get_allocation (GTK_WIDGET (tree_view), &allocation);
   total_height = allocation.height - gtk_tree_view_get_effective_header_height (tree_view);
@@ -6781,6 +6942,9 @@ validate_visible_area (GtkTreeView *tree_view)
   else
     gtk_tree_view_top_row_to_dy (tree_view);
 
+  if (measure_visible_rows (tree_view))
+    size_changed = TRUE;
+
   /* update width/height and queue a resize */
   if (size_changed)
     {
@@ -6816,6 +6980,65 @@ validate_visible_area (GtkTreeView *tree_view)
     gtk_widget_queue_draw (GTK_WIDGET (tree_view));
 }
 
+/* Measures the widths of the shown rows that were left out of an
+ * autosize sample. Returns TRUE if that widened a column. Once no such
+ * rows are left, scrolling stops scheduling this.
+ */
+static gboolean
+measure_visible_rows (GtkTreeView *tree_view)
+{
+  GtkRBTree *tree;
+  GtkRBNode *node;
+  gint y, bottom;
+  gboolean widened = FALSE;
+
+  if (tree_view->priv->n_width_unmeasured == 0 || tree_view->priv->tree == NULL)
+    return FALSE;
+
+  y = TREE_WINDOW_Y_TO_RBTREE_Y (tree_view, 0);
+  bottom = y + gtk_adjustment_get_page_size (tree_view->priv->vadjustment);
+  y -= _gtk_rbtree_find_offset (tree_view->priv->tree, y, &tree, &node);
+
+  while (node != NULL && y < bottom &&
+         tree_view->priv->n_width_unmeasured > 0)
+    {
+      if (GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_WIDTH_UNMEASURED))
+        {
+          GtkTreePath *path;
+          GtkTreeIter iter;
+          GList *list;
+
+          path = _gtk_tree_path_new_from_rbtree (tree, node);
+          gtk_tree_model_get_iter (tree_view->priv->model, &iter, path);
+          gtk_tree_path_free (path);
+
+          for (list = tree_view->priv->columns; list; list = list->next)
+            {
+              GtkTreeViewColumn *column = list->data;
+
+              if (!gtk_tree_view_column_get_visible (column) ||
+                  _gtk_tree_view_column_get_sample_size (column) < 0)
+                continue;
+
+              gtk_tree_view_column_cell_set_cell_data (column,
+                                                       tree_view->priv->model,
+                                                       &iter,
+                                                       GTK_RBNODE_FLAG_SET (node, GTK_RBNODE_IS_PARENT),
+                                                       node->children ? TRUE : FALSE);
+              if (_gtk_tree_view_column_cell_sample_width (column))
+                widened = TRUE;
+            }
+
+          gtk_tree_view_set_width_unmeasured (tree_view, node, FALSE);
+        }
+
+      y += gtk_tree_view_get_row_height (tree_view, node);
+      _gtk_rbtree_next_full (tree, node, &tree, &node);
+    }
+
+  return widened;
+}
+
 static void
 initialize_fixed_height_mode (GtkTreeView *tree_view)
 {
@@ -6864,7 +7087,7 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
   gint retval = TRUE;
   GtkTreePath *path = NULL;
   GtkTreeIter iter;
-  GTimer *timer;
+  gint64 deadline;
   gint i = 0;
 
   gint y = -1;
@@ -6888,8 +7111,14 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
       return FALSE;
     }
 
-  timer = g_timer_new ();
-  g_timer_start (timer);
+  /* From the idle, stop early when the next frame is due, so that
+   * validation does not make us miss it while scrolling.
+   */
+  if (queue_resize)
+    deadline = gtk_widget_get_idle_deadline (GTK_WIDGET (tree_view),
+                                             GTK_TREE_VIEW_TIME_MS_PER_IDLE * 1000);
+  else
+    deadline = g_get_monotonic_time () + GTK_TREE_VIEW_TIME_MS_PER_IDLE * 1000;
 
   do
     {
@@ -6978,7 +7207,7 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
 
       i++;
     }
-  while (g_timer_elapsed (timer, NULL) < GTK_TREE_VIEW_TIME_MS_PER_IDLE / 1000.);
+  while (g_get_monotonic_time () < deadline);
 
   if (!tree_view->priv->fixed_height_check)
    {
@@ -7029,7 +7258,6 @@ do_validate_rows (GtkTreeView *tree_view, gboolean queue_resize)
     }
 
   if (path) gtk_tree_path_free (path);
-  g_timer_destroy (timer);
 
   if (!retval && gtk_widget_get_mapped (GTK_WIDGET (tree_view)))
     update_prelight (tree_view,
@@ -8996,6 +9224,8 @@ gtk_tree_view_row_changed (GtkTreeModel *model,
   if (tree == NULL)
     goto done;
 
+  gtk_tree_view_search_index_update_row (tree_view, path, iter);
+
   _gtk_tree_view_accessible_changed (tree_view, tree, node);
 
   if (tree_view->priv->fixed_height_mode
@@ -9128,6 +9358,12 @@ gtk_tree_view_row_inserted (GtkTreeModel *model,
 
   _gtk_tree_view_accessible_add (tree_view, tree, tmpnode);
 
+  if (tree_view->priv->search_index)
+    {
+      _gtk_tree_search_index_row_inserted (tree_view->priv->search_index, path);
+      gtk_tree_view_search_index_update_row (tree_view, path, iter);
+    }
+
  done:
   if (height > 0)
     {
@@ -9270,6 +9506,12 @@ gtk_tree_view_row_deleted (GtkTreeModel *model,
   if (tree == NULL)
     return;
 
+  if (tree_view->priv->search_index)
+    {
+      _gtk_tree_search_index_row_deleted (tree_view->priv->search_index, path);
+      gtk_tree_view_search_index_check_stale (tree_view);
+    }
+
   /* check if the selection has been changed */
   _gtk_rbtree_traverse (tree, node, G_POST_ORDER,
                         check_selection_helper, &selection_changed);
@@ -9340,6 +9582,8 @@ gtk_tree_view_row_deleted (GtkTreeModel *model,
       tree_view->priv->destroy_count_func (tree_view, path, child_count, tree_view->priv->destroy_count_data);
     }
 
+  gtk_tree_view_forget_width_unmeasured (tree_view, tree, node);
+
   if (tree->root->count == 1)
     {
       if (tree_view->priv->tree == tree)
@@ -9399,6 +9643,8 @@ gtk_tree_view_rows_reordered (GtkTreeModel *model,
   if (len < 2)
     return;
 
+  gtk_tree_view_search_index_invalidate (tree_view);
+
   gtk_tree_row_reference_reordered (G_OBJECT (data),
 				    parent,
 				    iter,
@@ -11362,6 +11608,13 @@ gtk_tree_view_adjustment_changed (GtkAdjustment *adjustment,
           if (!tree_view->priv->in_top_row_to_dy)
             gtk_tree_view_dy_to_top_row (tree_view);
 
+          /* rows left out of an autosize sample may have scrolled
+           * into view, measure them before the next layout
+           */
+          if (tree_view->priv->n_width_unmeasured > 0 &&
+              tree_view->priv->presize_handler_tick_cb == 0)
+            tree_view->priv->presize_handler_tick_cb =
+              gtk_widget_add_tick_callback (GTK_WIDGET (tree_view), presize_handler_callback, NULL, NULL);
         }
     }
 }
@@ -12869,6 +13122,8 @@ gtk_tree_view_real_expand_row (GtkTreeView *tree_view,
 			    gtk_tree_path_get_depth (path) + 1,
 			    open_all);
 
+  gtk_tree_view_search_index_add_children (tree_view, path, &iter, node->children);
+
   _gtk_tree_view_accessible_add (tree_view, node->children, NULL);
   _gtk_tree_view_accessible_add_state (tree_view,
                                        tree, node,
@@ -13025,6 +13280,13 @@ gtk_tree_view_real_collapse_row (GtkTreeView *tree_view,
                                           tree, node,
                                           GTK_CELL_RENDERER_EXPANDED);
 
+  if (tree_view->priv->search_index)
+    {
+      _gtk_tree_search_index_remove_children (tree_view->priv->search_index, path);
+      gtk_tree_view_search_index_check_stale (tree_view);
+    }
+
+  gtk_tree_view_forget_width_unmeasured (tree_view, node->children, NULL);
   _gtk_rbtree_remove (node->children);
 
   if (cursor_changed)
@@ -14868,6 +15130,7 @@ gtk_tree_view_set_search_column (GtkTreeView *tree_view,
     return;
 
   tree_view->priv->search_column = column;
+  gtk_tree_view_search_index_invalidate (tree_view);
   g_object_notify_by_pspec (G_OBJECT (tree_view), tree_view_props[PROP_SEARCH_COLUMN]);
 }
 
@@ -14916,6 +15179,62 @@ gtk_tree_view_set_search_equal_func (GtkTreeView                *tree_view,
   tree_view->priv->search_destroy = search_destroy;
   if (tree_view->priv->search_equal_func == NULL)
     tree_view->priv->search_equal_func = gtk_tree_view_search_equal_func;
+  gtk_tree_view_search_index_invalidate (tree_view);
+}
+
+/**
+ * gtk_tree_view_set_search_indexed:
+ * @tree_view: A #GtkTreeView
+ * @indexed: %TRUE to index the search column
+ *
+ * Sets whether the interactive search keeps an index of the search
+ * column. The index holds the normalized, casefolded text of every
+ * visible row, so that finding a match does not require scanning
+ * the model on each keystroke. It is built when a search starts and
+ * kept up to date as rows are inserted, changed, deleted, expanded
+ * or collapsed. It is built again when the model is reordered.
+ *
+ * This is only worth enabling for views with many rows. The index
+ * is not used while a custom search equal function is set with
+ * gtk_tree_view_set_search_equal_func().
+ *
+ * Since: 3.22
+ */
+void
+gtk_tree_view_set_search_indexed (GtkTreeView *tree_view,
+                                  gboolean     indexed)
+{
+  g_return_if_fail (GTK_IS_TREE_VIEW (tree_view));
+
+  indexed = indexed != FALSE;
+
+  if (tree_view->priv->search_indexed == indexed)
+    return;
+
+  tree_view->priv->search_indexed = indexed;
+  if (!indexed)
+    gtk_tree_view_search_index_invalidate (tree_view);
+
+  g_object_notify_by_pspec (G_OBJECT (tree_view), tree_view_props[PROP_SEARCH_INDEXED]);
+}
+
+/**
+ * gtk_tree_view_get_search_indexed:
+ * @tree_view: A #GtkTreeView
+ *
+ * Returns whether the interactive search keeps an index of the
+ * search column. See gtk_tree_view_set_search_indexed().
+ *
+ * Returns: %TRUE if the search column is indexed
+ *
+ * Since: 3.22
+ */
+gboolean
+gtk_tree_view_get_search_indexed (GtkTreeView *tree_view)
+{
+  g_return_val_if_fail (GTK_IS_TREE_VIEW (tree_view), FALSE);
+
+  return tree_view->priv->search_indexed;
 }
 
 /**
@@ -15354,7 +15673,6 @@ gtk_tree_view_search_move (GtkWidget   *window,
 {
   gboolean ret;
   gint len;
-  gint count = 0;
   const gchar *text;
   GtkTreeIter iter;
   GtkTreeModel *model;
@@ -15380,8 +15698,8 @@ gtk_tree_view_search_move (GtkWidget   *window,
   if (!gtk_tree_model_get_iter_first (model, &iter))
     return TRUE;
 
-  ret = gtk_tree_view_search_iter (model, selection, &iter, text,
-				   &count, up?((tree_view->priv->selected_iter) - 1):((tree_view->priv->selected_iter + 1)));
+  ret = gtk_tree_view_search_nth (tree_view, model, selection, &iter, text,
+				  up?((tree_view->priv->selected_iter) - 1):((tree_view->priv->selected_iter + 1)));
 
   if (ret)
     {
@@ -15392,11 +15710,10 @@ gtk_tree_view_search_move (GtkWidget   *window,
   else
     {
       /* return to old iter */
-      count = 0;
       gtk_tree_model_get_iter_first (model, &iter);
-      gtk_tree_view_search_iter (model, selection,
-				 &iter, text,
-				 &count, tree_view->priv->selected_iter);
+      gtk_tree_view_search_nth (tree_view, model, selection,
+				&iter, text,
+				tree_view->priv->selected_iter);
       return FALSE;
     }
 }
@@ -15562,12 +15879,223 @@ gtk_tree_view_search_iter (GtkTreeModel     *model,
   return FALSE;
 }
 
+static void
+gtk_tree_view_search_index_invalidate (GtkTreeView *tree_view)
+{
+  g_clear_pointer (&tree_view->priv->search_index, _gtk_tree_search_index_free);
+}
+
+/* Drops the index after a burst of model changes, when building a new
+ * one on the next search is cheaper than keeping this one up to date.
+ */
+static void
+gtk_tree_view_search_index_check_stale (GtkTreeView *tree_view)
+{
+  if (tree_view->priv->search_index &&
+      _gtk_tree_search_index_is_stale (tree_view->priv->search_index))
+    gtk_tree_view_search_index_invalidate (tree_view);
+}
+
+/* Returns the text of the search column in the row at @iter,
+ * or %NULL if it has none.
+ */
+static gchar *
+gtk_tree_view_search_index_get_text (GtkTreeView *tree_view,
+                                     GtkTreeIter *iter)
+{
+  GValue value = G_VALUE_INIT;
+  GValue transformed = G_VALUE_INIT;
+  gchar *text = NULL;
+
+  gtk_tree_model_get_value (tree_view->priv->model, iter,
+                            tree_view->priv->search_column, &value);
+  g_value_init (&transformed, G_TYPE_STRING);
+
+  if (g_value_transform (&value, &transformed))
+    text = g_value_dup_string (&transformed);
+
+  g_value_unset (&transformed);
+  g_value_unset (&value);
+
+  return text;
+}
+
+static void
+gtk_tree_view_search_index_add_level (GtkTreeView        *tree_view,
+                                      GtkTreeSearchIndex *index,
+                                      GtkRBTree          *tree,
+                                      GtkTreeIter        *iter,
+                                      GtkTreePath        *path)
+{
+  GtkTreeModel *model = tree_view->priv->model;
+  GtkRBNode *node;
+
+  for (node = _gtk_rbtree_first (tree); node; node = _gtk_rbtree_next (tree, node))
+    {
+      gchar *text;
+
+      text = gtk_tree_view_search_index_get_text (tree_view, iter);
+      if (text != NULL)
+        _gtk_tree_search_index_add (index, text, gtk_tree_path_copy (path));
+      g_free (text);
+
+      if (node->children)
+        {
+          GtkTreeIter child;
+
+          if (gtk_tree_model_iter_children (model, &child, iter))
+            {
+              gtk_tree_path_down (path);
+              gtk_tree_view_search_index_add_level (tree_view, index,
+                                                    node->children,
+                                                    &child, path);
+              gtk_tree_path_up (path);
+            }
+        }
+
+      if (!gtk_tree_model_iter_next (model, iter))
+        break;
+      gtk_tree_path_next (path);
+    }
+}
+
+/* Updates the text of the shown row at @path, if there is an index */
+static void
+gtk_tree_view_search_index_update_row (GtkTreeView *tree_view,
+                                       GtkTreePath *path,
+                                       GtkTreeIter *iter)
+{
+  GtkTreeIter real_iter;
+  gchar *text;
+
+  if (tree_view->priv->search_index == NULL)
+    return;
+
+  if (iter == NULL)
+    {
+      if (!gtk_tree_model_get_iter (tree_view->priv->model, &real_iter, path))
+        return;
+      iter = &real_iter;
+    }
+
+  text = gtk_tree_view_search_index_get_text (tree_view, iter);
+  _gtk_tree_search_index_set_row (tree_view->priv->search_index, path, text);
+  g_free (text);
+
+  gtk_tree_view_search_index_check_stale (tree_view);
+}
+
+/* Adds the rows of @tree, the children of the row at @path that
+ * was just expanded, if there is an index.
+ */
+static void
+gtk_tree_view_search_index_add_children (GtkTreeView *tree_view,
+                                         GtkTreePath *path,
+                                         GtkTreeIter *iter,
+                                         GtkRBTree   *tree)
+{
+  GtkTreeSearchIndex *children;
+  GtkTreePath *child_path;
+  GtkTreeIter child;
+
+  if (tree_view->priv->search_index == NULL ||
+      !gtk_tree_model_iter_children (tree_view->priv->model, &child, iter))
+    return;
+
+  children = _gtk_tree_search_index_new ();
+  child_path = gtk_tree_path_copy (path);
+  gtk_tree_path_down (child_path);
+  gtk_tree_view_search_index_add_level (tree_view, children, tree, &child, child_path);
+  gtk_tree_path_free (child_path);
+
+  _gtk_tree_search_index_insert_rows (tree_view->priv->search_index, children);
+  gtk_tree_view_search_index_check_stale (tree_view);
+}
+
+/* Returns the index of the search column, building it if needed,
+ * or %NULL if the interactive search has to scan the model.
+ */
+static GtkTreeSearchIndex *
+gtk_tree_view_get_search_index (GtkTreeView *tree_view)
+{
+  GtkTreeViewPrivate *priv = tree_view->priv;
+  GtkTreeIter iter;
+  GtkTreePath *path;
+
+  if (!priv->search_indexed ||
+      priv->search_equal_func != gtk_tree_view_search_equal_func ||
+      priv->search_column < 0 ||
+      priv->model == NULL ||
+      priv->tree == NULL)
+    return NULL;
+
+  if (priv->search_index)
+    return priv->search_index;
+
+  priv->search_index = _gtk_tree_search_index_new ();
+
+  if (gtk_tree_model_get_iter_first (priv->model, &iter))
+    {
+      path = gtk_tree_path_new_first ();
+      gtk_tree_view_search_index_add_level (tree_view, priv->search_index,
+                                            priv->tree, &iter, path);
+      gtk_tree_path_free (path);
+    }
+
+  _gtk_tree_search_index_finish (priv->search_index);
+
+  return priv->search_index;
+}
+
+/* Selects the @n-th row matching @text, counting from the row
+ * @iter points to, which must be the first row of the model.
+ */
+static gboolean
+gtk_tree_view_search_nth (GtkTreeView      *tree_view,
+                          GtkTreeModel     *model,
+                          GtkTreeSelection *selection,
+                          GtkTreeIter      *iter,
+                          const gchar      *text,
+                          gint              n)
+{
+  GtkTreeSearchIndex *index;
+  GtkTreePath *path;
+  gint count = 0;
+
+  index = gtk_tree_view_get_search_index (tree_view);
+  if (index == NULL)
+    return gtk_tree_view_search_iter (model, selection, iter, text, &count, n);
+
+  if (n < 1)
+    return FALSE;
+
+  path = _gtk_tree_search_index_lookup (index, text, n);
+  if (path == NULL)
+    return FALSE;
+
+  /* Selecting may run arbitrary handlers that invalidate the index */
+  path = gtk_tree_path_copy (path);
+
+  if (!gtk_tree_model_get_iter (model, iter, path))
+    {
+      gtk_tree_path_free (path);
+      return FALSE;
+    }
+
+  gtk_tree_view_scroll_to_cell (tree_view, path, NULL, TRUE, 0.5, 0.0);
+  gtk_tree_selection_select_iter (selection, iter);
+  gtk_tree_view_real_set_cursor (tree_view, path, CLAMP_NODE);
+
+  gtk_tree_path_free (path);
+
+  return TRUE;
+}
+
 static void
 gtk_tree_view_search_init (GtkWidget   *entry,
 			   GtkTreeView *tree_view)
 {
   gint ret;
-  gint count = 0;
   const gchar *text;
   GtkTreeIter iter;
   GtkTreeModel *model;
@@ -15600,9 +16128,8 @@ gtk_tree_view_search_init (GtkWidget   *entry,
   if (!gtk_tree_model_get_iter_first (model, &iter))
     return;
 
-  ret = gtk_tree_view_search_iter (model, selection,
-				   &iter, text,
-				   &count, 1);
+  ret = gtk_tree_view_search_nth (tree_view, model, selection,
+				  &iter, text, 1);
 
   if (ret)
     tree_view->priv->selected_iter = 1;
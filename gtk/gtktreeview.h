@@ -452,6 +452,11 @@ void                       gtk_tree_view_set_search_equal_func (GtkTreeView
 								GtkTreeViewSearchEqualFunc  search_equal_func,
 								gpointer                    search_user_data,
 								GDestroyNotify              search_destroy);
+GDK_AVAILABLE_IN_3_22
+void                       gtk_tree_view_set_search_indexed    (GtkTreeView                *tree_view,
+								gboolean                    indexed);
+GDK_AVAILABLE_IN_3_22
+gboolean                   gtk_tree_view_get_search_indexed    (GtkTreeView                *tree_view);
 
 GDK_AVAILABLE_IN_ALL
 GtkEntry                     *gtk_tree_view_get_search_entry         (GtkTreeView                   *tree_view);
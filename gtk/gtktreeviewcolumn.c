@@ -144,6 +144,7 @@ struct _GtkTreeViewColumnPrivate
   gint fixed_width;
   gint min_width;
   gint max_width;
+  gint autosize_sample;
 
   /* dragging columns */
   gint drag_x;
@@ -197,6 +198,7 @@ enum
   PROP_SORT_ORDER,
   PROP_SORT_COLUMN_ID,
   PROP_CELL_AREA,
+  PROP_AUTOSIZE_SAMPLE,
   LAST_PROP
 };
 
@@ -401,6 +403,23 @@ gtk_tree_view_column_class_init (GtkTreeViewColumnClass *class)
                            GTK_TYPE_CELL_AREA,
                            GTK_PARAM_READWRITE|G_PARAM_CONSTRUCT_ONLY);
 
+  /**
+   * GtkTreeViewColumn:autosize-sample:
+   *
+   * The number of rows, besides the visible ones, whose cells are
+   * measured to find the width of an autosized column, or -1 to
+   * measure all rows.
+   *
+   * Since: 3.22
+   */
+  tree_column_props[PROP_AUTOSIZE_SAMPLE] =
+      g_param_spec_int ("autosize-sample",
+                        P_("Autosize sample"),
+                        P_("Number of rows measured to autosize the column"),
+                        -1, G_MAXINT,
+                        -1,
+                        GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, LAST_PROP, tree_column_props);
 }
 
@@ -443,6 +462,7 @@ gtk_tree_view_column_init (GtkTreeViewColumn *tree_column)
   priv->padding = 0;
   priv->min_width = -1;
   priv->max_width = -1;
+  priv->autosize_sample = -1;
   priv->column_type = GTK_TREE_VIEW_COLUMN_GROW_ONLY;
   priv->visible = TRUE;
   priv->resizable = FALSE;
@@ -574,6 +594,11 @@ gtk_tree_view_column_set_property (GObject         *object,
                                           g_value_get_int (value));
       break;
 
+    case PROP_AUTOSIZE_SAMPLE:
+      gtk_tree_view_column_set_autosize_sample (tree_column,
+                                                g_value_get_int (value));
+      break;
+
     case PROP_SPACING:
       gtk_tree_view_column_set_spacing (tree_column,
 					g_value_get_int (value));
@@ -704,6 +729,11 @@ gtk_tree_view_column_get_property (GObject         *object,
                        gtk_tree_view_column_get_max_width (tree_column));
       break;
 
+    case PROP_AUTOSIZE_SAMPLE:
+      g_value_set_int (value,
+                       gtk_tree_view_column_get_autosize_sample (tree_column));
+      break;
+
     case PROP_TITLE:
       g_value_set_string (value,
                           gtk_tree_view_column_get_title (tree_column));
@@ -2317,6 +2347,62 @@ gtk_tree_view_column_get_max_width (GtkTreeViewColumn *tree_column)
   return tree_column->priv->max_width;
 }
 
+/**
+ * gtk_tree_view_column_set_autosize_sample:
+ * @tree_column: A #GtkTreeViewColumn.
+ * @n_rows: The number of rows to sample, or -1.
+ *
+ * Limits the rows that are measured to find the width of a
+ * #GTK_TREE_VIEW_COLUMN_AUTOSIZE column. The visible rows and @n_rows
+ * rows spread evenly over the model are measured; other rows only
+ * widen the column once they get drawn. This keeps the column from
+ * changing its width over and over while a large model is validated.
+ *
+ * If @n_rows is -1, all rows are measured.
+ *
+ * Since: 3.22
+ **/
+void
+gtk_tree_view_column_set_autosize_sample (GtkTreeViewColumn *tree_column,
+                                          gint               n_rows)
+{
+  GtkTreeViewColumnPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TREE_VIEW_COLUMN (tree_column));
+  g_return_if_fail (n_rows >= -1);
+
+  priv = tree_column->priv;
+
+  if (n_rows == priv->autosize_sample)
+    return;
+
+  priv->autosize_sample = n_rows;
+
+  if (priv->column_type == GTK_TREE_VIEW_COLUMN_AUTOSIZE)
+    _gtk_tree_view_column_cell_set_dirty (tree_column, TRUE);
+
+  g_object_notify_by_pspec (G_OBJECT (tree_column), tree_column_props[PROP_AUTOSIZE_SAMPLE]);
+}
+
+/**
+ * gtk_tree_view_column_get_autosize_sample:
+ * @tree_column: A #GtkTreeViewColumn.
+ *
+ * Returns the number of rows sampled to autosize @tree_column, see
+ * gtk_tree_view_column_set_autosize_sample().
+ *
+ * Returns: the number of sampled rows, or -1 if all rows are measured
+ *
+ * Since: 3.22
+ **/
+gint
+gtk_tree_view_column_get_autosize_sample (GtkTreeViewColumn *tree_column)
+{
+  g_return_val_if_fail (GTK_IS_TREE_VIEW_COLUMN (tree_column), -1);
+
+  return tree_column->priv->autosize_sample;
+}
+
 /**
  * gtk_tree_view_column_clicked:
  * @tree_column: a #GtkTreeViewColumn
@@ -2876,6 +2962,85 @@ gtk_tree_view_column_cell_get_size (GtkTreeViewColumn  *tree_column,
 
 }
 
+/* Returns the number of rows to sample for the width of the column,
+ * or -1 if every row must be measured.
+ */
+gint
+_gtk_tree_view_column_get_sample_size (GtkTreeViewColumn *tree_column)
+{
+  GtkTreeViewColumnPrivate *priv = tree_column->priv;
+
+  if (priv->column_type != GTK_TREE_VIEW_COLUMN_AUTOSIZE ||
+      priv->fixed_width != -1)
+    return -1;
+
+  return priv->autosize_sample;
+}
+
+/* Like gtk_tree_view_column_cell_get_size(), but measures the height
+ * of the current cell data for the current width of the column,
+ * without letting the cells widen the column. Returns %FALSE if the
+ * column has no width yet, in which case the cells were measured
+ * normally.
+ */
+gboolean
+_gtk_tree_view_column_cell_get_height (GtkTreeViewColumn *tree_column,
+                                       gint              *height)
+{
+  GtkTreeViewColumnPrivate *priv = tree_column->priv;
+  gint min_width = 0;
+
+  gtk_cell_area_context_get_preferred_width (priv->cell_area_context, &min_width, NULL);
+
+  if (min_width <= 0)
+    {
+      gtk_tree_view_column_cell_get_size (tree_column, NULL, NULL, NULL, NULL, height);
+      return FALSE;
+    }
+
+  g_signal_handler_block (priv->cell_area_context,
+			  priv->context_changed_signal);
+
+  gtk_cell_area_get_preferred_height_for_width (priv->cell_area,
+                                                priv->cell_area_context,
+                                                priv->tree_view,
+                                                min_width,
+                                                height,
+                                                NULL);
+
+  g_signal_handler_unblock (priv->cell_area_context,
+			    priv->context_changed_signal);
+
+  return TRUE;
+}
+
+/* Measures the width of the current cell data, returns %TRUE if
+ * that made the column wider.
+ */
+gboolean
+_gtk_tree_view_column_cell_sample_width (GtkTreeViewColumn *tree_column)
+{
+  GtkTreeViewColumnPrivate *priv = tree_column->priv;
+  gint old_width, new_width;
+
+  gtk_cell_area_context_get_preferred_width (priv->cell_area_context, &old_width, NULL);
+
+  g_signal_handler_block (priv->cell_area_context,
+			  priv->context_changed_signal);
+
+  gtk_cell_area_get_preferred_width (priv->cell_area,
+                                     priv->cell_area_context,
+                                     priv->tree_view,
+                                     NULL, NULL);
+
+  g_signal_handler_unblock (priv->cell_area_context,
+			    priv->context_changed_signal);
+
+  gtk_cell_area_context_get_preferred_width (priv->cell_area_context, &new_width, NULL);
+
+  return new_width > old_width;
+}
+
 /**
  * gtk_tree_view_column_cell_render:
  * @tree_column: A #GtkTreeViewColumn.
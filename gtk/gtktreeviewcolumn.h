@@ -178,6 +178,11 @@ void                    gtk_tree_view_column_set_max_width       (GtkTreeViewCol
 								  gint                     max_width);
 GDK_AVAILABLE_IN_ALL
 gint                    gtk_tree_view_column_get_max_width       (GtkTreeViewColumn       *tree_column);
+GDK_AVAILABLE_IN_3_22
+void                    gtk_tree_view_column_set_autosize_sample (GtkTreeViewColumn       *tree_column,
+								  gint                     n_rows);
+GDK_AVAILABLE_IN_3_22
+gint                    gtk_tree_view_column_get_autosize_sample (GtkTreeViewColumn       *tree_column);
 GDK_AVAILABLE_IN_ALL
 void                    gtk_tree_view_column_clicked             (GtkTreeViewColumn       *tree_column);
 
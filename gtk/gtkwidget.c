@@ -70,6 +70,8 @@
 #include "gtkgestureprivate.h"
 #include "gtkwidgetpathprivate.h"
 
+#include "gdk/gdk-private.h"
+
 /* for the use of round() */
 #include "fallback-c89.c"
 
@@ -824,12 +826,16 @@ static void gtk_widget_on_frame_clock_update (GdkFrameClock *frame_clock,
 static gboolean event_window_is_still_viewable (GdkEvent *event);
 
 static void gtk_widget_update_input_shape (GtkWidget *widget);
+static void gtk_widget_invalidate_render_cache (GtkWidget *widget);
+static void gtk_widget_render_cache_child_added (GtkWidget *child);
+static void gtk_widget_render_cache_child_removed (GtkWidget *old_parent);
 
 /* --- variables --- */
 static gint             GtkWidget_private_offset = 0;
 static gpointer         gtk_widget_parent_class = NULL;
 static guint            widget_signals[LAST_SIGNAL] = { 0 };
 static guint            composite_child_stack = 0;
+static guint            n_render_cache_widgets = 0;
 GtkTextDirection gtk_default_direction = GTK_TEXT_DIR_LTR;
 static GParamSpecPool  *style_property_spec_pool = NULL;
 
@@ -4641,6 +4647,8 @@ gtk_widget_unparent (GtkWidget *widget)
   old_parent = priv->parent;
   priv->parent = NULL;
 
+  gtk_widget_render_cache_child_removed (old_parent);
+
   /* parent may no longer expand if the removed
    * child was expand=TRUE and could therefore
    * be forcing it to.
@@ -5014,6 +5022,7 @@ gtk_widget_unmap (GtkWidget *widget)
 
       if (!_gtk_widget_get_has_window (widget))
 	gdk_window_invalidate_rect (priv->window, &priv->clip, FALSE);
+      gtk_widget_invalidate_render_cache (widget);
       _gtk_tooltip_hide (widget);
 
       g_signal_emit (widget, widget_signals[UNMAP], 0);
@@ -5557,6 +5566,8 @@ gtk_widget_queue_draw_region (GtkWidget            *widget,
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
+  gtk_widget_invalidate_render_cache (widget);
+
   if (!_gtk_widget_get_realized (widget))
     return;
 
@@ -5678,6 +5689,8 @@ gtk_widget_queue_resize_internal (GtkWidget *widget)
 {
   GSList *groups, *l, *widgets;
 
+  gtk_widget_invalidate_render_cache (widget);
+
   if (gtk_widget_get_resize_needed (widget))
     return;
 
@@ -5708,7 +5721,13 @@ G_GNUC_END_IGNORE_DEPRECATIONS;
   else if (_gtk_widget_get_visible (widget))
     {
       GtkWidget *parent = _gtk_widget_get_parent (widget);
-      if (parent)
+
+      /* A layout root keeps its size request, so it only needs to
+       * allocate its children again.
+       */
+      if (parent && parent->priv->layout_root)
+        gtk_widget_set_alloc_needed (parent);
+      else if (parent)
         gtk_widget_queue_resize_internal (parent);
     }
 }
@@ -5812,6 +5831,32 @@ gtk_widget_get_frame_clock (GtkWidget *widget)
     }
 }
 
+/* Returns the time, in the timescale of g_get_monotonic_time(), until
+ * which idle work for @widget may run. This is @budget microseconds
+ * from now, but not later than the start of the next frame, so that
+ * time-sliced work such as incremental validation runs in the slack
+ * between frames.
+ */
+gint64
+gtk_widget_get_idle_deadline (GtkWidget *widget,
+                              gint64     budget)
+{
+  GdkFrameClock *frame_clock;
+  gint64 deadline, frame_deadline;
+
+  deadline = g_get_monotonic_time () + budget;
+
+  frame_clock = gtk_widget_get_frame_clock (widget);
+  if (frame_clock)
+    {
+      frame_deadline = gdk_frame_clock_get_frame_deadline (frame_clock);
+      if (frame_deadline != 0)
+        deadline = MIN (deadline, frame_deadline);
+    }
+
+  return deadline;
+}
+
 /**
  * gtk_widget_size_request:
  * @widget: a #GtkWidget
@@ -6101,6 +6146,8 @@ gtk_widget_size_allocate_with_baseline (GtkWidget     *widget,
   if (!alloc_needed && !size_changed && !position_changed && !baseline_changed)
     goto out;
 
+  gtk_widget_invalidate_render_cache (widget);
+
   priv->allocated_baseline = baseline;
   if (g_signal_has_handler_pending (widget, widget_signals[SIZE_ALLOCATE], 0, FALSE))
     g_signal_emit (widget, widget_signals[SIZE_ALLOCATE], 0, &real_allocation);
@@ -6948,6 +6995,186 @@ gtk_cairo_should_draw_window (cairo_t   *cr,
   return tmp == window;
 }
 
+static void
+gtk_widget_draw_contents (GtkWidget *widget,
+                          cairo_t   *cr)
+{
+  gboolean result;
+
+  if (g_signal_has_handler_pending (widget, widget_signals[DRAW], 0, FALSE))
+    {
+      g_signal_emit (widget, widget_signals[DRAW],
+                     0, cr,
+                     &result);
+    }
+  else if (GTK_WIDGET_GET_CLASS (widget)->draw)
+    {
+      cairo_save (cr);
+      GTK_WIDGET_GET_CLASS (widget)->draw (widget, cr);
+      cairo_restore (cr);
+    }
+}
+
+static void
+find_windowed_descendant (GtkWidget *widget,
+                          gpointer   data)
+{
+  gboolean *found = data;
+
+  if (*found)
+    return;
+
+  if (_gtk_widget_get_has_window (widget))
+    *found = TRUE;
+  else if (GTK_IS_CONTAINER (widget))
+    gtk_container_forall (GTK_CONTAINER (widget), find_windowed_descendant, found);
+}
+
+/* A recording is made without a GdkDrawingContext, so it contains the
+ * output for all windows at once. That is only right if all of it goes
+ * to the window of the widget.
+ */
+static gboolean
+gtk_widget_has_windowed_descendant (GtkWidget *widget)
+{
+  gboolean found = FALSE;
+
+  if (GTK_IS_CONTAINER (widget))
+    gtk_container_forall (GTK_CONTAINER (widget), find_windowed_descendant, &found);
+
+  return found;
+}
+
+/* Widgets with a render cache that contain windowed descendants are
+ * drawn without it, see gtk_widget_set_render_cache(). This is kept
+ * up to date when the cache is enabled and when children are added
+ * or removed, so that drawing doesn't have to look.
+ */
+static void
+gtk_widget_set_render_cache_bypass (GtkWidget *widget,
+                                    gboolean   bypass)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+
+  if (priv->render_cache_bypass == bypass)
+    return;
+
+  priv->render_cache_bypass = bypass;
+  g_clear_pointer (&priv->render_cache_surface, cairo_surface_destroy);
+}
+
+static void
+gtk_widget_render_cache_child_added (GtkWidget *child)
+{
+  GtkWidget *w;
+  gboolean checked = FALSE;
+
+  if (n_render_cache_widgets == 0)
+    return;
+
+  for (w = child->priv->parent; w != NULL; w = w->priv->parent)
+    {
+      if (!w->priv->render_cache || w->priv->render_cache_bypass)
+        continue;
+
+      if (!checked)
+        {
+          if (!_gtk_widget_get_has_window (child) &&
+              !gtk_widget_has_windowed_descendant (child))
+            return;
+          checked = TRUE;
+        }
+
+      gtk_widget_set_render_cache_bypass (w, TRUE);
+    }
+}
+
+static void
+gtk_widget_render_cache_child_removed (GtkWidget *old_parent)
+{
+  GtkWidget *w;
+
+  if (n_render_cache_widgets == 0)
+    return;
+
+  for (w = old_parent; w != NULL; w = w->priv->parent)
+    {
+      if (w->priv->render_cache_bypass)
+        gtk_widget_set_render_cache_bypass (w, gtk_widget_has_windowed_descendant (w));
+    }
+}
+
+/* Replays the recorded output of the widget and its children, running
+ * the draw handlers into a new recording first if the cache was
+ * invalidated or the clip or scale of the widget changed. The recording
+ * always covers the full clip of the widget, so that later frames can
+ * replay any part of it.
+ */
+static void
+gtk_widget_draw_cached (GtkWidget *widget,
+                        cairo_t   *cr)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+  cairo_surface_t *surface;
+  GdkRectangle extents;
+  gint scale;
+
+  extents.x = priv->clip.x - priv->allocation.x;
+  extents.y = priv->clip.y - priv->allocation.y;
+  extents.width = priv->clip.width;
+  extents.height = priv->clip.height;
+  scale = gtk_widget_get_scale_factor (widget);
+
+  if (priv->render_cache_surface != NULL &&
+      (priv->render_cache_scale != scale ||
+       !gdk_rectangle_equal (&priv->render_cache_extents, &extents)))
+    g_clear_pointer (&priv->render_cache_surface, cairo_surface_destroy);
+
+  if (priv->render_cache_surface != NULL)
+    {
+      surface = cairo_surface_reference (priv->render_cache_surface);
+    }
+  else
+    {
+      cairo_rectangle_t rect = { extents.x, extents.y, extents.width, extents.height };
+      cairo_t *record_cr;
+
+      /* Draw handlers may queue a redraw while we record; that drops
+       * priv->render_cache_surface again, so hold our own reference.
+       */
+      surface = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, &rect);
+      priv->render_cache_surface = cairo_surface_reference (surface);
+      priv->render_cache_extents = extents;
+      priv->render_cache_scale = scale;
+
+      record_cr = cairo_create (surface);
+      gtk_widget_draw_contents (widget, record_cr);
+      cairo_destroy (record_cr);
+    }
+
+  cairo_save (cr);
+  cairo_set_source_surface (cr, surface, 0, 0);
+  cairo_paint (cr);
+  cairo_restore (cr);
+
+  cairo_surface_destroy (surface);
+}
+
+/* Drops the recorded output of @widget and of all its ancestors,
+ * since their recordings include the output of @widget.
+ */
+static void
+gtk_widget_invalidate_render_cache (GtkWidget *widget)
+{
+  GtkWidget *w;
+
+  if (n_render_cache_widgets == 0)
+    return;
+
+  for (w = widget; w != NULL; w = w->priv->parent)
+    g_clear_pointer (&w->priv->render_cache_surface, cairo_surface_destroy);
+}
+
 void
 gtk_widget_draw_internal (GtkWidget *widget,
                           cairo_t   *cr,
@@ -6969,8 +7196,11 @@ gtk_widget_draw_internal (GtkWidget *widget,
   if (gdk_cairo_get_clip_rectangle (cr, NULL))
     {
       GdkWindow *event_window = NULL;
-      gboolean result;
       gboolean push_group;
+      gint64 before = 0;
+
+      if (GDK_PRIVATE_CALL (gdk_profiler_is_running) ())
+        before = g_get_monotonic_time ();
 
       /* If this was a cairo_t passed via gtk_widget_draw() then we don't
        * require a window; otherwise we check for the window associated
@@ -7000,18 +7230,12 @@ gtk_widget_draw_internal (GtkWidget *widget,
       if (_gtk_widget_get_alloc_needed (widget))
         g_warning ("%s %p is drawn without a current allocation. This should not happen.", G_OBJECT_TYPE_NAME (widget), widget);
 
-      if (g_signal_has_handler_pending (widget, widget_signals[DRAW], 0, FALSE))
-        {
-          g_signal_emit (widget, widget_signals[DRAW],
-                         0, cr,
-                         &result);
-        }
-      else if (GTK_WIDGET_GET_CLASS (widget)->draw)
-        {
-          cairo_save (cr);
-          GTK_WIDGET_GET_CLASS (widget)->draw (widget, cr);
-          cairo_restore (cr);
-        }
+      if (widget->priv->render_cache &&
+          !widget->priv->render_cache_bypass &&
+          gtk_cairo_should_draw_window (cr, widget->priv->window))
+        gtk_widget_draw_cached (widget, cr);
+      else
+        gtk_widget_draw_contents (widget, cr);
 
 #ifdef G_ENABLE_DEBUG
       if (GTK_DISPLAY_DEBUG_CHECK (gtk_widget_get_display (widget), BASELINES))
@@ -7065,6 +7289,9 @@ gtk_widget_draw_internal (GtkWidget *widget,
                      G_OBJECT_TYPE_NAME (widget),
                      cairo_status_to_string (cairo_status (cr)));
         }
+
+      if (before != 0)
+        GDK_PRIVATE_CALL (gdk_profiler_end_mark) (before, "draw", G_OBJECT_TYPE_NAME (widget));
     }
 }
 
@@ -9531,6 +9758,8 @@ gtk_widget_set_parent (GtkWidget *widget,
 
   priv->parent = parent;
 
+  gtk_widget_render_cache_child_added (widget);
+
   parent_flags = _gtk_widget_get_state_flags (parent);
 
   /* Merge both old state and current parent state,
@@ -12256,6 +12485,10 @@ gtk_widget_finalize (GObject *object)
 
   g_free (priv->name);
 
+  if (priv->render_cache)
+    n_render_cache_widgets--;
+  g_clear_pointer (&priv->render_cache_surface, cairo_surface_destroy);
+
   if (priv->accessible)
     g_object_unref (priv->accessible);
 
@@ -16069,6 +16302,142 @@ gtk_widget_get_opacity (GtkWidget *widget)
   return widget->priv->user_alpha / 255.0;
 }
 
+/**
+ * gtk_widget_set_render_cache:
+ * @widget: a #GtkWidget
+ * @render_cache: %TRUE to keep a recording of the widget’s output
+ *
+ * Sets whether @widget keeps a recording of what it and its children
+ * drew in the last frame. As long as neither @widget nor any of its
+ * descendants queues a redraw or a resize and the size and scale
+ * of @widget stay the same, later frames replay the recording instead
+ * of running the draw handlers again.
+ *
+ * This is useful for complex, mostly static parts of a window which
+ * are redrawn because something next to them changes. It costs the
+ * memory needed for the recording, and the first frame after every
+ * change draws the whole widget instead of only the damaged area.
+ *
+ * Only changes that go through gtk_widget_queue_draw(), its variants
+ * or gtk_widget_queue_resize() are noticed. The render cache can't
+ * record children that have their own #GdkWindow, such as #GtkTreeView
+ * or #GtkTextView; while @widget contains any, it is drawn as if the
+ * render cache was disabled, but the setting is kept.
+ *
+ * Since: 3.22
+ **/
+void
+gtk_widget_set_render_cache (GtkWidget *widget,
+                             gboolean   render_cache)
+{
+  GtkWidgetPrivate *priv;
+
+  g_return_if_fail (GTK_IS_WIDGET (widget));
+
+  priv = widget->priv;
+
+  render_cache = render_cache != FALSE;
+
+  if (priv->render_cache == render_cache)
+    return;
+
+  priv->render_cache = render_cache;
+
+  if (render_cache)
+    {
+      n_render_cache_widgets++;
+      priv->render_cache_bypass = gtk_widget_has_windowed_descendant (widget);
+    }
+  else
+    {
+      n_render_cache_widgets--;
+      priv->render_cache_bypass = FALSE;
+      g_clear_pointer (&priv->render_cache_surface, cairo_surface_destroy);
+    }
+}
+
+/**
+ * gtk_widget_get_render_cache:
+ * @widget: a #GtkWidget
+ *
+ * Returns whether @widget keeps a recording of its output.
+ * See gtk_widget_set_render_cache().
+ *
+ * Returns: %TRUE if the render cache is enabled
+ *
+ * Since: 3.22
+ **/
+gboolean
+gtk_widget_get_render_cache (GtkWidget *widget)
+{
+  g_return_val_if_fail (GTK_IS_WIDGET (widget), FALSE);
+
+  return widget->priv->render_cache;
+}
+
+/**
+ * gtk_widget_set_layout_root:
+ * @widget: a #GtkWidget
+ * @layout_root: %TRUE if the size request of @widget does not depend
+ *   on its children
+ *
+ * Declares that the size request of @widget does not change when its
+ * children change their size requests, for example because @widget
+ * has been given a fixed size with gtk_widget_set_size_request() that
+ * is larger than its contents, or because it scrolls its contents.
+ *
+ * When a child of a layout root queues a resize, GTK+ does not
+ * renegotiate the size of the ancestors of @widget. Instead @widget
+ * keeps its current allocation and only its children are measured
+ * and allocated again. This makes frequent updates of widgets deep
+ * inside a complex window much cheaper.
+ *
+ * If the size request of @widget does depend on its children, setting
+ * this leaves @widget with an outdated size; call
+ * gtk_widget_queue_resize() on @widget itself when its size request
+ * needs to be renegotiated.
+ *
+ * Since: 3.22
+ **/
+void
+gtk_widget_set_layout_root (GtkWidget *widget,
+                            gboolean   layout_root)
+{
+  GtkWidgetPrivate *priv;
+
+  g_return_if_fail (GTK_IS_WIDGET (widget));
+
+  priv = widget->priv;
+
+  layout_root = layout_root != FALSE;
+
+  if (priv->layout_root == layout_root)
+    return;
+
+  priv->layout_root = layout_root;
+
+  gtk_widget_queue_resize (widget);
+}
+
+/**
+ * gtk_widget_get_layout_root:
+ * @widget: a #GtkWidget
+ *
+ * Returns whether @widget has been declared a layout root with
+ * gtk_widget_set_layout_root().
+ *
+ * Returns: %TRUE if @widget is a layout root
+ *
+ * Since: 3.22
+ **/
+gboolean
+gtk_widget_get_layout_root (GtkWidget *widget)
+{
+  g_return_val_if_fail (GTK_IS_WIDGET (widget), FALSE);
+
+  return widget->priv->layout_root;
+}
+
 static void
 _gtk_widget_set_has_focus (GtkWidget *widget,
                            gboolean   has_focus)
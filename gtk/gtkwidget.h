@@ -984,6 +984,16 @@ void	   gtk_widget_set_opacity	  (GtkWidget	       *widget,
 					   double		opacity);
 GDK_AVAILABLE_IN_3_8
 double	   gtk_widget_get_opacity	  (GtkWidget	       *widget);
+GDK_AVAILABLE_IN_3_22
+void	   gtk_widget_set_render_cache	  (GtkWidget	       *widget,
+					   gboolean		render_cache);
+GDK_AVAILABLE_IN_3_22
+gboolean   gtk_widget_get_render_cache	  (GtkWidget	       *widget);
+GDK_AVAILABLE_IN_3_22
+void	   gtk_widget_set_layout_root	  (GtkWidget	       *widget,
+					   gboolean		layout_root);
+GDK_AVAILABLE_IN_3_22
+gboolean   gtk_widget_get_layout_root	  (GtkWidget	       *widget);
 
 GDK_AVAILABLE_IN_ALL
 void       gtk_widget_set_device_enabled  (GtkWidget    *widget,
@@ -89,6 +89,9 @@ struct _GtkWidgetPrivate
   guint hexpand_set           : 1; /* whether to use application-forced  */
   guint vexpand_set           : 1; /* instead of computing from children */
   guint has_tooltip           : 1;
+  guint render_cache          : 1;
+  guint render_cache_bypass   : 1; /* render_cache, but there are windowed descendants */
+  guint layout_root           : 1;
 
   /* SizeGroup related flags */
   guint have_size_groups      : 1;
@@ -109,6 +112,11 @@ struct _GtkWidgetPrivate
   gint height;
   GtkBorder margin;
 
+  /* Recorded output of the draw handlers, see gtk_widget_set_render_cache() */
+  cairo_surface_t *render_cache_surface;
+  GdkRectangle render_cache_extents;
+  gint render_cache_scale;
+
   /* Animations and other things to update on clock ticks */
   guint clock_tick_id;
   GList *tick_callbacks;
@@ -283,6 +291,8 @@ gboolean          _gtk_widget_consumes_motion              (GtkWidget
                                                             GdkEventSequence    *sequence);
 
 gboolean          gtk_widget_has_tick_callback             (GtkWidget *widget);
+gint64            gtk_widget_get_idle_deadline             (GtkWidget *widget,
+                                                            gint64     budget);
 
 void              gtk_widget_set_csd_input_shape           (GtkWidget            *widget,
                                                             const cairo_region_t *region);
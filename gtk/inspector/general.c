@@ -30,6 +30,7 @@
 #include "gtkimage.h"
 #include "gtkadjustment.h"
 #include "gtkbox.h"
+#include "gtkiconsurfacecacheprivate.h"
 
 #ifdef GDK_WINDOWING_X11
 #include "x11/gdkx.h"
@@ -60,6 +61,7 @@ struct _GtkInspectorGeneralPrivate
   GtkWidget *display_box;
   GtkWidget *gl_box;
   GtkWidget *device_box;
+  GtkWidget *icon_cache_box;
   GtkWidget *gtk_version;
   GtkWidget *gdk_backend;
   GtkWidget *gl_version;
@@ -603,6 +605,57 @@ init_device (GtkInspectorGeneral *gen)
   populate_seats (gen);
 }
 
+static void
+populate_icon_cache (GtkInspectorGeneral *gen)
+{
+  GtkIconSurfaceCacheStats stats;
+  GtkListBox *list;
+  GList *children, *l;
+  gchar *size, *budget;
+  gchar *text;
+
+  list = GTK_LIST_BOX (gen->priv->icon_cache_box);
+  children = gtk_container_get_children (GTK_CONTAINER (list));
+  for (l = children; l; l = l->next)
+    gtk_widget_destroy (GTK_WIDGET (l->data));
+  g_list_free (children);
+
+  gtk_icon_surface_cache_get_stats (&stats);
+
+  text = g_strdup_printf ("%u", stats.n_surfaces);
+  add_label_row (gen, list, "Icon surfaces", text, 0);
+  g_free (text);
+
+  size = g_format_size (stats.size);
+  budget = g_format_size (stats.budget);
+  text = g_strdup_printf ("%s / %s", size, budget);
+  add_label_row (gen, list, "Size", text, 10);
+  g_free (text);
+  g_free (size);
+  g_free (budget);
+
+  text = g_strdup_printf ("%" G_GUINT64_FORMAT, stats.hits);
+  add_label_row (gen, list, "Hits", text, 10);
+  g_free (text);
+
+  text = g_strdup_printf ("%" G_GUINT64_FORMAT, stats.misses);
+  add_label_row (gen, list, "Misses", text, 10);
+  g_free (text);
+
+  text = g_strdup_printf ("%" G_GUINT64_FORMAT, stats.evictions);
+  add_label_row (gen, list, "Evictions", text, 10);
+  g_free (text);
+}
+
+static void
+init_icon_cache (GtkInspectorGeneral *gen)
+{
+  /* The statistics change all the time, refresh them when shown */
+  g_signal_connect (gen, "map", G_CALLBACK (populate_icon_cache), NULL);
+
+  populate_icon_cache (gen);
+}
+
 static void
 gtk_inspector_general_init (GtkInspectorGeneral *gen)
 {
@@ -613,6 +666,7 @@ gtk_inspector_general_init (GtkInspectorGeneral *gen)
   init_display (gen);
   init_gl (gen);
   init_device (gen);
+  init_icon_cache (gen);
 }
 
 static gboolean
@@ -629,6 +683,10 @@ keynav_failed (GtkWidget *widget, GtkDirectionType direction, GtkInspectorGenera
     next = gen->priv->gl_box;
   else if (direction == GTK_DIR_DOWN && widget == gen->priv->gl_box)
     next = gen->priv->device_box;
+  else if (direction == GTK_DIR_DOWN && widget == gen->priv->device_box)
+    next = gen->priv->icon_cache_box;
+  else if (direction == GTK_DIR_UP && widget == gen->priv->icon_cache_box)
+    next = gen->priv->device_box;
   else if (direction == GTK_DIR_UP && widget == gen->priv->device_box)
     next = gen->priv->gl_box;
   else if (direction == GTK_DIR_UP && widget == gen->priv->gl_box)
@@ -681,6 +739,7 @@ gtk_inspector_general_constructed (GObject *object)
    g_signal_connect (gen->priv->display_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
    g_signal_connect (gen->priv->gl_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
    g_signal_connect (gen->priv->device_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
+   g_signal_connect (gen->priv->icon_cache_box, "keynav-failed", G_CALLBACK (keynav_failed), gen);
 }
 
 static void
@@ -712,6 +771,7 @@ gtk_inspector_general_class_init (GtkInspectorGeneralClass *klass)
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorGeneral, display_composited);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorGeneral, display_rgba);
   gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorGeneral, device_box);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorGeneral, icon_cache_box);
 }
 
 // vim: set et sw=2 ts=2:
@@ -0,0 +1,781 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+/* benchmark.c
+ * Copyright (C) 2016 the GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* A non-interactive benchmark runner. Every workload builds its widgets
+ * in an offscreen window from a fixed random seed and then runs a number
+ * of iterations, timing each phase (style, layout, draw, ...) of every
+ * iteration. The results are printed as JSON; passing an earlier result
+ * file with --compare reports the differences and fails if a phase got
+ * slower than the threshold.
+ */
+
+#include "config.h"
+
+#include <gtk/gtk.h>
+#include <string.h>
+#include <stdlib.h>
+#ifdef HAVE_MALLINFO
+#include <malloc.h>
+#endif
+
+#define BENCH_SEED 1234
+
+typedef struct _Bench Bench;
+typedef struct _Phase Phase;
+typedef struct _Workload Workload;
+
+struct _Phase
+{
+  const char *name;
+  GArray *times;        /* double, msec */
+  gint64 heap_bytes;    /* summed over all iterations */
+  gint64 start;
+  gint64 start_heap;
+};
+
+struct _Bench
+{
+  GRand *rand;
+  GtkWidget *window;
+  GtkWidget *widget;
+  GtkCssProvider *provider;
+  cairo_surface_t *surface;
+  GPtrArray *phases;
+  guint iteration;
+  gboolean measuring;
+};
+
+struct _Workload
+{
+  const char *name;
+  void (* setup) (Bench *bench);
+  void (* run)   (Bench *bench);
+};
+
+static gint iterations = 20;
+static gint warmup = 3;
+static gchar *output_file = NULL;
+static gchar *compare_file = NULL;
+static gchar **only_workloads = NULL;
+static gdouble threshold = 10.0;
+
+static GOptionEntry options[] = {
+  { "iterations", 'n', 0, G_OPTION_ARG_INT, &iterations, "Measured iterations per workload", "N" },
+  { "warmup", 0, 0, G_OPTION_ARG_INT, &warmup, "Unmeasured iterations per workload", "N" },
+  { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output_file, "Write results to FILE instead of stdout", "FILE" },
+  { "compare", 'c', 0, G_OPTION_ARG_FILENAME, &compare_file, "Compare results with an earlier run", "FILE" },
+  { "workload", 'w', 0, G_OPTION_ARG_STRING_ARRAY, &only_workloads, "Only run the named workload", "NAME" },
+  { "threshold", 't', 0, G_OPTION_ARG_DOUBLE, &threshold, "Percentage above which a slowdown is a regression", "PERCENT" },
+  { NULL }
+};
+
+static gint64
+heap_in_use (void)
+{
+#ifdef HAVE_MALLINFO
+  struct mallinfo info = mallinfo ();
+
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+static Phase *
+bench_get_phase (Bench      *bench,
+                 const char *name)
+{
+  Phase *phase;
+  guint i;
+
+  for (i = 0; i < bench->phases->len; i++)
+    {
+      phase = g_ptr_array_index (bench->phases, i);
+      if (strcmp (phase->name, name) == 0)
+        return phase;
+    }
+
+  phase = g_new0 (Phase, 1);
+  phase->name = name;
+  phase->times = g_array_new (FALSE, FALSE, sizeof (double));
+  g_ptr_array_add (bench->phases, phase);
+
+  return phase;
+}
+
+static void
+phase_free (gpointer data)
+{
+  Phase *phase = data;
+
+  g_array_unref (phase->times);
+  g_free (phase);
+}
+
+static void
+bench_begin (Bench      *bench,
+             const char *name)
+{
+  Phase *phase = bench_get_phase (bench, name);
+
+  phase->start_heap = heap_in_use ();
+  phase->start = g_get_monotonic_time ();
+}
+
+static void
+bench_end (Bench      *bench,
+           const char *name)
+{
+  Phase *phase = bench_get_phase (bench, name);
+  gint64 end;
+  double msec;
+
+  end = g_get_monotonic_time ();
+
+  if (!bench->measuring)
+    return;
+
+  msec = (end - phase->start) / 1000.;
+  g_array_append_val (phase->times, msec);
+  phase->heap_bytes += heap_in_use () - phase->start_heap;
+}
+
+/* Common phases */
+
+static void
+force_style (GtkWidget *widget,
+             gpointer   data)
+{
+  GdkRGBA color;
+
+  gtk_style_context_get_color (gtk_widget_get_style_context (widget),
+                               gtk_widget_get_state_flags (widget),
+                               &color);
+
+  if (GTK_IS_CONTAINER (widget))
+    gtk_container_forall (GTK_CONTAINER (widget), force_style, NULL);
+}
+
+static void
+bench_style (Bench *bench)
+{
+  bench_begin (bench, "style");
+  force_style (bench->window, NULL);
+  bench_end (bench, "style");
+}
+
+static void
+bench_layout (Bench *bench,
+              int    width,
+              int    height)
+{
+  GtkRequisition min;
+  GtkAllocation allocation;
+
+  bench_begin (bench, "layout");
+  gtk_widget_get_preferred_size (bench->window, &min, NULL);
+  allocation.x = 0;
+  allocation.y = 0;
+  allocation.width = MAX (width, min.width);
+  allocation.height = MAX (height, min.height);
+  gtk_widget_size_allocate (bench->window, &allocation);
+  bench_end (bench, "layout");
+}
+
+static void
+bench_draw (Bench *bench)
+{
+  cairo_t *cr;
+
+  bench_begin (bench, "draw");
+  cr = cairo_create (bench->surface);
+  gtk_widget_draw (bench->window, cr);
+  cairo_destroy (cr);
+  bench_end (bench, "draw");
+}
+
+static void
+bench_add_css (Bench      *bench,
+               const char *css)
+{
+  bench->provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (bench->provider, css, -1, NULL);
+  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                             GTK_STYLE_PROVIDER (bench->provider),
+                                             GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+}
+
+static void
+bench_set_child (Bench     *bench,
+                 GtkWidget *child,
+                 int        width,
+                 int        height)
+{
+  gtk_container_add (GTK_CONTAINER (bench->window), child);
+  gtk_window_set_default_size (GTK_WINDOW (bench->window), width, height);
+  gtk_widget_show_all (bench->window);
+}
+
+static char *
+random_words (GRand *rand,
+              int    n_words)
+{
+  static const char *words[] = {
+    "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing",
+    "elit", "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore",
+    "et", "dolore", "magna", "aliqua", "enim", "ad", "minim", "veniam"
+  };
+  GString *str;
+  int i;
+
+  str = g_string_new (NULL);
+  for (i = 0; i < n_words; i++)
+    {
+      if (i > 0)
+        g_string_append_c (str, ' ');
+      g_string_append (str, words[g_rand_int_range (rand, 0, G_N_ELEMENTS (words))]);
+    }
+
+  return g_string_free (str, FALSE);
+}
+
+/* CSS restyle of a large tree */
+
+static void
+css_restyle_setup (Bench *bench)
+{
+  GtkWidget *box, *row, *label;
+  int i, j;
+
+  bench_add_css (bench,
+                 ".bench-alt label { color: red; padding: 2px 4px; font-weight: bold; }");
+
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+  for (i = 0; i < 50; i++)
+    {
+      row = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+      for (j = 0; j < 20; j++)
+        {
+          char *text = random_words (bench->rand, 1);
+
+          label = gtk_label_new (text);
+          gtk_container_add (GTK_CONTAINER (row), label);
+          g_free (text);
+        }
+      gtk_container_add (GTK_CONTAINER (box), row);
+    }
+
+  bench->widget = box;
+  bench_set_child (bench, box, 800, 600);
+}
+
+static void
+css_restyle_run (Bench *bench)
+{
+  GtkStyleContext *context = gtk_widget_get_style_context (bench->widget);
+
+  if (bench->iteration % 2)
+    gtk_style_context_remove_class (context, "bench-alt");
+  else
+    gtk_style_context_add_class (context, "bench-alt");
+
+  bench_style (bench);
+  bench_layout (bench, 800, 600);
+  bench_draw (bench);
+}
+
+/* Tree view scrolling */
+
+static void
+tree_view_scroll_setup (Bench *bench)
+{
+  GtkListStore *store;
+  GtkWidget *sw, *tree;
+  GtkTreeIter iter;
+  int i;
+
+  store = gtk_list_store_new (3, G_TYPE_INT, G_TYPE_STRING, G_TYPE_STRING);
+  for (i = 0; i < 10000; i++)
+    {
+      char *a = random_words (bench->rand, 3);
+      char *b = random_words (bench->rand, 6);
+
+      gtk_list_store_insert_with_values (store, &iter, -1, 0, i, 1, a, 2, b, -1);
+      g_free (a);
+      g_free (b);
+    }
+
+  tree = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  g_object_unref (store);
+  for (i = 0; i < 3; i++)
+    gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree), -1, "Column",
+                                                 gtk_cell_renderer_text_new (),
+                                                 "text", i, NULL);
+  gtk_tree_view_set_fixed_height_mode (GTK_TREE_VIEW (tree), FALSE);
+
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (sw), tree);
+
+  bench->widget = sw;
+  bench_set_child (bench, sw, 400, 600);
+  bench_layout (bench, 400, 600);
+}
+
+static void
+tree_view_scroll_run (Bench *bench)
+{
+  GtkAdjustment *adjustment;
+  double upper, page;
+
+  adjustment = gtk_scrolled_window_get_vadjustment (GTK_SCROLLED_WINDOW (bench->widget));
+  upper = gtk_adjustment_get_upper (adjustment);
+  page = gtk_adjustment_get_page_size (adjustment);
+
+  bench_begin (bench, "scroll");
+  gtk_adjustment_set_value (adjustment,
+                            g_rand_double_range (bench->rand, 0, MAX (upper - page, 0)));
+  bench_end (bench, "scroll");
+
+  bench_layout (bench, 400, 600);
+  bench_draw (bench);
+}
+
+/* Text buffer loading */
+
+static void
+text_load_setup (Bench *bench)
+{
+  GtkWidget *sw, *view;
+
+  view = gtk_text_view_new ();
+  gtk_text_view_set_wrap_mode (GTK_TEXT_VIEW (view), GTK_WRAP_WORD);
+
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (sw), view);
+
+  bench->widget = view;
+  bench_set_child (bench, sw, 600, 600);
+}
+
+static void
+text_load_run (Bench *bench)
+{
+  GtkTextBuffer *buffer;
+  GString *text;
+  int i;
+
+  text = g_string_new (NULL);
+  for (i = 0; i < 5000; i++)
+    {
+      char *line = random_words (bench->rand, 12);
+
+      g_string_append (text, line);
+      g_string_append_c (text, '\n');
+      g_free (line);
+    }
+
+  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (bench->widget));
+
+  bench_begin (bench, "load");
+  gtk_text_buffer_set_text (buffer, text->str, text->len);
+  bench_end (bench, "load");
+
+  g_string_free (text, TRUE);
+
+  bench_layout (bench, 600, 600);
+  bench_draw (bench);
+}
+
+/* Label wrapping */
+
+static void
+label_wrap_setup (Bench *bench)
+{
+  GtkWidget *box, *label;
+  int i;
+
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 6);
+  for (i = 0; i < 200; i++)
+    {
+      char *text = random_words (bench->rand, g_rand_int_range (bench->rand, 10, 80));
+
+      label = gtk_label_new (text);
+      gtk_label_set_line_wrap (GTK_LABEL (label), TRUE);
+      gtk_label_set_xalign (GTK_LABEL (label), 0.0);
+      gtk_container_add (GTK_CONTAINER (box), label);
+      g_free (text);
+    }
+
+  bench->widget = box;
+  bench_set_child (bench, box, 400, 600);
+}
+
+static void
+label_wrap_run (Bench *bench)
+{
+  int width;
+
+  /* Alternate widths so every iteration has to wrap again */
+  width = bench->iteration % 2 ? 300 : 500;
+
+  bench_layout (bench, width, 600);
+  bench_draw (bench);
+}
+
+/* Shadow rendering */
+
+static void
+shadow_setup (Bench *bench)
+{
+  GtkWidget *grid, *button;
+  int i;
+
+  bench_add_css (bench,
+                 ".bench-shadow { margin: 12px; box-shadow: 0 4px 12px 4px rgba(0,0,0,0.5); }"
+                 ".bench-shadow:nth-child(odd) { box-shadow: 0 0 20px 2px rgba(0,0,255,0.5), inset 0 2px 4px black; }");
+
+  grid = gtk_grid_new ();
+  for (i = 0; i < 100; i++)
+    {
+      button = gtk_button_new_with_label ("Shadow");
+      gtk_style_context_add_class (gtk_widget_get_style_context (button), "bench-shadow");
+      gtk_grid_attach (GTK_GRID (grid), button, i % 10, i / 10, 1, 1);
+    }
+
+  bench->widget = grid;
+  bench_set_child (bench, grid, 800, 600);
+  bench_layout (bench, 800, 600);
+}
+
+static void
+shadow_run (Bench *bench)
+{
+  bench_draw (bench);
+}
+
+static const Workload workloads[] = {
+  { "css-restyle", css_restyle_setup, css_restyle_run },
+  { "tree-view-scroll", tree_view_scroll_setup, tree_view_scroll_run },
+  { "text-load", text_load_setup, text_load_run },
+  { "label-wrap", label_wrap_setup, label_wrap_run },
+  { "shadow", shadow_setup, shadow_run }
+};
+
+static int
+compare_doubles (gconstpointer a,
+                 gconstpointer b)
+{
+  double da = *(const double *) a;
+  double db = *(const double *) b;
+
+  return (da > db) - (da < db);
+}
+
+static double
+phase_median (Phase *phase)
+{
+  guint n = phase->times->len;
+
+  if (n == 0)
+    return 0;
+
+  g_array_sort (phase->times, compare_doubles);
+
+  if (n % 2)
+    return g_array_index (phase->times, double, n / 2);
+  else
+    return (g_array_index (phase->times, double, n / 2 - 1) +
+            g_array_index (phase->times, double, n / 2)) / 2;
+}
+
+static void
+append_number (GString    *str,
+               const char *key,
+               double      value)
+{
+  char buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append_printf (str, ", \"%s\": %s", key,
+                          g_ascii_formatd (buf, sizeof (buf), "%.4f", value));
+}
+
+/* Each result is written on a line of its own, which is what
+ * load_results() relies on.
+ */
+static void
+append_results (GString        *str,
+                const Workload *workload,
+                Bench          *bench,
+                gboolean       *first)
+{
+  guint i;
+
+  for (i = 0; i < bench->phases->len; i++)
+    {
+      Phase *phase = g_ptr_array_index (bench->phases, i);
+      guint n = phase->times->len;
+
+      if (n == 0)
+        continue;
+
+      g_string_append_printf (str, "%s    {\"workload\": \"%s\", \"phase\": \"%s\"",
+                              *first ? "" : ",\n", workload->name, phase->name);
+      append_number (str, "median_ms", phase_median (phase));
+      append_number (str, "min_ms", g_array_index (phase->times, double, 0));
+      append_number (str, "max_ms", g_array_index (phase->times, double, n - 1));
+      g_string_append_printf (str, ", \"heap_bytes\": %" G_GINT64_FORMAT "}",
+                              phase->heap_bytes / (gint64) n);
+      *first = FALSE;
+    }
+}
+
+static gboolean
+should_run (const Workload *workload)
+{
+  if (only_workloads == NULL)
+    return TRUE;
+
+  return g_strv_contains ((const char * const *) only_workloads, workload->name);
+}
+
+static void
+run_workload (const Workload *workload,
+              GString        *str,
+              gboolean       *first)
+{
+  Bench bench = { 0, };
+  int i;
+
+  bench.rand = g_rand_new_with_seed (BENCH_SEED);
+  bench.phases = g_ptr_array_new_with_free_func (phase_free);
+  bench.window = gtk_offscreen_window_new ();
+  bench.surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 800, 600);
+
+  workload->setup (&bench);
+
+  for (i = 0; i < warmup + iterations; i++)
+    {
+      bench.iteration = i;
+      bench.measuring = i >= warmup;
+      workload->run (&bench);
+    }
+
+  append_results (str, workload, &bench, first);
+
+  gtk_widget_destroy (bench.window);
+  if (bench.provider)
+    {
+      gtk_style_context_remove_provider_for_screen (gdk_screen_get_default (),
+                                                    GTK_STYLE_PROVIDER (bench.provider));
+      g_object_unref (bench.provider);
+    }
+  cairo_surface_destroy (bench.surface);
+  g_ptr_array_unref (bench.phases);
+  g_rand_free (bench.rand);
+}
+
+static gboolean
+get_string_field (const char  *line,
+                  const char  *key,
+                  char       **value)
+{
+  char *pattern;
+  const char *start, *end;
+
+  pattern = g_strdup_printf ("\"%s\": \"", key);
+  start = strstr (line, pattern);
+  if (start)
+    start += strlen (pattern);
+  g_free (pattern);
+
+  if (start == NULL || (end = strchr (start, '"')) == NULL)
+    return FALSE;
+
+  *value = g_strndup (start, end - start);
+  return TRUE;
+}
+
+static gboolean
+get_number_field (const char *line,
+                  const char *key,
+                  double     *value)
+{
+  char *pattern;
+  const char *start;
+
+  pattern = g_strdup_printf ("\"%s\": ", key);
+  start = strstr (line, pattern);
+  if (start)
+    start += strlen (pattern);
+  g_free (pattern);
+
+  if (start == NULL)
+    return FALSE;
+
+  *value = g_ascii_strtod (start, NULL);
+  return TRUE;
+}
+
+/* Returns a table mapping "workload/phase" to the median in msec */
+static GHashTable *
+load_results (const char *contents)
+{
+  GHashTable *results;
+  char **lines;
+  int i;
+
+  results = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  lines = g_strsplit (contents, "\n", -1);
+  for (i = 0; lines[i]; i++)
+    {
+      char *workload, *phase;
+      double median;
+
+      if (!get_string_field (lines[i], "workload", &workload))
+        continue;
+
+      if (get_string_field (lines[i], "phase", &phase))
+        {
+          if (get_number_field (lines[i], "median_ms", &median))
+            g_hash_table_insert (results,
+                                 g_strconcat (workload, "/", phase, NULL),
+                                 g_memdup (&median, sizeof (double)));
+          g_free (phase);
+        }
+      g_free (workload);
+    }
+  g_strfreev (lines);
+
+  return results;
+}
+
+static gboolean
+compare_results (const char *old_contents,
+                 const char *new_contents)
+{
+  GHashTable *old_results, *new_results;
+  GHashTableIter iter;
+  gpointer key, value;
+  gboolean regressed = FALSE;
+
+  old_results = load_results (old_contents);
+  new_results = load_results (new_contents);
+
+  g_hash_table_iter_init (&iter, new_results);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      double *old_median = g_hash_table_lookup (old_results, key);
+      double new_median = *(double *) value;
+      double change;
+
+      if (old_median == NULL || *old_median <= 0)
+        {
+          g_printerr ("%-30s %10.3f ms (new)\n", (char *) key, new_median);
+          continue;
+        }
+
+      change = (new_median - *old_median) / *old_median * 100;
+      g_printerr ("%-30s %10.3f ms -> %10.3f ms %+7.1f%%%s\n",
+                  (char *) key, *old_median, new_median, change,
+                  change > threshold ? "  REGRESSION" : "");
+
+      if (change > threshold)
+        regressed = TRUE;
+    }
+
+  g_hash_table_unref (old_results);
+  g_hash_table_unref (new_results);
+
+  return !regressed;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GString *str;
+  gboolean first = TRUE;
+  gboolean success = TRUE;
+  guint i;
+
+  context = g_option_context_new (NULL);
+  g_option_context_set_summary (context, "Run the GTK+ benchmark workloads");
+  g_option_context_add_main_entries (context, options, NULL);
+  g_option_context_add_group (context, gtk_get_option_group (TRUE));
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (gdk_display_get_default () == NULL)
+    {
+      g_printerr ("Cannot open display\n");
+      return 1;
+    }
+
+  if (iterations < 1 || warmup < 0)
+    {
+      g_printerr ("Invalid number of iterations\n");
+      return 1;
+    }
+
+  str = g_string_new ("{\n");
+  g_string_append_printf (str, "  \"seed\": %d,\n  \"iterations\": %d,\n  \"warmup\": %d,\n  \"results\": [\n",
+                          BENCH_SEED, iterations, warmup);
+
+  for (i = 0; i < G_N_ELEMENTS (workloads); i++)
+    {
+      if (should_run (&workloads[i]))
+        run_workload (&workloads[i], str, &first);
+    }
+
+  g_string_append (str, "\n  ]\n}\n");
+
+  if (output_file)
+    {
+      if (!g_file_set_contents (output_file, str->str, str->len, &error))
+        {
+          g_printerr ("%s\n", error->message);
+          return 1;
+        }
+    }
+  else
+    g_print ("%s", str->str);
+
+  if (compare_file)
+    {
+      char *old_contents;
+
+      if (!g_file_get_contents (compare_file, &old_contents, NULL, &error))
+        {
+          g_printerr ("%s\n", error->message);
+          return 1;
+        }
+
+      success = compare_results (old_contents, str->str);
+      g_free (old_contents);
+    }
+
+  g_string_free (str, TRUE);
+
+  return success ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+#include <gdk/gdk.h>
+
+/* Motion can only be simulated on a headless broadway display,
+ * where warping the pointer generates motion events.
+ */
+static gboolean have_display;
+static GdkEvent *last_motion;
+
+static void
+event_handler (GdkEvent *event,
+               gpointer  data)
+{
+  if (event->type != GDK_MOTION_NOTIFY)
+    return;
+
+  g_clear_pointer (&last_motion, gdk_event_free);
+  last_motion = gdk_event_copy (event);
+}
+
+static gboolean
+timeout_cb (gpointer data)
+{
+  g_error ("timed out waiting for a motion event");
+
+  return G_SOURCE_REMOVE;
+}
+
+static GdkEvent *
+wait_for_motion (void)
+{
+  GdkEvent *event;
+  guint id;
+
+  id = g_timeout_add_seconds (5, timeout_cb, NULL);
+  while (last_motion == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  g_source_remove (id);
+
+  event = last_motion;
+  last_motion = NULL;
+
+  return event;
+}
+
+static void
+test_compression_history (void)
+{
+  GdkDisplay *display;
+  GdkDevice *pointer;
+  GdkWindowAttr attributes;
+  GdkWindow *window;
+  GdkEvent *event;
+  GdkTimeCoord **history;
+  gint n_history, i;
+  gdouble x, y;
+  gint ox, oy;
+
+  if (!have_display)
+    {
+      g_test_skip ("needs a headless broadway display");
+      return;
+    }
+
+  display = gdk_display_get_default ();
+  pointer = gdk_seat_get_pointer (gdk_display_get_default_seat (display));
+
+  attributes.window_type = GDK_WINDOW_TOPLEVEL;
+  attributes.wclass = GDK_INPUT_OUTPUT;
+  attributes.x = 10;
+  attributes.y = 20;
+  attributes.width = 200;
+  attributes.height = 200;
+  attributes.event_mask = GDK_POINTER_MOTION_MASK;
+  window = gdk_window_new (NULL, &attributes, GDK_WA_X | GDK_WA_Y);
+  gdk_window_show (window);
+  gdk_window_get_origin (window, &ox, &oy);
+
+  gdk_event_handler_set (event_handler, NULL, NULL);
+
+  gdk_device_warp (pointer, gdk_window_get_screen (window), ox + 5, oy + 5);
+  event = wait_for_motion ();
+  g_assert_false (gdk_event_get_motion_history (event, NULL, NULL));
+  gdk_event_free (event);
+
+  /* Queue several motions without dispatching in between,
+   * so that all but the last one are compressed away */
+  for (i = 1; i <= 4; i++)
+    gdk_device_warp (pointer, gdk_window_get_screen (window), ox + 10 * i, oy + 20 * i);
+
+  event = wait_for_motion ();
+  gdk_event_get_coords (event, &x, &y);
+  g_assert_cmpfloat (x, ==, 40);
+  g_assert_cmpfloat (y, ==, 80);
+
+  g_assert_true (gdk_event_get_motion_history (event, &history, &n_history));
+  g_assert_cmpint (n_history, ==, 3);
+
+  for (i = 0; i < n_history; i++)
+    {
+      g_assert_true (gdk_device_get_axis (pointer, history[i]->axes, GDK_AXIS_X, &x));
+      g_assert_true (gdk_device_get_axis (pointer, history[i]->axes, GDK_AXIS_Y, &y));
+      g_assert_cmpfloat (x, ==, 10 * (i + 1));
+      g_assert_cmpfloat (y, ==, 20 * (i + 1));
+
+      if (i > 0)
+        g_assert_cmpuint (history[i - 1]->time, <=, history[i]->time);
+    }
+  g_assert_cmpuint (history[n_history - 1]->time, <=, gdk_event_get_time (event));
+
+  gdk_device_free_history (history, n_history);
+  gdk_event_free (event);
+
+  gdk_event_handler_set (NULL, NULL, NULL);
+  gdk_window_destroy (window);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_setenv ("BROADWAY_DISPLAY", "headless-unthrottled", TRUE);
+  gdk_set_allowed_backends ("broadway");
+  have_display = gdk_init_check (NULL, NULL);
+
+  g_test_add_func ("/motion/compression/history", test_compression_history);
+
+  return g_test_run ();
+}
@@ -306,6 +306,240 @@ test_delete (void)
   g_object_unref (entry);
 }
 
+static GtkTreeModel *
+find_completion_filter (GtkWidget    *widget,
+                        GtkTreeModel *model)
+{
+  GtkTreeModel *filter = NULL;
+  GList *children, *l;
+
+  if (GTK_IS_TREE_VIEW (widget))
+    {
+      filter = gtk_tree_view_get_model (GTK_TREE_VIEW (widget));
+      if (GTK_IS_TREE_MODEL_FILTER (filter) &&
+          gtk_tree_model_filter_get_model (GTK_TREE_MODEL_FILTER (filter)) == model)
+        return filter;
+
+      return NULL;
+    }
+
+  if (!GTK_IS_CONTAINER (widget))
+    return NULL;
+
+  children = gtk_container_get_children (GTK_CONTAINER (widget));
+  for (l = children; l && filter == NULL; l = l->next)
+    filter = find_completion_filter (l->data, model);
+  g_list_free (children);
+
+  return filter;
+}
+
+/* The rows of the completion popup, joined with commas */
+static gchar *
+get_completion_matches (GtkEntryCompletion *completion)
+{
+  GtkTreeModel *model, *filter = NULL;
+  GtkTreeIter iter;
+  GString *str;
+  GList *toplevels, *l;
+
+  model = gtk_entry_completion_get_model (completion);
+  toplevels = gtk_window_list_toplevels ();
+  for (l = toplevels; l && filter == NULL; l = l->next)
+    filter = find_completion_filter (l->data, model);
+  g_list_free (toplevels);
+  g_assert (filter != NULL);
+
+  str = g_string_new (NULL);
+  if (gtk_tree_model_get_iter_first (filter, &iter))
+    do
+      {
+        gchar *text;
+
+        gtk_tree_model_get (filter, &iter, 0, &text, -1);
+        if (str->len > 0)
+          g_string_append_c (str, ',');
+        g_string_append (str, text);
+        g_free (text);
+      }
+    while (gtk_tree_model_iter_next (filter, &iter));
+
+  return g_string_free (str, FALSE);
+}
+
+/* The rows of @model whose text starts with @key, without
+ * narrowing down any previous matches
+ */
+static gchar *
+get_expected_matches (GtkTreeModel *model,
+                      const gchar  *key)
+{
+  GtkTreeIter iter;
+  GString *str;
+  gchar *folded_key, *tmp;
+
+  tmp = g_utf8_normalize (key, -1, G_NORMALIZE_ALL);
+  folded_key = g_utf8_casefold (tmp, -1);
+  g_free (tmp);
+
+  str = g_string_new (NULL);
+  if (gtk_tree_model_get_iter_first (model, &iter))
+    do
+      {
+        gchar *text, *folded;
+
+        gtk_tree_model_get (model, &iter, 0, &text, -1);
+        tmp = g_utf8_normalize (text, -1, G_NORMALIZE_ALL);
+        folded = g_utf8_casefold (tmp, -1);
+        if (g_str_has_prefix (folded, folded_key))
+          {
+            if (str->len > 0)
+              g_string_append_c (str, ',');
+            g_string_append (str, text);
+          }
+        g_free (folded);
+        g_free (tmp);
+        g_free (text);
+      }
+    while (gtk_tree_model_iter_next (model, &iter));
+
+  g_free (folded_key);
+
+  return g_string_free (str, FALSE);
+}
+
+static void
+check_completion (GtkEntry    *entry,
+                  const gchar *key)
+{
+  GtkEntryCompletion *completion = gtk_entry_get_completion (entry);
+  gchar *matches, *expected;
+
+  gtk_entry_set_text (entry, key);
+  gtk_entry_completion_complete (completion);
+
+  matches = get_completion_matches (completion);
+  expected = get_expected_matches (gtk_entry_completion_get_model (completion), key);
+  g_assert_cmpstr (matches, ==, expected);
+  g_free (matches);
+  g_free (expected);
+}
+
+static void
+test_completion_narrowing (void)
+{
+  const gchar *words[] = {
+    "bob", "Bobby", "Boris", "boat", "b\xc3\xb6rse", "Zoe", "BORING", "alice", "Bo"
+  };
+  GtkWidget *entry;
+  GtkEntryCompletion *completion;
+  GtkListStore *store;
+  GtkTreeIter iter;
+  guint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < G_N_ELEMENTS (words); i++)
+    gtk_list_store_insert_with_values (store, NULL, -1, 0, words[i], -1);
+
+  entry = gtk_entry_new ();
+  g_object_ref_sink (entry);
+  completion = gtk_entry_completion_new ();
+  gtk_entry_completion_set_model (completion, GTK_TREE_MODEL (store));
+  gtk_entry_completion_set_text_column (completion, 0);
+  gtk_entry_set_completion (GTK_ENTRY (entry), completion);
+
+  /* each key extends the previous one, so the matches get narrowed */
+  check_completion (GTK_ENTRY (entry), "b");
+  check_completion (GTK_ENTRY (entry), "bo");
+  check_completion (GTK_ENTRY (entry), "bor");
+  check_completion (GTK_ENTRY (entry), "bori");
+
+  /* a shorter key starts over */
+  check_completion (GTK_ENTRY (entry), "bo");
+  check_completion (GTK_ENTRY (entry), "BOB");
+
+  /* rows that change or appear between keys are not missed */
+  check_completion (GTK_ENTRY (entry), "bo");
+  gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 5);
+  gtk_list_store_set (store, &iter, 0, "Boa", -1);
+  gtk_list_store_insert_with_values (store, NULL, 0, 0, "Boast", -1);
+  check_completion (GTK_ENTRY (entry), "boa");
+
+  gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+  gtk_list_store_remove (store, &iter);
+  check_completion (GTK_ENTRY (entry), "boat");
+
+  gtk_widget_destroy (entry);
+  g_object_unref (entry);
+  g_object_unref (completion);
+  g_object_unref (store);
+}
+
+static void
+check_completion_rows (GtkEntryCompletion *completion,
+                       const gchar        *key)
+{
+  gchar *matches, *expected;
+
+  matches = get_completion_matches (completion);
+  expected = get_expected_matches (gtk_entry_completion_get_model (completion), key);
+  g_assert_cmpstr (matches, ==, expected);
+  g_free (matches);
+  g_free (expected);
+}
+
+static void
+test_completion_model_changes (void)
+{
+  const gchar *words[] = {
+    "bob", "Zoe", "alice", "Boris", "carol"
+  };
+  GtkWidget *entry;
+  GtkEntryCompletion *completion;
+  GtkListStore *store;
+  GtkTreeIter iter;
+  guint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < G_N_ELEMENTS (words); i++)
+    gtk_list_store_insert_with_values (store, NULL, -1, 0, words[i], -1);
+
+  entry = gtk_entry_new ();
+  g_object_ref_sink (entry);
+  completion = gtk_entry_completion_new ();
+  gtk_entry_completion_set_model (completion, GTK_TREE_MODEL (store));
+  gtk_entry_completion_set_text_column (completion, 0);
+  gtk_entry_set_completion (GTK_ENTRY (entry), completion);
+
+  check_completion (GTK_ENTRY (entry), "bo");
+
+  /* the filter looks at changed rows again, without a new key */
+  gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 1);
+  gtk_list_store_set (store, &iter, 0, "Bongo", -1);
+  check_completion_rows (completion, "bo");
+
+  gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+  gtk_list_store_set (store, &iter, 0, "alfred", -1);
+  check_completion_rows (completion, "bo");
+
+  /* new rows may take the place of removed ones */
+  gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 2);
+  gtk_list_store_remove (store, &iter);
+  gtk_list_store_insert_with_values (store, NULL, 2, 0, "Bolt", -1);
+  check_completion_rows (completion, "bo");
+
+  gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, 3);
+  gtk_list_store_remove (store, &iter);
+  gtk_list_store_append (store, &iter);
+  gtk_list_store_set (store, &iter, 0, "Bobcat", -1);
+  check_completion_rows (completion, "bo");
+
+  gtk_widget_destroy (entry);
+  g_object_unref (entry);
+  g_object_unref (completion);
+  g_object_unref (store);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -314,6 +548,8 @@ main (int   argc,
 
   g_test_add_func ("/entry/delete", test_delete);
   g_test_add_func ("/entry/insert", test_insert);
+  g_test_add_func ("/entry/completion/narrowing", test_completion_narrowing);
+  g_test_add_func ("/entry/completion/model-changes", test_completion_model_changes);
 
   return g_test_run();
 }
@@ -1,6 +1,7 @@
 #include <gtk/gtk.h>
 
 #include <string.h>
+#include <glib/gstdio.h>
 
 #define SCALABLE_IMAGE_SIZE (128)
 
@@ -700,6 +701,19 @@ test_inherit (void)
                       "/icons2/scalable/one-two-symbolic-rtl.svg");
 }
 
+static void
+test_has_icon (void)
+{
+  GtkIconTheme *icon_theme = get_test_icontheme (FALSE);
+
+  g_assert (gtk_icon_theme_has_icon (icon_theme, "one-two"));
+  /* only in the inherited theme */
+  g_assert (gtk_icon_theme_has_icon (icon_theme, "one-two-three-symbolic"));
+  /* twice, to hit the icon index */
+  g_assert (!gtk_icon_theme_has_icon (icon_theme, "one-two-three-four"));
+  g_assert (!gtk_icon_theme_has_icon (icon_theme, "one-two-three-four"));
+}
+
 static void
 test_nonsquare_symbolic (void)
 {
@@ -754,6 +768,176 @@ test_nonsquare_symbolic (void)
   g_object_unref (info);
 }
 
+/* Writes a 32x32 png filled with @rgba into @dir */
+static GFile *
+write_test_png (const char *dir,
+                const char *name,
+                guint32     rgba)
+{
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+  char *path;
+  GFile *file;
+
+  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8, 32, 32);
+  gdk_pixbuf_fill (pixbuf, rgba);
+  path = g_build_filename (dir, name, NULL);
+  gdk_pixbuf_save (pixbuf, path, "png", &error, NULL);
+  g_assert_no_error (error);
+
+  file = g_file_new_for_path (path);
+
+  g_free (path);
+  g_object_unref (pixbuf);
+
+  return file;
+}
+
+static GtkWidget *
+show_image (GIcon    *icon,
+            gboolean  load_async)
+{
+  GtkWidget *window, *image;
+
+  image = gtk_image_new_from_gicon (icon, GTK_ICON_SIZE_BUTTON);
+  gtk_image_set_pixel_size (GTK_IMAGE (image), 32);
+  gtk_image_set_load_async (GTK_IMAGE (image), load_async);
+
+  window = gtk_offscreen_window_new ();
+  gtk_container_add (GTK_CONTAINER (window), image);
+  gtk_widget_show_all (window);
+
+  return image;
+}
+
+/* Draws @image and returns the pixel at @x, @y of its 32x32 icon */
+static guint32
+get_image_pixel (GtkWidget *image,
+                 gint       x,
+                 gint       y)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  gint width, height;
+  guint32 pixel;
+
+  width = gtk_widget_get_allocated_width (image);
+  height = gtk_widget_get_allocated_height (image);
+  g_assert_cmpint (width, >=, 32);
+  g_assert_cmpint (height, >=, 32);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (surface);
+  gtk_widget_draw (image, cr);
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  x += (width - 32) / 2;
+  y += (height - 32) / 2;
+  pixel = *(guint32 *) (cairo_image_surface_get_data (surface) +
+                        y * cairo_image_surface_get_stride (surface) + x * 4);
+
+  cairo_surface_destroy (surface);
+
+  return pixel;
+}
+
+static void
+test_emblemed_surface (void)
+{
+  GFile *file, *emblem_file;
+  GIcon *icon, *emblem_icon, *emblemed;
+  GEmblem *emblem;
+  GtkWidget *plain_image, *emblemed_image;
+  char *dir;
+
+  dir = g_dir_make_tmp ("icontheme-XXXXXX", NULL);
+  g_assert_nonnull (dir);
+
+  file = write_test_png (dir, "red.png", 0xff0000ff);
+  emblem_file = write_test_png (dir, "blue.png", 0x0000ffff);
+
+  icon = g_file_icon_new (file);
+  emblem_icon = g_file_icon_new (emblem_file);
+  emblem = g_emblem_new (emblem_icon);
+  emblemed = g_emblemed_icon_new (icon, emblem);
+
+  /* Both have the filename of red.png, but must not share a surface */
+  plain_image = show_image (icon, FALSE);
+  emblemed_image = show_image (emblemed, FALSE);
+
+  g_assert_cmphex (get_image_pixel (plain_image, 28, 28), ==, 0xffff0000);
+  g_assert_cmphex (get_image_pixel (emblemed_image, 28, 28), ==, 0xff0000ff);
+  g_assert_cmphex (get_image_pixel (emblemed_image, 4, 4), ==, 0xffff0000);
+
+  /* In the other order, too */
+  gtk_widget_destroy (gtk_widget_get_toplevel (plain_image));
+  plain_image = show_image (icon, FALSE);
+  g_assert_cmphex (get_image_pixel (plain_image, 28, 28), ==, 0xffff0000);
+
+  gtk_widget_destroy (gtk_widget_get_toplevel (plain_image));
+  gtk_widget_destroy (gtk_widget_get_toplevel (emblemed_image));
+
+  g_file_delete (file, NULL, NULL);
+  g_file_delete (emblem_file, NULL, NULL);
+  g_rmdir (dir);
+
+  g_object_unref (emblemed);
+  g_object_unref (emblem);
+  g_object_unref (emblem_icon);
+  g_object_unref (icon);
+  g_object_unref (emblem_file);
+  g_object_unref (file);
+  g_free (dir);
+}
+
+static void
+test_async_image (void)
+{
+  GFile *file;
+  GIcon *icon;
+  GtkWidget *image;
+  char *dir;
+  gint i;
+
+  dir = g_dir_make_tmp ("icontheme-XXXXXX", NULL);
+  g_assert_nonnull (dir);
+
+  file = write_test_png (dir, "green.png", 0x00ff00ff);
+  icon = g_file_icon_new (file);
+
+  /* Every lookup of a GFileIcon returns a new GtkIconInfo,
+   * so the image must not wait for the one it loaded */
+  image = show_image (icon, TRUE);
+  g_assert_cmphex (get_image_pixel (image, 16, 16), ==, 0);
+
+  for (i = 0; i < 500; i++)
+    {
+      while (g_main_context_iteration (NULL, FALSE));
+
+      if (get_image_pixel (image, 16, 16) != 0)
+        break;
+
+      g_usleep (G_USEC_PER_SEC / 100);
+    }
+
+  g_assert_cmphex (get_image_pixel (image, 16, 16), ==, 0xff00ff00);
+
+  /* Another image for the same file finds the loaded surface */
+  gtk_widget_destroy (gtk_widget_get_toplevel (image));
+  image = show_image (icon, TRUE);
+  g_assert_cmphex (get_image_pixel (image, 16, 16), ==, 0xff00ff00);
+
+  gtk_widget_destroy (gtk_widget_get_toplevel (image));
+
+  g_file_delete (file, NULL, NULL);
+  g_rmdir (dir);
+
+  g_object_unref (icon);
+  g_object_unref (file);
+  g_free (dir);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -772,7 +956,10 @@ main (int argc, char *argv[])
   g_test_add_func ("/icontheme/list", test_list);
   g_test_add_func ("/icontheme/async", test_async);
   g_test_add_func ("/icontheme/inherit", test_inherit);
+  g_test_add_func ("/icontheme/has-icon", test_has_icon);
   g_test_add_func ("/icontheme/nonsquare-symbolic", test_nonsquare_symbolic);
+  g_test_add_func ("/icontheme/emblemed-surface", test_emblemed_surface);
+  g_test_add_func ("/icontheme/async-image", test_async_image);
 
   return g_test_run();
 }
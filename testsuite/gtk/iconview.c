@@ -0,0 +1,230 @@
+/* GtkIconView unit tests.
+ * Copyright (C) 2016 the GTK+ Team
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+/* More rows than the icon view lays out eagerly */
+#define N_ITEMS 2000
+
+static GtkListStore *
+create_store (gint n_items,
+              gint first_tall)
+{
+  GtkListStore *store;
+  gint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < n_items; i++)
+    {
+      gchar *text;
+
+      if (i >= first_tall)
+        text = g_strdup_printf ("Item %d\nsecond line\nthird line", i);
+      else
+        text = g_strdup_printf ("Item %d", i);
+      gtk_list_store_insert_with_values (store, NULL, i, 0, text, -1);
+      g_free (text);
+    }
+
+  return store;
+}
+
+static GtkWidget *
+create_view (GtkListStore *store,
+             GtkWidget   **window)
+{
+  GtkWidget *view, *sw;
+
+  view = gtk_icon_view_new_with_model (GTK_TREE_MODEL (store));
+  gtk_icon_view_set_text_column (GTK_ICON_VIEW (view), 0);
+  gtk_icon_view_set_columns (GTK_ICON_VIEW (view), 1);
+
+  *window = gtk_offscreen_window_new ();
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw),
+                                  GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+  gtk_widget_set_size_request (sw, 200, 300);
+  gtk_container_add (GTK_CONTAINER (sw), view);
+  gtk_container_add (GTK_CONTAINER (*window), sw);
+  gtk_widget_show_all (*window);
+
+  gtk_test_widget_wait_for_draw (*window);
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  return view;
+}
+
+static void
+scroll_to_item (GtkWidget *window,
+                GtkWidget *view,
+                gint       index)
+{
+  GtkTreePath *path;
+
+  path = gtk_tree_path_new_from_indices (index, -1);
+  gtk_icon_view_scroll_to_path (GTK_ICON_VIEW (view), path, TRUE, 0.5, 0.0);
+  gtk_tree_path_free (path);
+
+  gtk_test_widget_wait_for_draw (window);
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+}
+
+static void
+get_item_rect (GtkWidget    *view,
+               gint          index,
+               GdkRectangle *rect)
+{
+  GtkTreePath *path;
+
+  path = gtk_tree_path_new_from_indices (index, -1);
+  g_assert_true (gtk_icon_view_get_cell_rect (GTK_ICON_VIEW (view), path, NULL, rect));
+  gtk_tree_path_free (path);
+}
+
+/* The item shown in the middle of the view is where the view
+ * says it is, however far down it was scrolled.
+ */
+static void
+check_item_visible (GtkWidget *view,
+                    gint       index)
+{
+  GtkTreePath *start, *end, *path;
+  GdkRectangle rect;
+  gint x, y;
+
+  g_assert_true (gtk_icon_view_get_visible_range (GTK_ICON_VIEW (view), &start, &end));
+  g_assert_cmpint (gtk_tree_path_get_indices (start)[0], <=, index);
+  g_assert_cmpint (gtk_tree_path_get_indices (end)[0], >=, index);
+  gtk_tree_path_free (start);
+  gtk_tree_path_free (end);
+
+  get_item_rect (view, index, &rect);
+  g_assert_cmpint (rect.y, >=, 0);
+  g_assert_cmpint (rect.y + rect.height, <=, gtk_widget_get_allocated_height (view));
+
+  gtk_icon_view_convert_widget_to_bin_window_coords (GTK_ICON_VIEW (view),
+                                                     rect.x + rect.width / 2,
+                                                     rect.y + rect.height / 2,
+                                                     &x, &y);
+  path = gtk_icon_view_get_path_at_pos (GTK_ICON_VIEW (view), x, y);
+  g_assert_nonnull (path);
+  g_assert_cmpint (gtk_tree_path_get_indices (path)[0], ==, index);
+  gtk_tree_path_free (path);
+}
+
+static void
+test_lazy_layout_scroll (void)
+{
+  GtkListStore *store;
+  GtkWidget *window, *view;
+
+  store = create_store (N_ITEMS, N_ITEMS);
+  view = create_view (store, &window);
+
+  check_item_visible (view, 0);
+
+  scroll_to_item (window, view, 1500);
+  check_item_visible (view, 1500);
+
+  scroll_to_item (window, view, N_ITEMS - 1);
+  check_item_visible (view, N_ITEMS - 1);
+
+  scroll_to_item (window, view, 10);
+  check_item_visible (view, 10);
+
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
+static void
+test_lazy_layout_heights (void)
+{
+  GtkListStore *store;
+  GtkWidget *window, *view;
+  GtkTreePath *start, *end;
+  GdkRectangle first, rect, next;
+  gint i;
+
+  /* The rows further down are taller than the ones the
+   * estimate is taken from */
+  store = create_store (N_ITEMS, 1000);
+  view = create_view (store, &window);
+
+  get_item_rect (view, 0, &first);
+
+  scroll_to_item (window, view, 1500);
+  check_item_visible (view, 1500);
+
+  /* the visible rows are measured, not estimated */
+  get_item_rect (view, 1500, &rect);
+  g_assert_cmpint (rect.height, >, first.height);
+
+  /* and don't overlap */
+  g_assert_true (gtk_icon_view_get_visible_range (GTK_ICON_VIEW (view), &start, &end));
+  for (i = gtk_tree_path_get_indices (start)[0]; i < gtk_tree_path_get_indices (end)[0]; i++)
+    {
+      get_item_rect (view, i, &rect);
+      get_item_rect (view, i + 1, &next);
+      g_assert_cmpint (next.y, >=, rect.y + rect.height);
+    }
+  gtk_tree_path_free (start);
+  gtk_tree_path_free (end);
+
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
+static void
+test_cell_changed (void)
+{
+  GtkListStore *store;
+  GtkWidget *view;
+  GtkCellRenderer *cell;
+  gint before, after;
+
+  store = create_store (10, 10);
+  view = gtk_icon_view_new_with_model (GTK_TREE_MODEL (store));
+  g_object_ref_sink (view);
+
+  cell = gtk_cell_renderer_text_new ();
+  gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (view), cell, TRUE);
+  gtk_cell_layout_add_attribute (GTK_CELL_LAYOUT (view), cell, "text", 0);
+
+  gtk_widget_get_preferred_width (view, &before, NULL);
+
+  /* the item size must not come from before the change */
+  g_object_set (cell, "xpad", 40, NULL);
+  gtk_widget_get_preferred_width (view, &after, NULL);
+  g_assert_cmpint (after, >, before);
+
+  g_object_unref (view);
+  g_object_unref (store);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/iconview/lazy-layout/scroll", test_lazy_layout_scroll);
+  g_test_add_func ("/iconview/lazy-layout/heights", test_lazy_layout_heights);
+  g_test_add_func ("/iconview/cell-changed", test_cell_changed);
+
+  return g_test_run ();
+}
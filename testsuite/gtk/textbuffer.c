@@ -916,6 +916,87 @@ test_line_separator (void)
   split_r_n_separators_test ();
 }
 
+typedef struct {
+  const gchar *inserts[10];     /* appended one after the other */
+  gint n_chars;
+  gint n_lines;
+  gint line_starts[5];          /* character offsets */
+  gint line_bytes[5];
+} LineBreakTest;
+
+/* Paragraph boundaries as found when inserting, for each kind of
+ * delimiter and with multibyte characters around them.
+ */
+static const LineBreakTest line_break_tests[] = {
+  /* CRLF is one delimiter */
+  { { "ab\r\ncd\r\n" }, 8, 3, { 0, 4, 8 }, { 4, 4, 0 } },
+  /* a lone CR is one too, also before other text */
+  { { "ab\rcd\r" }, 6, 3, { 0, 3, 6 }, { 3, 3, 0 } },
+  /* a CR ending one insert and an LF starting the next are two */
+  { { "ab\r", "\ncd" }, 6, 3, { 0, 3, 4 }, { 3, 1, 2 } },
+  /* U+2029 PARAGRAPH SEPARATOR ends a line, U+2028 LINE SEPARATOR doesn't */
+  { { "ab\xe2\x80\xa9" "cd\xe2\x80\xa8" "ef\xe2\x80\xa9" }, 9, 3, { 0, 3, 9 }, { 5, 10, 0 } },
+  /* multibyte characters next to delimiters, including ones that
+   * share their first bytes with U+2029 */
+  { { "\xc3\xa9\n\xe2\x82\xac\r\n\xe2\x80\xa6\r\xf0\x9f\x98\x80\xe2\x80\xa9\xe2\x80\xa6" },
+    10, 5, { 0, 2, 5, 7, 9 }, { 3, 5, 4, 7, 3 } },
+  /* the same, inserted piece by piece */
+  { { "\xc3\xa9", "\n", "\xe2\x82\xac", "\r\n", "\xe2\x80\xa6", "\r",
+      "\xf0\x9f\x98\x80", "\xe2\x80\xa9", "\xe2\x80\xa6" },
+    10, 5, { 0, 2, 5, 7, 9 }, { 3, 5, 4, 7, 3 } }
+};
+
+static void
+test_insert_line_breaks (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter iter;
+  guint i;
+  gint j;
+
+  buffer = gtk_text_buffer_new (NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (line_break_tests); i++)
+    {
+      const LineBreakTest *test = &line_break_tests[i];
+
+      gtk_text_buffer_set_text (buffer, "", -1);
+      for (j = 0; test->inserts[j] != NULL; j++)
+        {
+          gtk_text_buffer_get_end_iter (buffer, &iter);
+          gtk_text_buffer_insert (buffer, &iter, test->inserts[j], -1);
+        }
+
+      g_assert_cmpint (gtk_text_buffer_get_char_count (buffer), ==, test->n_chars);
+      g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, test->n_lines);
+
+      for (j = 0; j < test->n_lines; j++)
+        {
+          gtk_text_buffer_get_iter_at_line (buffer, &iter, j);
+          g_assert_cmpint (gtk_text_iter_get_offset (&iter), ==, test->line_starts[j]);
+          g_assert_cmpint (gtk_text_iter_get_bytes_in_line (&iter), ==, test->line_bytes[j]);
+
+          gtk_text_buffer_get_iter_at_offset (buffer, &iter, test->line_starts[j]);
+          g_assert_cmpint (gtk_text_iter_get_line (&iter), ==, j);
+          g_assert_cmpint (gtk_text_iter_get_line_offset (&iter), ==, 0);
+        }
+    }
+
+  /* Inserting in the middle of a line moves the iter past the text */
+  gtk_text_buffer_set_text (buffer, "\xc3\xa9\xc3\xa9", -1);
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, 1);
+  gtk_text_buffer_insert (buffer, &iter, "\xe2\x82\xac\r\n\xe2\x80\xa9\xe2\x82\xac", -1);
+  g_assert_cmpint (gtk_text_iter_get_offset (&iter), ==, 6);
+  g_assert_cmpint (gtk_text_iter_get_line (&iter), ==, 2);
+  g_assert_cmpint (gtk_text_iter_get_line_index (&iter), ==, 3);
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 3);
+  gtk_text_buffer_get_iter_at_line (buffer, &iter, 1);
+  g_assert_cmpint (gtk_text_iter_get_offset (&iter), ==, 4);
+  g_assert_cmpint (gtk_text_iter_get_bytes_in_line (&iter), ==, 3);
+
+  g_object_unref (buffer);
+}
+
 static void
 test_backspace (void)
 {
@@ -1556,6 +1637,316 @@ test_get_iter (void)
   g_object_unref (buffer);
 }
 
+static void
+test_max_lines (void)
+{
+  GtkTextBuffer *buffer, *source;
+  GtkTextIter start, end, iter;
+  gchar *text;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, "1\n2\n3\n4", -1);
+
+  gtk_text_buffer_set_max_lines (buffer, 3);
+  g_assert_cmpint (gtk_text_buffer_get_max_lines (buffer), ==, 3);
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 3);
+
+  /* trimming is deferred to an idle */
+  gtk_text_buffer_get_end_iter (buffer, &end);
+  gtk_text_buffer_insert (buffer, &end, "\n5\n6", -1);
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 5);
+
+  while (g_main_context_iteration (NULL, FALSE));
+
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 3);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, "4\n5\n6");
+  g_free (text);
+
+  /* so do other ways of inserting */
+  source = gtk_text_buffer_new (gtk_text_buffer_get_tag_table (buffer));
+  gtk_text_buffer_set_text (source, "\n7\n8", -1);
+  gtk_text_buffer_get_bounds (source, &start, &end);
+  gtk_text_buffer_get_end_iter (buffer, &iter);
+  gtk_text_buffer_insert_range (buffer, &iter, &start, &end);
+  gtk_text_buffer_get_end_iter (buffer, &iter);
+  gtk_text_buffer_create_child_anchor (buffer, &iter);
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 5);
+
+  while (g_main_context_iteration (NULL, FALSE));
+
+  g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 3);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  text = gtk_text_buffer_get_slice (buffer, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, "6\n7\n8\xef\xbf\xbc");
+  g_free (text);
+
+  g_object_unref (source);
+  g_object_unref (buffer);
+}
+
+static void
+test_max_lines_backlog (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextTag *tag;
+  GtkTextMark *mark;
+  GtkTextIter start, end, iter;
+  gchar *text, *expected;
+  gint i, j;
+
+  buffer = gtk_text_buffer_new (NULL);
+  tag = gtk_text_buffer_create_tag (buffer, "bold", "weight", PANGO_WEIGHT_BOLD, NULL);
+  gtk_text_buffer_set_max_lines (buffer, 1000);
+
+  gtk_text_buffer_get_start_iter (buffer, &start);
+  mark = gtk_text_buffer_create_mark (buffer, "old", &start, FALSE);
+
+  /* Append in bursts, each trimmed at once when the idle runs */
+  for (i = 0; i < 100; i++)
+    {
+      for (j = 0; j < 1000; j++)
+        {
+          gchar *line;
+
+          line = g_strdup_printf ("line %d\n", i * 1000 + j);
+          gtk_text_buffer_get_end_iter (buffer, &end);
+          if (j % 2 == 0)
+            gtk_text_buffer_insert_with_tags (buffer, &end, line, -1, tag, NULL);
+          else
+            gtk_text_buffer_insert (buffer, &end, line, -1);
+          g_free (line);
+        }
+
+      while (g_main_context_iteration (NULL, FALSE));
+
+      g_assert_cmpint (gtk_text_buffer_get_line_count (buffer), ==, 1000);
+    }
+
+  /* The last 999 lines and the empty one after them are kept */
+  gtk_text_buffer_get_start_iter (buffer, &start);
+  gtk_text_buffer_get_iter_at_line (buffer, &end, 1);
+  text = gtk_text_buffer_get_text (buffer, &start, &end, TRUE);
+  expected = g_strdup_printf ("line %d\n", 100000 - 999);
+  g_assert_cmpstr (text, ==, expected);
+  g_free (text);
+  g_free (expected);
+
+  /* Tags and marks in the removed lines don't leak into the rest */
+  for (i = 0; i < 999; i++)
+    {
+      gtk_text_buffer_get_iter_at_line (buffer, &iter, i);
+      g_assert (gtk_text_iter_has_tag (&iter, tag) == ((100000 - 999 + i) % 2 == 0));
+    }
+  gtk_text_buffer_get_iter_at_mark (buffer, &iter, mark);
+  g_assert (gtk_text_iter_is_start (&iter));
+
+  g_object_unref (buffer);
+}
+
+static void
+check_tag_spans (GtkTextBuffer *buffer,
+                 GtkTextTag    *tag,
+                 gint           start_offset,
+                 gint           end_offset,
+                 const gint    *offsets,
+                 gint           n_offsets)
+{
+  GtkTextIter start, end, iter;
+  gboolean *expected;
+  gint n_chars, i, j;
+
+  n_chars = gtk_text_buffer_get_char_count (buffer);
+  expected = g_new (gboolean, n_chars);
+
+  for (i = 0; i < n_chars; i++)
+    {
+      gtk_text_buffer_get_iter_at_offset (buffer, &iter, i);
+      expected[i] = gtk_text_iter_has_tag (&iter, tag);
+
+      if (i >= start_offset && i < end_offset)
+        {
+          expected[i] = FALSE;
+          for (j = 0; j < n_offsets; j += 2)
+            {
+              if (i >= start_offset + offsets[j] && i < start_offset + offsets[j + 1])
+                expected[i] = TRUE;
+            }
+        }
+    }
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, start_offset);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, end_offset);
+  gtk_text_buffer_set_tag_spans (buffer, tag, &start, &end, offsets, n_offsets);
+
+  for (i = 0; i < n_chars; i++)
+    {
+      gtk_text_buffer_get_iter_at_offset (buffer, &iter, i);
+      g_assert_cmpint (gtk_text_iter_has_tag (&iter, tag), ==, expected[i]);
+    }
+
+  g_free (expected);
+}
+
+static void
+test_tag_spans (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextTag *tag;
+  GtkTextIter start, end;
+  GString *text;
+  gint i;
+  const gint spans1[] = { 0, 3, 10, 30, 95, 100 };
+  const gint spans2[] = { 0, 5, 5, 10, 20, 21 };
+  const gint spans3[] = { 2, 40 };
+
+  buffer = gtk_text_buffer_new (NULL);
+  tag = gtk_text_buffer_create_tag (buffer, "keyword", "weight", PANGO_WEIGHT_BOLD, NULL);
+
+  text = g_string_new (NULL);
+  for (i = 0; i < 100; i++)
+    g_string_append_printf (text, "line %d\n", i);
+  gtk_text_buffer_set_text (buffer, text->str, -1);
+  g_string_free (text, TRUE);
+
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 3);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 10);
+  gtk_text_buffer_apply_tag (buffer, tag, &start, &end);
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 25);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 40);
+  gtk_text_buffer_apply_tag (buffer, tag, &start, &end);
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 100);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 110);
+  gtk_text_buffer_apply_tag (buffer, tag, &start, &end);
+
+  /* Spans overlapping, extending and dropping existing ranges */
+  check_tag_spans (buffer, tag, 5, 120, spans1, G_N_ELEMENTS (spans1));
+
+  /* The same again changes nothing */
+  check_tag_spans (buffer, tag, 5, 120, spans1, G_N_ELEMENTS (spans1));
+
+  /* Adjacent spans and a region ending inside a tagged range */
+  check_tag_spans (buffer, tag, 15, 38, spans2, G_N_ELEMENTS (spans2));
+
+  /* A region across many lines */
+  check_tag_spans (buffer, tag, 0, gtk_text_buffer_get_char_count (buffer), spans3, G_N_ELEMENTS (spans3));
+
+  /* No spans removes the tag from the region */
+  check_tag_spans (buffer, tag, 0, gtk_text_buffer_get_char_count (buffer), NULL, 0);
+
+  g_object_unref (buffer);
+}
+
+static void
+test_serialize (void)
+{
+  GtkTextBuffer *buffer, *buffer2;
+  GtkTextTag *bold, *anon;
+  GtkTextIter start, end, iter;
+  GdkAtom format;
+  guint8 *data;
+  gsize length;
+  gboolean res;
+  gchar *text;
+  GSList *tags;
+
+  buffer = gtk_text_buffer_new (NULL);
+  bold = gtk_text_buffer_create_tag (buffer, "bold", "weight", PANGO_WEIGHT_BOLD, NULL);
+  anon = gtk_text_buffer_create_tag (buffer, NULL, "style", PANGO_STYLE_ITALIC, NULL);
+  gtk_text_buffer_set_text (buffer, "plain <bold> & italic", -1);
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 6);
+  gtk_text_buffer_get_iter_at_offset (buffer, &end, 12);
+  gtk_text_buffer_apply_tag (buffer, bold, &start, &end);
+  gtk_text_buffer_get_iter_at_offset (buffer, &start, 15);
+  gtk_text_buffer_get_end_iter (buffer, &end);
+  gtk_text_buffer_apply_tag (buffer, anon, &start, &end);
+
+  format = gtk_text_buffer_register_serialize_tagset (buffer, NULL);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  data = gtk_text_buffer_serialize (buffer, buffer, format, &start, &end, &length);
+  g_assert (data != NULL);
+
+  buffer2 = gtk_text_buffer_new (NULL);
+  format = gtk_text_buffer_register_deserialize_tagset (buffer2, NULL);
+  gtk_text_buffer_deserialize_set_can_create_tags (buffer2, format, TRUE);
+  gtk_text_buffer_get_start_iter (buffer2, &iter);
+  res = gtk_text_buffer_deserialize (buffer2, buffer2, format, &iter, data, length, NULL);
+  g_assert (res);
+  g_free (data);
+
+  gtk_text_buffer_get_bounds (buffer2, &start, &end);
+  text = gtk_text_buffer_get_text (buffer2, &start, &end, TRUE);
+  g_assert_cmpstr (text, ==, "plain <bold> & italic");
+  g_free (text);
+
+  gtk_text_buffer_get_iter_at_offset (buffer2, &iter, 6);
+  g_assert (gtk_text_iter_has_tag (&iter, gtk_text_tag_table_lookup (gtk_text_buffer_get_tag_table (buffer2), "bold")));
+  gtk_text_buffer_get_iter_at_offset (buffer2, &iter, 16);
+  tags = gtk_text_iter_get_tags (&iter);
+  g_assert_cmpint (g_slist_length (tags), ==, 1);
+  g_slist_free (tags);
+  gtk_text_buffer_get_iter_at_offset (buffer2, &iter, 13);
+  g_assert (gtk_text_iter_get_tags (&iter) == NULL);
+
+  g_object_unref (buffer);
+  g_object_unref (buffer2);
+}
+
+static void
+test_serialize_stream (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextTag *bold;
+  GtkTextIter start, end;
+  GOutputStream *stream;
+  GdkPixbuf *pixbuf;
+  GdkAtom format;
+  GError *error = NULL;
+  GString *text;
+  guint8 *data;
+  gsize length;
+  gint i;
+
+  buffer = gtk_text_buffer_new (NULL);
+  bold = gtk_text_buffer_create_tag (buffer, "bold", "weight", PANGO_WEIGHT_BOLD, NULL);
+
+  /* Long enough to be written in several pieces */
+  text = g_string_new (NULL);
+  for (i = 0; i < 10000; i++)
+    g_string_append_printf (text, "line <%d> & more\n", i);
+  gtk_text_buffer_set_text (buffer, text->str, -1);
+  g_string_free (text, TRUE);
+
+  gtk_text_buffer_get_iter_at_line (buffer, &start, 100);
+  gtk_text_buffer_get_iter_at_line (buffer, &end, 5000);
+  gtk_text_buffer_apply_tag (buffer, bold, &start, &end);
+
+  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8, 10, 10);
+  gdk_pixbuf_fill (pixbuf, 0xff0000ff);
+  gtk_text_buffer_get_iter_at_line (buffer, &start, 200);
+  gtk_text_buffer_insert_pixbuf (buffer, &start, pixbuf);
+  g_object_unref (pixbuf);
+
+  format = gtk_text_buffer_register_serialize_tagset (buffer, NULL);
+  gtk_text_buffer_get_bounds (buffer, &start, &end);
+  data = gtk_text_buffer_serialize (buffer, buffer, format, &start, &end, &length);
+  g_assert (data != NULL);
+
+  stream = g_memory_output_stream_new_resizable ();
+  g_assert (gtk_text_buffer_serialize_to_stream (buffer, buffer, format, &start, &end,
+                                                 stream, NULL, &error));
+  g_assert_no_error (error);
+  g_output_stream_close (stream, NULL, NULL);
+
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (stream)), ==, length);
+  g_assert (memcmp (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (stream)), data, length) == 0);
+
+  g_free (data);
+  g_object_unref (stream);
+  g_object_unref (buffer);
+}
+
 int
 main (int argc, char** argv)
 {
@@ -1566,6 +1957,7 @@ main (int argc, char** argv)
 
   g_test_add_func ("/TextBuffer/UTF8 unknown char", test_utf8);
   g_test_add_func ("/TextBuffer/Line separator", test_line_separator);
+  g_test_add_func ("/TextBuffer/Insert line breaks", test_insert_line_breaks);
   g_test_add_func ("/TextBuffer/Backspace", test_backspace);
   g_test_add_func ("/TextBuffer/Logical motion", test_logical_motion);
   g_test_add_func ("/TextBuffer/Marks", test_marks);
@@ -1573,8 +1965,13 @@ main (int argc, char** argv)
   g_test_add_func ("/TextBuffer/Get and Set", test_get_set);
   g_test_add_func ("/TextBuffer/Fill and Empty", test_fill_empty);
   g_test_add_func ("/TextBuffer/Tag", test_tag);
+  g_test_add_func ("/TextBuffer/Tag spans", test_tag_spans);
   g_test_add_func ("/TextBuffer/Clipboard", test_clipboard);
   g_test_add_func ("/TextBuffer/Get iter", test_get_iter);
+  g_test_add_func ("/TextBuffer/Max lines", test_max_lines);
+  g_test_add_func ("/TextBuffer/Max lines backlog", test_max_lines_backlog);
+  g_test_add_func ("/TextBuffer/Serialize", test_serialize);
+  g_test_add_func ("/TextBuffer/Serialize to stream", test_serialize_stream);
 
   return g_test_run();
 }
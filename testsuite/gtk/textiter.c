@@ -194,6 +194,60 @@ test_search (void)
   check_found_backward ("aa \303\200", "aa", 0, 0, 2, "aa");
 }
 
+static void
+test_search_limit (void)
+{
+  GtkTextBuffer *buffer;
+  GtkTextIter iter, limit, s, e;
+  gboolean res;
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, "foo bar\nbar foo\n\303\204 FOO baz", -1);
+
+  /* forward, match ending at the limit */
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, 1);
+  gtk_text_buffer_get_iter_at_offset (buffer, &limit, 15);
+  res = gtk_text_iter_forward_search (&iter, "foo", 0, &s, &e, &limit);
+  g_assert (res);
+  g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, 12);
+  g_assert_cmpint (gtk_text_iter_get_offset (&e), ==, 15);
+
+  /* forward, match crossing the limit */
+  gtk_text_buffer_get_iter_at_offset (buffer, &limit, 14);
+  res = gtk_text_iter_forward_search (&iter, "foo", 0, &s, &e, &limit);
+  g_assert (!res);
+
+  /* forward, caseless through a non-ASCII line */
+  res = gtk_text_iter_forward_search (&s, "foo", GTK_TEXT_SEARCH_CASE_INSENSITIVE, &s, &e, NULL);
+  g_assert (res);
+  res = gtk_text_iter_forward_search (&e, "foo", GTK_TEXT_SEARCH_CASE_INSENSITIVE, &s, &e, NULL);
+  g_assert (res);
+  g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, 18);
+  g_assert_cmpint (gtk_text_iter_get_offset (&e), ==, 21);
+
+  /* backward, match starting at the limit */
+  gtk_text_buffer_get_end_iter (buffer, &iter);
+  gtk_text_buffer_get_iter_at_offset (buffer, &limit, 12);
+  res = gtk_text_iter_backward_search (&iter, "foo", 0, &s, &e, &limit);
+  g_assert (res);
+  g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, 12);
+
+  /* backward, match crossing the limit */
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, 15);
+  gtk_text_buffer_get_iter_at_offset (buffer, &limit, 13);
+  res = gtk_text_iter_backward_search (&iter, "foo", 0, &s, &e, &limit);
+  g_assert (!res);
+
+  /* backward, match ending at the search start */
+  gtk_text_buffer_get_iter_at_offset (buffer, &iter, 7);
+  res = gtk_text_iter_backward_search (&iter, "BAR", GTK_TEXT_SEARCH_CASE_INSENSITIVE, &s, &e, NULL);
+  g_assert (res);
+  g_assert_cmpint (gtk_text_iter_get_offset (&s), ==, 4);
+  g_assert_cmpint (gtk_text_iter_get_offset (&e), ==, 7);
+
+  g_object_unref (buffer);
+}
+
 static void
 test_search_caseless (void)
 {
@@ -752,6 +806,7 @@ main (int argc, char** argv)
   g_test_add_func ("/TextIter/Search Full Buffer", test_search_full_buffer);
   g_test_add_func ("/TextIter/Search", test_search);
   g_test_add_func ("/TextIter/Search Caseless", test_search_caseless);
+  g_test_add_func ("/TextIter/Search Limit", test_search_limit);
   g_test_add_func ("/TextIter/Forward To Tag Toggle", test_forward_to_tag_toggle);
   g_test_add_func ("/TextIter/Forward To Line End", test_forward_to_line_end);
   g_test_add_func ("/TextIter/Word Boundaries", test_word_boundaries);
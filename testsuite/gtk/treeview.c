@@ -344,6 +344,238 @@ test_selection_empty (void)
   gtk_widget_destroy (view);
 }
 
+static void
+check_search_cursor (GtkTreeView *view,
+                     GtkEntry    *entry,
+                     const gchar *text,
+                     const gchar *expected)
+{
+  GtkTreePath *path;
+  gchar *str;
+
+  gtk_entry_set_text (entry, text);
+  gtk_tree_view_get_cursor (view, &path, NULL);
+  g_assert (path != NULL);
+  str = gtk_tree_path_to_string (path);
+  g_assert_cmpstr (str, ==, expected);
+  g_free (str);
+  gtk_tree_path_free (path);
+}
+
+static void
+test_search_indexed (void)
+{
+  const gchar *names[] = { "Zoe", "bob", "Alice", "Bobby", "\xc3\x89mile", "Boris" };
+  GtkWidget *view;
+  GtkWidget *entry;
+  GtkListStore *store;
+  guint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < G_N_ELEMENTS (names); i++)
+    gtk_list_store_insert_with_values (store, NULL, i, 0, names[i], -1);
+
+  view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  g_object_ref_sink (view);
+  entry = gtk_entry_new ();
+  g_object_ref_sink (entry);
+
+  gtk_tree_view_set_search_column (GTK_TREE_VIEW (view), 0);
+  gtk_tree_view_set_search_indexed (GTK_TREE_VIEW (view), TRUE);
+  g_assert_true (gtk_tree_view_get_search_indexed (GTK_TREE_VIEW (view)));
+  gtk_tree_view_set_search_entry (GTK_TREE_VIEW (view), GTK_ENTRY (entry));
+
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "b", "1");
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "bor", "5");
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "ALI", "2");
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "e\xcc\x81", "4");
+
+  /* the index must follow changes to the model */
+  gtk_list_store_insert_with_values (store, NULL, 0, 0, "Alfred", -1);
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "al", "0");
+
+  gtk_widget_destroy (view);
+  g_object_unref (view);
+  g_object_unref (entry);
+  g_object_unref (store);
+}
+
+static void
+test_autosize_sample (void)
+{
+  GtkWidget *window;
+  GtkWidget *sw;
+  GtkWidget *view;
+  GtkListStore *store;
+  GtkTreeViewColumn *column;
+  GtkTreePath *path;
+  gint sampled_width;
+  guint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  for (i = 0; i < 499; i++)
+    gtk_list_store_insert_with_values (store, NULL, i, 0, "Row", -1);
+  gtk_list_store_insert_with_values (store, NULL, i, 0,
+                                     "A much, much longer row at the very end", -1);
+
+  view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  column = gtk_tree_view_column_new_with_attributes ("Test",
+                                                     gtk_cell_renderer_text_new (),
+                                                     "text", 0,
+                                                     NULL);
+  gtk_tree_view_column_set_sizing (column, GTK_TREE_VIEW_COLUMN_AUTOSIZE);
+  g_assert_cmpint (gtk_tree_view_column_get_autosize_sample (column), ==, -1);
+  gtk_tree_view_column_set_autosize_sample (column, 10);
+  g_assert_cmpint (gtk_tree_view_column_get_autosize_sample (column), ==, 10);
+  gtk_tree_view_append_column (GTK_TREE_VIEW (view), column);
+
+  window = gtk_offscreen_window_new ();
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw),
+                                  GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+  gtk_widget_set_size_request (sw, 400, 100);
+  gtk_container_add (GTK_CONTAINER (sw), view);
+  gtk_container_add (GTK_CONTAINER (window), sw);
+  gtk_widget_show_all (window);
+
+  gtk_test_widget_wait_for_draw (window);
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  /* the last row is not part of the sample */
+  sampled_width = gtk_tree_view_column_get_width (column);
+
+  path = gtk_tree_path_new_from_indices (499, -1);
+  gtk_tree_view_scroll_to_cell (GTK_TREE_VIEW (view), path, NULL, FALSE, 0, 0);
+  gtk_tree_path_free (path);
+
+  gtk_test_widget_wait_for_draw (window);
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  /* but it widens the column once it is visible */
+  g_assert_cmpint (gtk_tree_view_column_get_width (column), >, sampled_width);
+
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
+static void
+test_search_indexed_updates (void)
+{
+  GtkWidget *view;
+  GtkWidget *entry;
+  GtkTreeStore *store;
+  GtkTreeIter fruit, veg, iter;
+  GtkTreePath *path;
+
+  store = gtk_tree_store_new (1, G_TYPE_STRING);
+  gtk_tree_store_insert_with_values (store, &fruit, NULL, -1, 0, "Fruit", -1);
+  gtk_tree_store_insert_with_values (store, NULL, &fruit, -1, 0, "Apple", -1);
+  gtk_tree_store_insert_with_values (store, NULL, &fruit, -1, 0, "Banana", -1);
+  gtk_tree_store_insert_with_values (store, &veg, NULL, -1, 0, "Vegetables", -1);
+  gtk_tree_store_insert_with_values (store, NULL, &veg, -1, 0, "Asparagus", -1);
+  gtk_tree_store_insert_with_values (store, NULL, &veg, -1, 0, "Bean", -1);
+
+  view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  g_object_ref_sink (view);
+  entry = gtk_entry_new ();
+  g_object_ref_sink (entry);
+
+  gtk_tree_view_set_search_column (GTK_TREE_VIEW (view), 0);
+  gtk_tree_view_set_search_indexed (GTK_TREE_VIEW (view), TRUE);
+  gtk_tree_view_set_search_entry (GTK_TREE_VIEW (view), GTK_ENTRY (entry));
+
+  /* only rows that are shown are searched */
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "v", "1");
+
+  path = gtk_tree_path_new_from_string ("1");
+  gtk_tree_view_expand_row (GTK_TREE_VIEW (view), path, FALSE);
+  gtk_tree_path_free (path);
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "a", "1:0");
+
+  gtk_tree_view_expand_all (GTK_TREE_VIEW (view));
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "ap", "0:0");
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "b", "0:1");
+
+  /* rows after an inserted row move down */
+  gtk_tree_store_insert_with_values (store, NULL, &veg, 0, 0, "Carrot", -1);
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "bea", "1:2");
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "car", "1:0");
+
+  /* changed rows get their new text */
+  gtk_tree_model_get_iter_from_string (GTK_TREE_MODEL (store), &iter, "0:1");
+  gtk_tree_store_set (store, &iter, 0, "Cherry", -1);
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "ch", "0:1");
+
+  /* deleting a parent drops its children and moves the rows after it up */
+  gtk_tree_store_remove (store, &fruit);
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "a", "0:1");
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "bea", "0:2");
+
+  /* collapsed rows are no longer searched */
+  path = gtk_tree_path_new_from_string ("0");
+  gtk_tree_view_collapse_row (GTK_TREE_VIEW (view), path);
+  gtk_tree_path_free (path);
+  gtk_tree_store_insert_with_values (store, NULL, NULL, -1, 0, "Beetroot", -1);
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "be", "1");
+
+  gtk_widget_destroy (view);
+  g_object_unref (view);
+  g_object_unref (entry);
+  g_object_unref (store);
+}
+
+static void
+test_search_indexed_bulk (void)
+{
+  GtkWidget *view;
+  GtkWidget *entry;
+  GtkListStore *store;
+  GtkTreeIter iter;
+  guint i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "Zebra", -1);
+
+  view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  g_object_ref_sink (view);
+  entry = gtk_entry_new ();
+  g_object_ref_sink (entry);
+
+  gtk_tree_view_set_search_column (GTK_TREE_VIEW (view), 0);
+  gtk_tree_view_set_search_indexed (GTK_TREE_VIEW (view), TRUE);
+  gtk_tree_view_set_search_entry (GTK_TREE_VIEW (view), GTK_ENTRY (entry));
+
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "z", "0");
+
+  /* a burst of changes, more than the index is updated for */
+  for (i = 0; i < 200; i++)
+    {
+      gchar *text = g_strdup_printf ("Row %u", i);
+      gtk_list_store_insert_with_values (store, NULL, 0, 0, text, -1);
+      g_free (text);
+    }
+  for (i = 0; i < 50; i++)
+    {
+      gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+      gtk_list_store_remove (store, &iter);
+    }
+
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "z", "150");
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "row 149", "0");
+
+  /* and single changes after it again */
+  gtk_list_store_insert_with_values (store, NULL, 0, 0, "Yak", -1);
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "z", "151");
+  check_search_cursor (GTK_TREE_VIEW (view), GTK_ENTRY (entry), "y", "0");
+
+  gtk_widget_destroy (view);
+  g_object_unref (view);
+  g_object_unref (entry);
+  g_object_unref (store);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -357,8 +589,13 @@ main (int    argc,
                    test_select_collapsed_row);
   g_test_add_func ("/TreeView/sizing/row-separator-height",
                    test_row_separator_height);
+  g_test_add_func ("/TreeView/sizing/autosize-sample",
+                   test_autosize_sample);
   g_test_add_func ("/TreeView/selection/count", test_selection_count);
   g_test_add_func ("/TreeView/selection/empty", test_selection_empty);
+  g_test_add_func ("/TreeView/search/indexed", test_search_indexed);
+  g_test_add_func ("/TreeView/search/indexed-updates", test_search_indexed_updates);
+  g_test_add_func ("/TreeView/search/indexed-bulk", test_search_indexed_bulk);
 
   return g_test_run ();
 }
@@ -0,0 +1,212 @@
+#include <gtk/gtk.h>
+
+#include <string.h>
+
+static cairo_surface_t *
+draw_widget (GtkWidget *widget)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        gtk_widget_get_allocated_width (widget),
+                                        gtk_widget_get_allocated_height (widget));
+  cr = cairo_create (surface);
+  gtk_widget_draw (widget, cr);
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  return surface;
+}
+
+static void
+assert_surfaces_equal (cairo_surface_t *a,
+                       cairo_surface_t *b)
+{
+  gint height, y;
+
+  g_assert_cmpint (cairo_image_surface_get_width (a), ==, cairo_image_surface_get_width (b));
+  g_assert_cmpint (cairo_image_surface_get_height (a), ==, cairo_image_surface_get_height (b));
+  g_assert_cmpint (cairo_image_surface_get_stride (a), ==, cairo_image_surface_get_stride (b));
+
+  height = cairo_image_surface_get_height (a);
+  for (y = 0; y < height; y++)
+    {
+      gint stride = cairo_image_surface_get_stride (a);
+
+      g_assert (memcmp (cairo_image_surface_get_data (a) + y * stride,
+                        cairo_image_surface_get_data (b) + y * stride,
+                        cairo_image_surface_get_width (a) * 4) == 0);
+    }
+}
+
+static void
+test_render_cache_replay (void)
+{
+  GtkWidget *window, *box;
+  cairo_surface_t *first, *second, *uncached;
+
+  window = gtk_offscreen_window_new ();
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 6);
+  gtk_container_add (GTK_CONTAINER (window), box);
+  gtk_container_add (GTK_CONTAINER (box), gtk_label_new ("Label"));
+  gtk_container_add (GTK_CONTAINER (box), gtk_button_new_with_label ("Button"));
+  gtk_container_add (GTK_CONTAINER (box), gtk_check_button_new_with_label ("Check"));
+  gtk_widget_set_render_cache (box, TRUE);
+  gtk_widget_show_all (window);
+
+  /* The first draw records, the second one replays */
+  first = draw_widget (box);
+  second = draw_widget (box);
+  assert_surfaces_equal (first, second);
+
+  gtk_widget_set_render_cache (box, FALSE);
+  uncached = draw_widget (box);
+  assert_surfaces_equal (first, uncached);
+
+  cairo_surface_destroy (first);
+  cairo_surface_destroy (second);
+  cairo_surface_destroy (uncached);
+  gtk_widget_destroy (window);
+}
+
+static void
+test_render_cache_windowed (void)
+{
+  GtkWidget *window, *box, *event_box, *inner;
+  cairo_surface_t *first, *second, *uncached;
+
+  window = gtk_offscreen_window_new ();
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 6);
+  gtk_container_add (GTK_CONTAINER (window), box);
+  gtk_container_add (GTK_CONTAINER (box), gtk_label_new ("Label"));
+  event_box = gtk_event_box_new ();
+  gtk_container_add (GTK_CONTAINER (event_box), gtk_label_new ("Windowed"));
+  gtk_container_add (GTK_CONTAINER (box), event_box);
+  gtk_widget_set_render_cache (box, TRUE);
+  gtk_widget_show_all (window);
+
+  /* The event box has its own window, which can't be recorded, so
+   * the box is drawn without its cache, but keeps the setting */
+  first = draw_widget (box);
+  g_assert_true (gtk_widget_get_render_cache (box));
+
+  second = draw_widget (box);
+  assert_surfaces_equal (first, second);
+
+  gtk_widget_set_render_cache (box, FALSE);
+  uncached = draw_widget (box);
+  assert_surfaces_equal (first, uncached);
+
+  cairo_surface_destroy (first);
+  cairo_surface_destroy (second);
+  cairo_surface_destroy (uncached);
+
+  /* The same for windowed widgets added below the box later */
+  gtk_container_remove (GTK_CONTAINER (box), event_box);
+  gtk_widget_set_render_cache (box, TRUE);
+  inner = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  gtk_container_add (GTK_CONTAINER (box), inner);
+  gtk_widget_show (inner);
+  gtk_test_widget_wait_for_draw (window);
+  /* records, and must not be replayed after the event box is added */
+  first = draw_widget (box);
+
+  event_box = gtk_event_box_new ();
+  gtk_container_add (GTK_CONTAINER (event_box), gtk_label_new ("Windowed"));
+  gtk_container_add (GTK_CONTAINER (inner), event_box);
+  gtk_widget_show_all (event_box);
+  gtk_test_widget_wait_for_draw (window);
+  second = draw_widget (box);
+  g_assert_true (gtk_widget_get_render_cache (box));
+
+  gtk_widget_set_render_cache (box, FALSE);
+  uncached = draw_widget (box);
+  assert_surfaces_equal (second, uncached);
+
+  cairo_surface_destroy (first);
+  cairo_surface_destroy (second);
+  cairo_surface_destroy (uncached);
+  gtk_widget_destroy (window);
+}
+
+static void
+count_allocations (GtkWidget     *widget,
+                   GtkAllocation *allocation,
+                   gpointer       data)
+{
+  gint *count = data;
+
+  (*count)++;
+}
+
+static void
+test_layout_root_resize (void)
+{
+  GtkWidget *window, *box, *root, *label;
+  GtkAllocation window_alloc, root_alloc, alloc;
+  gint window_count = 0, box_count = 0, root_count = 0, label_count = 0;
+  gint label_width;
+
+  window = gtk_offscreen_window_new ();
+  box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 6);
+  gtk_container_add (GTK_CONTAINER (window), box);
+  gtk_container_add (GTK_CONTAINER (box), gtk_label_new ("Outside"));
+
+  /* The root is larger than its contents, so it can keep its request */
+  root = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 6);
+  gtk_widget_set_size_request (root, 400, 100);
+  gtk_widget_set_layout_root (root, TRUE);
+  g_assert_true (gtk_widget_get_layout_root (root));
+  gtk_container_add (GTK_CONTAINER (box), root);
+  label = gtk_label_new ("Short");
+  gtk_container_add (GTK_CONTAINER (root), label);
+  gtk_widget_show_all (window);
+
+  gtk_test_widget_wait_for_draw (window);
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  gtk_widget_get_allocation (window, &window_alloc);
+  gtk_widget_get_allocation (root, &root_alloc);
+  label_width = gtk_widget_get_allocated_width (label);
+
+  g_signal_connect (window, "size-allocate", G_CALLBACK (count_allocations), &window_count);
+  g_signal_connect (box, "size-allocate", G_CALLBACK (count_allocations), &box_count);
+  g_signal_connect (root, "size-allocate", G_CALLBACK (count_allocations), &root_count);
+  g_signal_connect (label, "size-allocate", G_CALLBACK (count_allocations), &label_count);
+
+  /* Queues a resize on the label */
+  gtk_label_set_text (GTK_LABEL (label), "A somewhat longer text");
+
+  gtk_test_widget_wait_for_draw (window);
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  /* The ancestors of the root are left alone... */
+  g_assert_cmpint (window_count, ==, 0);
+  g_assert_cmpint (box_count, ==, 0);
+  gtk_widget_get_allocation (window, &alloc);
+  g_assert_true (gdk_rectangle_equal (&alloc, &window_alloc));
+
+  /* ...while the root allocates its children again, in place */
+  g_assert_cmpint (root_count, ==, 1);
+  gtk_widget_get_allocation (root, &alloc);
+  g_assert_true (gdk_rectangle_equal (&alloc, &root_alloc));
+  g_assert_cmpint (label_count, ==, 1);
+  g_assert_cmpint (gtk_widget_get_allocated_width (label), >, label_width);
+
+  gtk_widget_destroy (window);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/widget/render-cache/replay", test_render_cache_replay);
+  g_test_add_func ("/widget/render-cache/windowed", test_render_cache_windowed);
+  g_test_add_func ("/widget/layout-root/resize", test_layout_root_resize);
+
+  return g_test_run ();
+}